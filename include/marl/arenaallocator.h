@@ -0,0 +1,110 @@
+// Copyright 2026 The Marl Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef marl_arena_allocator_h
+#define marl_arena_allocator_h
+
+#include "containers.h"
+#include "export.h"
+#include "memory.h"
+#include "mutex.h"
+
+namespace marl {
+
+// ArenaAllocator is an Allocator that allocates by bumping a pointer through
+// large chunks of memory, and frees everything at once with reset().
+//
+// free() does nothing for memory allocated from the chunks, so ArenaAllocator
+// is well suited to objects that all die together, such as the DAGBuilder,
+// containers::vector and Event objects created while handling a single
+// request or frame. Destructors still run as normal; only the memory is
+// released by reset().
+//
+// Requests that use guards (such as fiber stacks) are forwarded to the parent
+// allocator, and must be freed as usual.
+//
+// ArenaAllocator is thread-safe.
+class ArenaAllocator : public Allocator {
+ public:
+  // Config holds the configuration of an ArenaAllocator.
+  struct Config {
+    // The size in bytes of each chunk allocated from the parent allocator.
+    // Allocations larger than a quarter of the chunk size are allocated
+    // individually from the parent allocator, and released on reset().
+    size_t chunkSize = 64 * 1024;
+
+    // If true, chunks are rounded up to, and aligned on, 2MiB boundaries and
+    // the OS is advised to back them with transparent huge pages. Ignored on
+    // platforms that do not support transparent huge pages.
+    bool useHugePages = false;
+  };
+
+  // Constructs the ArenaAllocator with the default configuration, allocating
+  // chunks from parent.
+  MARL_EXPORT ArenaAllocator(Allocator* parent = Allocator::Default);
+
+  // Constructs the ArenaAllocator with the given configuration, allocating
+  // chunks from parent.
+  MARL_EXPORT ArenaAllocator(const Config& config,
+                             Allocator* parent = Allocator::Default);
+
+  // Releases all chunks back to the parent allocator.
+  MARL_EXPORT ~ArenaAllocator();
+
+  // reset() releases all allocations made from the arena since construction
+  // or the last call to reset(). Chunks are kept for reuse by subsequent
+  // allocations. All memory allocated from the arena must no longer be in use.
+  MARL_EXPORT void reset();
+
+  // bytesAllocated() returns the number of bytes allocated from the arena's
+  // chunks since construction or the last call to reset().
+  MARL_EXPORT size_t bytesAllocated();
+
+  // bytesReserved() returns the number of bytes currently allocated from the
+  // parent allocator for the arena's chunks.
+  MARL_EXPORT size_t bytesReserved();
+
+  // Allocator compliance
+  MARL_EXPORT Allocation allocate(const Allocation::Request&) override;
+  MARL_EXPORT void free(const Allocation&) override;
+
+ private:
+  ArenaAllocator(const ArenaAllocator&) = delete;
+  ArenaAllocator& operator=(const ArenaAllocator&) = delete;
+
+  // newChunk() allocates a new chunk from the parent allocator and makes it
+  // the current chunk.
+  MARL_NO_EXPORT void newChunk() REQUIRES(mutex);
+
+  // useChunk() makes the chunk with the given index the current chunk.
+  MARL_NO_EXPORT void useChunk(size_t index) REQUIRES(mutex);
+
+  const Config config;
+  Allocator* const parent;
+  const size_t chunkSize;
+  const size_t chunkAlignment;
+
+  marl::mutex mutex;
+  GUARDED_BY(mutex) containers::vector<Allocation, 8> chunks;
+  GUARDED_BY(mutex) containers::vector<Allocation, 4> large;
+  GUARDED_BY(mutex) size_t current = 0;  // Index of the current chunk.
+  GUARDED_BY(mutex) uintptr_t next = 0;  // Next free byte in current chunk.
+  GUARDED_BY(mutex) uintptr_t end = 0;   // End of the current chunk.
+  GUARDED_BY(mutex) size_t allocated = 0;
+  GUARDED_BY(mutex) size_t reserved = 0;
+};
+
+}  // namespace marl
+
+#endif  // marl_arena_allocator_h
@@ -0,0 +1,696 @@
+// Copyright 2026 The Marl Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef marl_channel_h
+#define marl_channel_h
+
+#include "debug.h"
+#include "memory.h"
+#include "mutex.h"
+#include "waiter.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <utility>
+
+namespace marl {
+
+// Channel is a bounded multi-producer, multi-consumer queue of values of type
+// T, used to pass values between fibers and threads.
+//
+// Values are held in a fixed-size lock-free ring buffer. Sending to a channel
+// with free space and receiving from a non-empty channel only use atomic
+// operations. Senders block while the channel is full, and receivers block
+// while it is empty. Blocked fibers yield their worker thread to other tasks,
+// and are only woken once there is space or a value for them.
+//
+// Once a channel is closed, sends fail, and receives fail once the values
+// already sent have been received.
+//
+// Channel is a handle to shared state, so copies of a Channel refer to the
+// same channel.
+//
+// Example:
+//
+//   marl::Channel<int> channel(16);
+//   marl::schedule([=] {
+//     for (int i = 0; i < 100; i++) {
+//       channel.send(i);
+//     }
+//     channel.close();
+//   });
+//   int value;
+//   while (channel.recv(value)) {
+//     printf("%d\n", value);
+//   }
+template <typename T>
+class Channel {
+ public:
+  // Constructs a channel that holds at least capacity values. capacity is
+  // rounded up to the next power of two, with a minimum of 2, and must be
+  // greater than 0.
+  MARL_NO_EXPORT inline Channel(size_t capacity,
+                                Allocator* allocator = Allocator::Default);
+
+  // send() blocks until there is space for value, and sends it. Returns false,
+  // without sending value, if the channel is closed.
+  MARL_NO_EXPORT inline bool send(const T& value) const;
+  MARL_NO_EXPORT inline bool send(T&& value) const;
+
+  // try_send() sends value if there is space for it without blocking.
+  // Returns false, without sending value, if the channel is full or closed.
+  MARL_NO_EXPORT inline bool try_send(const T& value) const;
+  MARL_NO_EXPORT inline bool try_send(T&& value) const;
+
+  // try_send_for() blocks until there is space for value, and sends it, or
+  // the timeout has been reached. Returns false, without sending value, if the
+  // timeout was reached or the channel is closed.
+  template <typename Rep, typename Period>
+  MARL_NO_EXPORT inline bool try_send_for(
+      T&& value,
+      const std::chrono::duration<Rep, Period>& duration) const;
+
+  // try_send_until() blocks until there is space for value, and sends it, or
+  // the timeout has been reached. Returns false, without sending value, if the
+  // timeout was reached or the channel is closed.
+  template <typename Clock, typename Duration>
+  MARL_NO_EXPORT inline bool try_send_until(
+      T&& value,
+      const std::chrono::time_point<Clock, Duration>& timeout) const;
+
+  // send_n() sends the n values starting at values, blocking while the
+  // channel is full. Blocked receivers are woken once per value, rather than
+  // once per call. Returns the number of values sent, which is less than n
+  // only if the channel is closed.
+  MARL_NO_EXPORT inline size_t send_n(const T* values, size_t n) const;
+
+  // recv() blocks until a value is available, and moves it to out. Returns
+  // false if the channel is closed and empty.
+  MARL_NO_EXPORT inline bool recv(T& out) const;
+
+  // try_recv() moves a value to out if one is available without blocking.
+  // Returns false if the channel is empty.
+  MARL_NO_EXPORT inline bool try_recv(T& out) const;
+
+  // try_recv_for() blocks until a value is available, and moves it to out, or
+  // the timeout has been reached. Returns false if the timeout was reached, or
+  // the channel is closed and empty.
+  template <typename Rep, typename Period>
+  MARL_NO_EXPORT inline bool try_recv_for(
+      T& out,
+      const std::chrono::duration<Rep, Period>& duration) const;
+
+  // try_recv_until() blocks until a value is available, and moves it to out,
+  // or the timeout has been reached. Returns false if the timeout was
+  // reached, or the channel is closed and empty.
+  template <typename Clock, typename Duration>
+  MARL_NO_EXPORT inline bool try_recv_until(
+      T& out,
+      const std::chrono::time_point<Clock, Duration>& timeout) const;
+
+  // recv_n() receives n values into the array starting at out, blocking
+  // while the channel is empty. Returns the number of values received, which
+  // is less than n only if the channel is closed and empty.
+  MARL_NO_EXPORT inline size_t recv_n(T* out, size_t n) const;
+
+  // close() closes the channel, waking all blocked senders and receivers.
+  MARL_NO_EXPORT inline void close() const;
+
+  // closed() returns true if close() has been called.
+  MARL_NO_EXPORT inline bool closed() const;
+
+  // capacity() returns the number of values the channel can hold.
+  MARL_NO_EXPORT inline size_t capacity() const;
+
+ private:
+  struct Shared;
+
+ public:
+  // RecvCase is the select() case of a receive. See onRecv().
+  class RecvCase : public Selectable {
+   public:
+    MARL_NO_EXPORT inline RecvCase(Shared* shared, T& out, bool& ok);
+    MARL_NO_EXPORT inline bool tryComplete() override;
+    MARL_NO_EXPORT inline void add(WaitList::Node& node,
+                                   Waiter& waiter) override;
+    MARL_NO_EXPORT inline bool remove(WaitList::Node& node) override;
+    MARL_NO_EXPORT inline void notifyNext() override;
+
+   private:
+    Shared* const shared;
+    T& out;
+    bool& ok;
+  };
+
+  // SendCase is the select() case of a send. See onSend().
+  class SendCase : public Selectable {
+   public:
+    MARL_NO_EXPORT inline SendCase(Shared* shared, T& value, bool& ok);
+    MARL_NO_EXPORT inline bool tryComplete() override;
+    MARL_NO_EXPORT inline void add(WaitList::Node& node,
+                                   Waiter& waiter) override;
+    MARL_NO_EXPORT inline bool remove(WaitList::Node& node) override;
+    MARL_NO_EXPORT inline void notifyNext() override;
+
+   private:
+    Shared* const shared;
+    T& value;
+    bool& ok;
+  };
+
+  // onRecv() returns a select() case that completes when a value has been
+  // moved to out, setting ok to true, or when the channel is closed and
+  // empty, setting ok to false. The case must not outlive the channel.
+  MARL_NO_EXPORT inline RecvCase onRecv(T& out, bool& ok) const;
+
+  // onSend() returns a select() case that completes when value has been moved
+  // into the channel, setting ok to true, or when the channel is closed,
+  // setting ok to false without moving value. The case must not outlive the
+  // channel.
+  MARL_NO_EXPORT inline SendCase onSend(T& value, bool& ok) const;
+
+ private:
+  // Cell is a slot in the ring buffer. seq is the position that may next
+  // write the cell, or the position plus one once the value has been
+  // written.
+  struct Cell {
+    std::atomic<size_t> seq;
+    typename aligned_storage<sizeof(T), alignof(T)>::type value;
+  };
+
+  // Position is a ring buffer position on a cache line of its own.
+  struct alignas(64) Position {
+    std::atomic<size_t> pos = {0};
+  };
+
+  struct Shared {
+    MARL_NO_EXPORT inline Shared(size_t capacity, Allocator* allocator);
+    MARL_NO_EXPORT inline ~Shared();
+
+    // tryPush() moves value into the ring if there is space. value is only
+    // moved from if tryPush() returns true.
+    template <typename V>
+    MARL_NO_EXPORT inline bool tryPush(V&& value);
+
+    // tryPop() moves a value from the ring into out if it is not empty.
+    MARL_NO_EXPORT inline bool tryPop(T& out);
+
+    // push() sends value, calling wait(waiter) to block while the ring is
+    // full. wait() returns false if the wait has timed out.
+    template <typename V, typename Wait>
+    MARL_NO_EXPORT inline bool push(V&& value, const Wait& wait);
+
+    // pop() receives a value into out, calling wait(waiter) to block while the
+    // ring is empty. wait() returns false if the wait has timed out.
+    template <typename Wait>
+    MARL_NO_EXPORT inline bool pop(T& out, const Wait& wait);
+
+    // notify() wakes up to count of the waiters in list. notify() must be
+    // called after updating the ring, which may let count waiters proceed.
+    MARL_NO_EXPORT inline void notify(WaitList& list, size_t count);
+
+    Allocator* const allocator;
+    Allocation allocation;
+    Cell* const cells;
+    const size_t mask;
+    Position enqueue;
+    Position dequeue;
+    std::atomic<bool> isClosed = {false};
+
+    // Slow path state, only used while the ring is full or empty.
+    marl::mutex mutex{"marl::Channel"};
+    WaitList senders;    // guarded by mutex
+    WaitList receivers;  // guarded by mutex
+  };
+
+  // Block waits on a Waiter without a timeout.
+  struct Block {
+    MARL_NO_EXPORT inline bool operator()(Waiter& waiter) const;
+  };
+
+  // Until waits on a Waiter until a timeout.
+  template <typename Clock, typename Duration>
+  struct Until {
+    MARL_NO_EXPORT inline bool operator()(Waiter& waiter) const;
+    const std::chrono::time_point<Clock, Duration>& timeout;
+  };
+
+  const std::shared_ptr<Shared> shared;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Channel::Shared
+////////////////////////////////////////////////////////////////////////////////
+
+namespace detail {
+
+// channelCapacity() returns capacity rounded up to the next power of two.
+// The ring needs at least two cells to tell a full cell from an empty one.
+MARL_NO_EXPORT inline size_t channelCapacity(size_t capacity) {
+  MARL_ASSERT(capacity > 0, "Channel capacity must be greater than 0");
+  size_t rounded = 2;
+  while (rounded < capacity) {
+    rounded *= 2;
+  }
+  return rounded;
+}
+
+// channelAllocate() allocates count objects of type T from allocator.
+template <typename T>
+MARL_NO_EXPORT inline Allocation channelAllocate(Allocator* allocator,
+                                                 size_t count) {
+  Allocation::Request request;
+  request.size = sizeof(T) * count;
+  request.alignment = alignof(T);
+  request.usage = Allocation::Usage::Vector;
+  return allocator->allocate(request);
+}
+
+}  // namespace detail
+
+template <typename T>
+Channel<T>::Shared::Shared(size_t capacity, Allocator* allocator)
+    : allocator(allocator),
+      allocation(detail::channelAllocate<Cell>(
+          allocator,
+          detail::channelCapacity(capacity))),
+      cells(reinterpret_cast<Cell*>(allocation.ptr)),
+      mask(detail::channelCapacity(capacity) - 1) {
+  for (size_t i = 0; i <= mask; i++) {
+    new (&cells[i].seq) std::atomic<size_t>(i);
+  }
+}
+
+template <typename T>
+Channel<T>::Shared::~Shared() {
+  // Destruct the values that were sent but never received.
+  auto end = enqueue.pos.load(std::memory_order_relaxed);
+  for (auto pos = dequeue.pos.load(std::memory_order_relaxed); pos != end;
+       pos++) {
+    reinterpret_cast<T*>(&cells[pos & mask].value)->~T();
+  }
+  allocator->free(allocation);
+}
+
+template <typename T>
+template <typename V>
+bool Channel<T>::Shared::tryPush(V&& value) {
+  auto pos = enqueue.pos.load(std::memory_order_relaxed);
+  Cell* cell;
+  for (;;) {
+    cell = &cells[pos & mask];
+    auto seq = cell->seq.load(std::memory_order_acquire);
+    auto diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+    if (diff == 0) {
+      if (enqueue.pos.compare_exchange_weak(pos, pos + 1,
+                                            std::memory_order_relaxed)) {
+        break;
+      }
+    } else if (diff < 0) {
+      return false;  // Full.
+    } else {
+      pos = enqueue.pos.load(std::memory_order_relaxed);
+    }
+  }
+  new (&cell->value) T(std::forward<V>(value));
+  cell->seq.store(pos + 1, std::memory_order_release);
+  return true;
+}
+
+template <typename T>
+bool Channel<T>::Shared::tryPop(T& out) {
+  auto pos = dequeue.pos.load(std::memory_order_relaxed);
+  Cell* cell;
+  for (;;) {
+    cell = &cells[pos & mask];
+    auto seq = cell->seq.load(std::memory_order_acquire);
+    auto diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+    if (diff == 0) {
+      if (dequeue.pos.compare_exchange_weak(pos, pos + 1,
+                                            std::memory_order_relaxed)) {
+        break;
+      }
+    } else if (diff < 0) {
+      return false;  // Empty.
+    } else {
+      pos = dequeue.pos.load(std::memory_order_relaxed);
+    }
+  }
+  auto value = reinterpret_cast<T*>(&cell->value);
+  out = std::move(*value);
+  value->~T();
+  cell->seq.store(pos + mask + 1, std::memory_order_release);
+  return true;
+}
+
+template <typename T>
+template <typename V, typename Wait>
+bool Channel<T>::Shared::push(V&& value, const Wait& wait) {
+  if (isClosed.load(std::memory_order_acquire)) {
+    return false;
+  }
+  if (!tryPush(std::forward<V>(value))) {
+    // Add a waiter to senders before trying again, so that a receiver that
+    // makes space after the failed attempt notifies it. Each receiver only
+    // notifies one waiter per value received, so a notified waiter always
+    // tries again rather than giving up.
+    Waiter waiter(this, "marl::Channel");
+    WaitList::Node node;
+    for (;;) {
+      {
+        marl::lock lock(mutex);
+        if (isClosed.load(std::memory_order_acquire)) {
+          return false;
+        }
+        senders.add(node, waiter);
+      }
+      if (tryPush(std::forward<V>(value))) {
+        marl::lock lock(mutex);
+        senders.remove(node);
+        break;
+      }
+      bool notified = wait(waiter);
+      marl::lock lock(mutex);
+      if (senders.remove(node) && !notified) {
+        return false;  // Timed out.
+      }
+      waiter.reset();
+    }
+  }
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  notify(receivers, 1);
+  return true;
+}
+
+template <typename T>
+template <typename Wait>
+bool Channel<T>::Shared::pop(T& out, const Wait& wait) {
+  if (!tryPop(out)) {
+    // See push().
+    Waiter waiter(this, "marl::Channel");
+    WaitList::Node node;
+    for (;;) {
+      {
+        marl::lock lock(mutex);
+        receivers.add(node, waiter);
+      }
+      // Values sent before the channel was closed are still received.
+      bool closed = isClosed.load(std::memory_order_acquire);
+      if (tryPop(out)) {
+        marl::lock lock(mutex);
+        receivers.remove(node);
+        break;
+      }
+      if (closed) {
+        marl::lock lock(mutex);
+        receivers.remove(node);
+        return false;
+      }
+      bool notified = wait(waiter);
+      marl::lock lock(mutex);
+      if (receivers.remove(node) && !notified) {
+        return false;  // Timed out.
+      }
+      waiter.reset();
+    }
+  }
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  notify(senders, 1);
+  return true;
+}
+
+template <typename T>
+void Channel<T>::Shared::notify(WaitList& list, size_t count) {
+  if (list.empty()) {
+    return;
+  }
+  marl::lock lock(mutex);
+  list.notify(count);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Channel::Block and Channel::Until
+////////////////////////////////////////////////////////////////////////////////
+
+template <typename T>
+bool Channel<T>::Block::operator()(Waiter& waiter) const {
+  waiter.wait();
+  return true;
+}
+
+template <typename T>
+template <typename Clock, typename Duration>
+bool Channel<T>::Until<Clock, Duration>::operator()(Waiter& waiter) const {
+  return waiter.wait_until(timeout);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Channel
+////////////////////////////////////////////////////////////////////////////////
+
+template <typename T>
+Channel<T>::Channel(size_t capacity,
+                    Allocator* allocator /* = Allocator::Default */)
+    : shared(allocator->make_shared<Shared>(capacity, allocator)) {}
+
+template <typename T>
+bool Channel<T>::send(const T& value) const {
+  return shared->push(value, Block{});
+}
+
+template <typename T>
+bool Channel<T>::send(T&& value) const {
+  return shared->push(std::move(value), Block{});
+}
+
+template <typename T>
+bool Channel<T>::try_send(const T& value) const {
+  return try_send(T(value));
+}
+
+template <typename T>
+bool Channel<T>::try_send(T&& value) const {
+  if (shared->isClosed.load(std::memory_order_acquire) ||
+      !shared->tryPush(std::move(value))) {
+    return false;
+  }
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  shared->notify(shared->receivers, 1);
+  return true;
+}
+
+template <typename T>
+template <typename Rep, typename Period>
+bool Channel<T>::try_send_for(
+    T&& value,
+    const std::chrono::duration<Rep, Period>& duration) const {
+  return try_send_until(std::move(value),
+                        std::chrono::system_clock::now() + duration);
+}
+
+template <typename T>
+template <typename Clock, typename Duration>
+bool Channel<T>::try_send_until(
+    T&& value,
+    const std::chrono::time_point<Clock, Duration>& timeout) const {
+  return shared->push(std::move(value), Until<Clock, Duration>{timeout});
+}
+
+template <typename T>
+size_t Channel<T>::send_n(const T* values, size_t n) const {
+  size_t sent = 0;
+  while (sent < n && !shared->isClosed.load(std::memory_order_acquire)) {
+    // Send as many values as fit without blocking, then wake a receiver for
+    // each of them.
+    size_t batch = 0;
+    while (sent + batch < n && shared->tryPush(values[sent + batch])) {
+      batch++;
+    }
+    if (batch > 0) {
+      sent += batch;
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      shared->notify(shared->receivers, batch);
+    } else if (!shared->push(values[sent], Block{})) {
+      break;
+    } else {
+      sent++;
+    }
+  }
+  return sent;
+}
+
+template <typename T>
+bool Channel<T>::recv(T& out) const {
+  return shared->pop(out, Block{});
+}
+
+template <typename T>
+bool Channel<T>::try_recv(T& out) const {
+  if (!shared->tryPop(out)) {
+    return false;
+  }
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  shared->notify(shared->senders, 1);
+  return true;
+}
+
+template <typename T>
+template <typename Rep, typename Period>
+bool Channel<T>::try_recv_for(
+    T& out,
+    const std::chrono::duration<Rep, Period>& duration) const {
+  return try_recv_until(out, std::chrono::system_clock::now() + duration);
+}
+
+template <typename T>
+template <typename Clock, typename Duration>
+bool Channel<T>::try_recv_until(
+    T& out,
+    const std::chrono::time_point<Clock, Duration>& timeout) const {
+  return shared->pop(out, Until<Clock, Duration>{timeout});
+}
+
+template <typename T>
+size_t Channel<T>::recv_n(T* out, size_t n) const {
+  size_t received = 0;
+  while (received < n) {
+    // Receive as many values as are available without blocking, then wake a
+    // sender for each of them.
+    size_t batch = 0;
+    while (received + batch < n && shared->tryPop(out[received + batch])) {
+      batch++;
+    }
+    if (batch > 0) {
+      received += batch;
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      shared->notify(shared->senders, batch);
+    } else if (!shared->pop(out[received], Block{})) {
+      break;
+    } else {
+      received++;
+    }
+  }
+  return received;
+}
+
+template <typename T>
+void Channel<T>::close() const {
+  shared->isClosed.store(true, std::memory_order_release);
+  marl::lock lock(shared->mutex);
+  shared->senders.notifyAll();
+  shared->receivers.notifyAll();
+}
+
+template <typename T>
+bool Channel<T>::closed() const {
+  return shared->isClosed.load(std::memory_order_acquire);
+}
+
+template <typename T>
+size_t Channel<T>::capacity() const {
+  return shared->mask + 1;
+}
+
+template <typename T>
+typename Channel<T>::RecvCase Channel<T>::onRecv(T& out, bool& ok) const {
+  return RecvCase(shared.get(), out, ok);
+}
+
+template <typename T>
+typename Channel<T>::SendCase Channel<T>::onSend(T& value, bool& ok) const {
+  return SendCase(shared.get(), value, ok);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Channel::RecvCase and Channel::SendCase
+////////////////////////////////////////////////////////////////////////////////
+
+template <typename T>
+Channel<T>::RecvCase::RecvCase(Shared* shared, T& out, bool& ok)
+    : shared(shared), out(out), ok(ok) {}
+
+template <typename T>
+bool Channel<T>::RecvCase::tryComplete() {
+  bool closed = shared->isClosed.load(std::memory_order_acquire);
+  if (shared->tryPop(out)) {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    shared->notify(shared->senders, 1);
+    ok = true;
+    return true;
+  }
+  if (closed) {
+    ok = false;
+    return true;
+  }
+  return false;
+}
+
+template <typename T>
+void Channel<T>::RecvCase::add(WaitList::Node& node, Waiter& waiter) {
+  marl::lock lock(shared->mutex);
+  shared->receivers.add(node, waiter);
+}
+
+template <typename T>
+bool Channel<T>::RecvCase::remove(WaitList::Node& node) {
+  marl::lock lock(shared->mutex);
+  return shared->receivers.remove(node);
+}
+
+template <typename T>
+void Channel<T>::RecvCase::notifyNext() {
+  shared->notify(shared->receivers, 1);
+}
+
+template <typename T>
+Channel<T>::SendCase::SendCase(Shared* shared, T& value, bool& ok)
+    : shared(shared), value(value), ok(ok) {}
+
+template <typename T>
+bool Channel<T>::SendCase::tryComplete() {
+  if (shared->isClosed.load(std::memory_order_acquire)) {
+    ok = false;
+    return true;
+  }
+  if (shared->tryPush(std::move(value))) {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    shared->notify(shared->receivers, 1);
+    ok = true;
+    return true;
+  }
+  return false;
+}
+
+template <typename T>
+void Channel<T>::SendCase::add(WaitList::Node& node, Waiter& waiter) {
+  marl::lock lock(shared->mutex);
+  shared->senders.add(node, waiter);
+}
+
+template <typename T>
+bool Channel<T>::SendCase::remove(WaitList::Node& node) {
+  marl::lock lock(shared->mutex);
+  return shared->senders.remove(node);
+}
+
+template <typename T>
+void Channel<T>::SendCase::notifyNext() {
+  shared->notify(shared->senders, 1);
+}
+
+}  // namespace marl
+
+#endif  // marl_channel_h
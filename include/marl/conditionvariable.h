@@ -35,8 +35,11 @@ namespace marl {
 // thread will work on other tasks until the ConditionVariable is unblocked.
 class ConditionVariable {
  public:
+  // kind is the name of the primitive type reported to the scheduler's
+  // ContentionProfiler for fibers blocked on this ConditionVariable.
   MARL_NO_EXPORT inline ConditionVariable(
-      Allocator* allocator = Allocator::Default);
+      Allocator* allocator = Allocator::Default,
+      const char* kind = "marl::ConditionVariable");
 
   // notify_one() notifies and potentially unblocks one waiting fiber or thread.
   MARL_NO_EXPORT inline void notify_one();
@@ -76,7 +79,8 @@ class ConditionVariable {
   ConditionVariable& operator=(const ConditionVariable&) = delete;
   ConditionVariable& operator=(ConditionVariable&&) = delete;
 
-  marl::mutex mutex;
+  const char* const kind;
+  marl::mutex mutex{"marl::ConditionVariable"};
   containers::list<Scheduler::Fiber*> waiting;
   std::condition_variable condition;
   std::atomic<int> numWaiting = {0};
@@ -84,8 +88,9 @@ class ConditionVariable {
 };
 
 ConditionVariable::ConditionVariable(
-    Allocator* allocator /* = Allocator::Default */)
-    : waiting(allocator) {}
+    Allocator* allocator /* = Allocator::Default */,
+    const char* kind /* = "marl::ConditionVariable" */)
+    : kind(kind), waiting(allocator) {}
 
 void ConditionVariable::notify_one() {
   if (numWaiting == 0) {
@@ -131,7 +136,9 @@ void ConditionVariable::wait(marl::lock& lock, Predicate&& pred) {
     auto it = waiting.emplace_front(fiber);
     mutex.unlock();
 
+    fiber->setBlocker(this, kind);
     fiber->wait(lock, pred);
+    fiber->setBlocker(nullptr, nullptr);
 
     mutex.lock();
     waiting.erase(it);
@@ -172,7 +179,9 @@ bool ConditionVariable::wait_until(
     auto it = waiting.emplace_front(fiber);
     mutex.unlock();
 
+    fiber->setBlocker(this, kind);
     auto res = fiber->wait(lock, timeout, pred);
+    fiber->setBlocker(nullptr, nullptr);
 
     mutex.lock();
     waiting.erase(it);
@@ -0,0 +1,148 @@
+// Copyright 2026 The Marl Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef marl_contention_profiler_h
+#define marl_contention_profiler_h
+
+#include "containers.h"
+#include "export.h"
+#include "mutex.h"
+
+#include <atomic>
+#include <chrono>
+#include <typeinfo>
+
+namespace marl {
+
+// ContentionProfiler records the time that fibers spend suspended waiting on
+// synchronization primitives, such as marl::ConditionVariable, marl::Event,
+// marl::WaitGroup and marl::Ticket. Waits are grouped by the primitive
+// instance that was waited on, and by the site of the task that waited (see
+// Task::site()).
+//
+// Only one in every sampleRate suspensions of each worker is timed, which
+// bounds the overhead of the profiler. The counts and times reported are
+// those of the sampled suspensions.
+//
+// Each worker records its sampled waits into its own fixed-capacity table,
+// without taking a lock or allocating memory. top() merges the tables of all
+// the workers. If a worker's table is full, the least contended group in the
+// table is evicted to make room for a new one, so memory use does not grow
+// with the number of primitive instances that are waited on.
+//
+// Example usage:
+//
+//   auto profiler = std::make_shared<marl::ContentionProfiler>();
+//   marl::Scheduler scheduler(marl::Scheduler::Config::allCores()
+//                                 .setContentionProfiler(profiler));
+//   ...
+//   for (auto& c : profiler->top(10)) {
+//     printf("%s %p in %s: %d ns\n", c.kind, c.object, c.site,
+//            int(c.total.count()));
+//   }
+class ContentionProfiler {
+ public:
+  using Duration = std::chrono::nanoseconds;
+
+  // GroupBy specifies how top() aggregates the recorded waits.
+  enum class GroupBy {
+    Object,         // By primitive instance.
+    Site,           // By the site of the waiting task.
+    ObjectAndSite,  // By primitive instance and site of the waiting task.
+  };
+
+  // Contention holds the sampled waits of a group.
+  struct Contention {
+    // The primitive instance, or nullptr if grouped by site or the fibers
+    // waited without a blocker (see Scheduler::Fiber::setBlocker()).
+    const void* object = nullptr;
+
+    // The name of the primitive type, or "<unknown>" if the primitive is
+    // unknown or grouped by site.
+    const char* kind = nullptr;
+
+    // The name of the waiting task's function type, or "<unknown>" if the
+    // site is unknown or grouped by object.
+    const char* site = nullptr;
+
+    // The number of sampled waits.
+    uint64_t count = 0;
+
+    // The total time the sampled waits were suspended for.
+    Duration total = Duration(0);
+
+    // The longest time a single sampled wait was suspended for.
+    Duration max = Duration(0);
+  };
+
+  using Contentions = containers::vector<Contention, 16>;
+
+  // The default number of suspensions per sampled suspension.
+  static constexpr uint32_t DefaultSampleRate = 64;
+
+  // Constructs a ContentionProfiler that times one in every sampleRate
+  // suspensions. sampleRate must be greater than 0.
+  MARL_EXPORT ContentionProfiler(uint32_t sampleRate = DefaultSampleRate,
+                                 Allocator* allocator = Allocator::Default);
+
+  MARL_EXPORT ~ContentionProfiler();
+
+  // top() returns at most n groups of the waits recorded since construction
+  // or the last call to reset(), with the largest total times, sorted by
+  // descending total time.
+  MARL_EXPORT Contentions top(size_t n,
+                              GroupBy groupBy = GroupBy::ObjectAndSite);
+
+  // reset() clears all the recorded waits.
+  MARL_EXPORT void reset();
+
+  // The number of suspensions per sampled suspension.
+  const uint32_t sampleRate;
+
+ private:
+  friend class Scheduler;
+
+  // Table holds the sampled waits recorded by a single worker.
+  class Table;
+
+  ContentionProfiler(const ContentionProfiler&) = delete;
+  ContentionProfiler& operator=(const ContentionProfiler&) = delete;
+
+  // acquire() returns a table for a worker to record its sampled waits into,
+  // reusing a table released by an earlier worker if there is one.
+  MARL_EXPORT Table* acquire();
+
+  // release() returns a table acquired by a worker that has stopped. The
+  // waits recorded in the table are still reported by top().
+  MARL_EXPORT void release(Table* table);
+
+  // record() records a sampled wait of ticks CycleClock ticks on the
+  // primitive object of type kind, by a task of site, into table. record()
+  // must only be called by the worker that acquired table.
+  MARL_EXPORT void record(Table* table,
+                          const void* object,
+                          const char* kind,
+                          const std::type_info* site,
+                          uint64_t ticks);
+
+  Allocator* const allocator;
+  // Incremented by reset(). Tables recorded in an earlier epoch are ignored.
+  std::atomic<uint64_t> epoch = {0};
+  marl::mutex mutex;
+  GUARDED_BY(mutex) containers::vector<Table*, 16> tables;
+};
+
+}  // namespace marl
+
+#endif  // marl_contention_profiler_h
@@ -0,0 +1,559 @@
+// Copyright 2026 The Marl Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef marl_coro_h
+#define marl_coro_h
+
+// marl::coro requires C++20 coroutines. MARL_CORO_SUPPORTED is 1 if they are
+// available, otherwise this header declares nothing.
+#if !defined(MARL_CORO_SUPPORTED)
+#if defined(__cpp_impl_coroutine) && defined(__has_include)
+#if __has_include(<coroutine>)
+#define MARL_CORO_SUPPORTED 1
+#endif
+#endif
+#endif
+
+#if !defined(MARL_CORO_SUPPORTED)
+#define MARL_CORO_SUPPORTED 0
+#endif
+
+#if MARL_CORO_SUPPORTED
+
+#include "debug.h"
+#include "event.h"
+#include "future.h"
+#include "memory.h"
+#include "scheduler.h"
+#include "task.h"
+#include "ticket.h"
+#include "waiter.h"
+#include "waitgroup.h"
+
+#include <atomic>
+#include <chrono>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+namespace marl {
+namespace coro {
+
+template <typename T>
+class Task;
+
+namespace detail {
+
+// FrameAllocator allocates coroutine frames from the allocator of the
+// scheduler bound to the calling thread, or Allocator::Default if no
+// scheduler is bound. The allocator is stored in a header before the frame,
+// so that the frame can be freed from any thread.
+struct FrameAllocator {
+  static constexpr size_t HeaderSize = __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+
+  MARL_NO_EXPORT static inline void* operator new(size_t size);
+  MARL_NO_EXPORT static inline void operator delete(void* ptr, size_t size);
+
+  // request() returns the allocation request for a frame of size bytes.
+  MARL_NO_EXPORT static inline Allocation::Request request(size_t size);
+};
+
+void* FrameAllocator::operator new(size_t size) {
+  auto scheduler = Scheduler::get();
+  auto allocator =
+      scheduler != nullptr ? scheduler->config().allocator : Allocator::Default;
+  auto allocation = allocator->allocate(request(size));
+  *reinterpret_cast<Allocator**>(allocation.ptr) = allocator;
+  return reinterpret_cast<uint8_t*>(allocation.ptr) + HeaderSize;
+}
+
+void FrameAllocator::operator delete(void* ptr, size_t size) {
+  Allocation allocation;
+  allocation.ptr = reinterpret_cast<uint8_t*>(ptr) - HeaderSize;
+  allocation.request = request(size);
+  (*reinterpret_cast<Allocator**>(allocation.ptr))->free(allocation);
+}
+
+Allocation::Request FrameAllocator::request(size_t size) {
+  Allocation::Request request;
+  request.size = size + HeaderSize;
+  request.alignment = HeaderSize;
+  request.usage = Allocation::Usage::Create;
+  return request;
+}
+
+// TaskPromiseBase is the part of the promise of a Task that does not depend
+// on the type of the result.
+class TaskPromiseBase : public FrameAllocator {
+ public:
+  // FinalAwaiter resumes the coroutine awaiting the task once the task has
+  // completed, unless the task completed before Awaiter::await_suspend()
+  // returned, in which case the awaiting coroutine is resumed by returning
+  // false from Awaiter::await_suspend(). This keeps the stack depth constant
+  // for tasks that complete synchronously, without relying on the compiler
+  // to turn symmetric transfer into a tail call.
+  struct FinalAwaiter {
+    MARL_NO_EXPORT inline bool await_ready() noexcept { return false; }
+
+    template <typename Promise>
+    MARL_NO_EXPORT inline void await_suspend(
+        std::coroutine_handle<Promise> handle) noexcept {
+      auto& promise = handle.promise();
+      auto continuation = promise.continuation;
+      if (promise.started.exchange(true, std::memory_order_acq_rel)) {
+        // Awaiter::await_suspend() has returned, so the awaiting coroutine is
+        // suspended. The frame of this task may be destroyed by the resumed
+        // coroutine, so it must not be touched after this call.
+        continuation.resume();
+      }
+    }
+
+    MARL_NO_EXPORT inline void await_resume() noexcept {}
+  };
+
+  // Tasks are lazy: they start when they are awaited or scheduled.
+  MARL_NO_EXPORT inline std::suspend_always initial_suspend() noexcept {
+    return {};
+  }
+
+  MARL_NO_EXPORT inline FinalAwaiter final_suspend() noexcept { return {}; }
+
+  MARL_NO_EXPORT inline void unhandled_exception() { std::terminate(); }
+
+  // The coroutine awaiting the task.
+  std::coroutine_handle<> continuation;
+
+  // Set by whichever of Awaiter::await_suspend() returning and the task
+  // reaching its final suspend point happens first. The other is responsible
+  // for resuming continuation.
+  std::atomic<bool> started = {false};
+};
+
+// TaskPromise is the promise of a Task<T>.
+template <typename T>
+class TaskPromise : public TaskPromiseBase {
+ public:
+  MARL_NO_EXPORT inline Task<T> get_return_object();
+
+  template <typename V>
+  MARL_NO_EXPORT inline void return_value(V&& value) {
+    result.emplace(std::forward<V>(value));
+  }
+
+  // take() moves the result out of the promise.
+  MARL_NO_EXPORT inline T take() { return std::move(*result); }
+
+ private:
+  std::optional<T> result;
+};
+
+template <>
+class TaskPromise<void> : public TaskPromiseBase {
+ public:
+  MARL_NO_EXPORT inline Task<void> get_return_object();
+  MARL_NO_EXPORT inline void return_void() {}
+  MARL_NO_EXPORT inline void take() {}
+};
+
+// resumeTask() returns a marl::Task that resumes the coroutine handle.
+MARL_NO_EXPORT inline marl::Task resumeTask(std::coroutine_handle<> handle) {
+  return marl::Task([handle] { handle.resume(); });
+}
+
+}  // namespace detail
+
+// Task is a lazily started coroutine that returns a value of type T.
+//
+// Unlike a marl::Task, which runs on a fiber with its own stack, a suspended
+// Task only holds its coroutine frame. co_await on an Event, WaitGroup,
+// Ticket, Future, select() case or sleep_for() suspends the frame, rather
+// than the fiber, and the coroutine is resumed by a new task enqueued on the
+// scheduler once the awaited object is ready. Frames are allocated from the
+// allocator of the scheduler bound to the thread that calls the coroutine.
+//
+// A Task starts when it is awaited by another coroutine, which is resumed
+// with its result, or when it is passed to coro::schedule().
+//
+// Example:
+//
+//   marl::coro::Task<int> handle(marl::Event request, int value) {
+//     co_await request;
+//     co_await marl::coro::sleep_for(std::chrono::milliseconds(10));
+//     co_return value * 2;
+//   }
+//
+//   marl::Future<int> result = marl::coro::schedule(handle(request, 21));
+template <typename T = void>
+class [[nodiscard]] Task {
+ public:
+  using promise_type = detail::TaskPromise<T>;
+
+  MARL_NO_EXPORT inline Task(Task&& other) noexcept;
+  MARL_NO_EXPORT inline Task& operator=(Task&& other) noexcept;
+  MARL_NO_EXPORT inline ~Task();
+
+  // Awaiter starts the task, and resumes the awaiting coroutine with the
+  // result of the task once it has completed.
+  class Awaiter {
+   public:
+    MARL_NO_EXPORT inline bool await_ready() noexcept { return false; }
+
+    // await_suspend() runs the task until it first suspends or completes.
+    // Returns false, resuming the awaiting coroutine immediately, if the
+    // task has completed.
+    MARL_NO_EXPORT inline bool await_suspend(
+        std::coroutine_handle<> awaiting) noexcept {
+      auto& promise = handle.promise();
+      promise.continuation = awaiting;
+      handle.resume();
+      return !promise.started.exchange(true, std::memory_order_acq_rel);
+    }
+
+    MARL_NO_EXPORT inline T await_resume() { return handle.promise().take(); }
+
+    std::coroutine_handle<promise_type> handle;
+  };
+
+  MARL_NO_EXPORT inline Awaiter operator co_await() && noexcept;
+
+ private:
+  friend promise_type;
+
+  Task(const Task&) = delete;
+  Task& operator=(const Task&) = delete;
+
+  MARL_NO_EXPORT inline explicit Task(
+      std::coroutine_handle<promise_type> handle);
+
+  std::coroutine_handle<promise_type> handle;
+};
+
+template <typename T>
+Task<T>::Task(std::coroutine_handle<promise_type> handle) : handle(handle) {}
+
+template <typename T>
+Task<T>::Task(Task&& other) noexcept
+    : handle(std::exchange(other.handle, nullptr)) {}
+
+template <typename T>
+Task<T>& Task<T>::operator=(Task&& other) noexcept {
+  if (this != &other) {
+    if (handle) {
+      handle.destroy();
+    }
+    handle = std::exchange(other.handle, nullptr);
+  }
+  return *this;
+}
+
+template <typename T>
+Task<T>::~Task() {
+  if (handle) {
+    handle.destroy();
+  }
+}
+
+template <typename T>
+typename Task<T>::Awaiter Task<T>::operator co_await() && noexcept {
+  return Awaiter{handle};
+}
+
+template <typename T>
+Task<T> detail::TaskPromise<T>::get_return_object() {
+  return Task<T>(std::coroutine_handle<TaskPromise>::from_promise(*this));
+}
+
+Task<void> detail::TaskPromise<void>::get_return_object() {
+  return Task<void>(std::coroutine_handle<TaskPromise>::from_promise(*this));
+}
+
+namespace detail {
+
+// Detached is a coroutine that destroys its own frame once it completes.
+struct Detached {
+  struct promise_type : FrameAllocator {
+    MARL_NO_EXPORT inline Detached get_return_object() {
+      return {std::coroutine_handle<promise_type>::from_promise(*this)};
+    }
+    MARL_NO_EXPORT inline std::suspend_always initial_suspend() noexcept {
+      return {};
+    }
+    MARL_NO_EXPORT inline std::suspend_never final_suspend() noexcept {
+      return {};
+    }
+    MARL_NO_EXPORT inline void return_void() {}
+    MARL_NO_EXPORT inline void unhandled_exception() { std::terminate(); }
+  };
+
+  std::coroutine_handle<promise_type> handle;
+};
+
+// run() awaits task, and sets the value of promise to its result.
+template <typename T>
+Detached run(Task<T> task, marl::Promise<T> promise) {
+  if constexpr (std::is_void_v<T>) {
+    co_await std::move(task);
+    promise.set_value();
+  } else {
+    promise.set_value(co_await std::move(task));
+  }
+}
+
+}  // namespace detail
+
+// schedule() starts task on the scheduler bound to the calling thread, and
+// returns a Future for its result. The Future can be awaited by coroutines,
+// or waited on by fibers and threads.
+template <typename T>
+MARL_NO_EXPORT inline Future<T> schedule(Task<T> task) {
+  MARL_ASSERT_HAS_BOUND_SCHEDULER("marl::coro::schedule");
+  marl::Promise<T> promise;
+  auto future = promise.get_future();
+  auto root = detail::run(std::move(task), promise);
+  Scheduler::get()->enqueue(detail::resumeTask(root.handle));
+  return future;
+}
+
+namespace detail {
+
+// SelectableAwaiter suspends a coroutine until a select() case completes.
+//
+// The awaiter adds a Waiter to the case's object that enqueues a task to try
+// the case again once notified. The coroutine is only resumed once the case
+// has completed.
+template <typename Case>
+class SelectableAwaiter {
+ public:
+  MARL_NO_EXPORT inline explicit SelectableAwaiter(Case selectable);
+
+  MARL_NO_EXPORT inline bool await_ready() { return false; }
+  MARL_NO_EXPORT inline bool await_suspend(std::coroutine_handle<> handle);
+  MARL_NO_EXPORT inline void await_resume() {}
+
+ private:
+  enum State : uint8_t {
+    Arming,    // arm() is adding the waiter.
+    Armed,     // arm() has returned, and the coroutine is suspended.
+    Notified,  // The waiter has been notified.
+  };
+
+  SelectableAwaiter(const SelectableAwaiter&) = delete;
+  SelectableAwaiter& operator=(const SelectableAwaiter&) = delete;
+
+  // arm() completes the case and returns true, or adds the waiter to the
+  // case's object and returns false.
+  MARL_NO_EXPORT inline bool arm();
+
+  // onNotify() is called by the waiter when notified. If arm() has returned,
+  // onNotify() enqueues a task to call arm() again, otherwise arm() tries the
+  // case again itself.
+  MARL_NO_EXPORT static inline void onNotify(void* data);
+
+  Case selectable;
+  Waiter waiter;
+  WaitList::Node node;
+  std::atomic<State> state = {Arming};
+  Scheduler* scheduler = nullptr;
+  std::coroutine_handle<> handle;
+};
+
+template <typename Case>
+SelectableAwaiter<Case>::SelectableAwaiter(Case selectable)
+    : selectable(std::move(selectable)), waiter(&onNotify, this) {}
+
+template <typename Case>
+bool SelectableAwaiter<Case>::await_suspend(std::coroutine_handle<> h) {
+  MARL_ASSERT_HAS_BOUND_SCHEDULER("co_await");
+  handle = h;
+  scheduler = Scheduler::get();
+  return !arm();
+}
+
+template <typename Case>
+bool SelectableAwaiter<Case>::arm() {
+  for (;;) {
+    if (selectable.tryComplete()) {
+      return true;
+    }
+    state.store(Arming, std::memory_order_relaxed);
+    selectable.add(node, waiter);
+    if (selectable.tryComplete()) {
+      if (!selectable.remove(node)) {
+        // The object notified the waiter while arming, but the case has
+        // already completed.
+        selectable.notifyNext();
+      }
+      return true;
+    }
+    if (state.exchange(Armed, std::memory_order_acq_rel) != Notified) {
+      return false;
+    }
+    // The object notified the waiter while arming, so try again.
+  }
+}
+
+template <typename Case>
+void SelectableAwaiter<Case>::onNotify(void* data) {
+  auto self = reinterpret_cast<SelectableAwaiter*>(data);
+  if (self->state.exchange(Notified, std::memory_order_acq_rel) == Armed) {
+    self->scheduler->enqueue(marl::Task([self] {
+      // The coroutine may destruct the awaiter as soon as it is resumed.
+      auto handle = self->handle;
+      if (self->arm()) {
+        handle.resume();
+      }
+    }));
+  }
+}
+
+// TicketAwaiter suspends a coroutine until a Ticket is called.
+class TicketAwaiter {
+ public:
+  MARL_NO_EXPORT inline explicit TicketAwaiter(const Ticket& ticket)
+      : ticket(ticket) {}
+
+  MARL_NO_EXPORT inline bool await_ready() { return false; }
+
+  MARL_NO_EXPORT inline void await_suspend(std::coroutine_handle<> handle) {
+    // onCall() schedules the function as a new task once the ticket is
+    // called.
+    ticket.onCall([handle] { handle.resume(); });
+  }
+
+  MARL_NO_EXPORT inline void await_resume() {}
+
+ private:
+  const Ticket ticket;
+};
+
+// FutureAwaiter suspends a coroutine until a Future is ready.
+template <typename T>
+class FutureAwaiter {
+ public:
+  MARL_NO_EXPORT inline explicit FutureAwaiter(const Future<T>& future)
+      : future(future) {}
+
+  MARL_NO_EXPORT inline bool await_ready() { return future.ready(); }
+
+  MARL_NO_EXPORT inline void await_suspend(std::coroutine_handle<> handle) {
+    marl::detail::FutureAccess::state(future)->then(Scheduler::get(),
+                                                    resumeTask(handle));
+  }
+
+  MARL_NO_EXPORT inline T await_resume() { return future.get(); }
+
+ private:
+  const Future<T> future;
+};
+
+// SleepAwaiter suspends a coroutine until a deadline. The coroutine is
+// resumed by a task that the bound scheduler holds until the deadline, so no
+// fiber is blocked per sleeping coroutine, and the sleeping coroutines of a
+// scheduler do not outlive it.
+class SleepAwaiter {
+ public:
+  using Clock = std::chrono::system_clock;
+
+  MARL_NO_EXPORT inline explicit SleepAwaiter(Clock::time_point deadline)
+      : deadline(deadline) {}
+
+  MARL_NO_EXPORT inline bool await_ready() { return Clock::now() >= deadline; }
+
+  MARL_NO_EXPORT inline void await_suspend(std::coroutine_handle<> handle) {
+    MARL_ASSERT_HAS_BOUND_SCHEDULER("marl::coro::sleep_until");
+    Scheduler::get()->enqueue(resumeTask(handle), deadline);
+  }
+
+  MARL_NO_EXPORT inline void await_resume() {}
+
+ private:
+  const Clock::time_point deadline;
+};
+
+}  // namespace detail
+
+// sleep_until() returns an awaitable that suspends the coroutine until the
+// timeout has been reached.
+template <typename Clock, typename Duration>
+MARL_NO_EXPORT inline detail::SleepAwaiter sleep_until(
+    const std::chrono::time_point<Clock, Duration>& timeout) {
+  using SystemClock = detail::SleepAwaiter::Clock;
+  return detail::SleepAwaiter(
+      SystemClock::now() + std::chrono::duration_cast<SystemClock::duration>(
+                               timeout - Clock::now()));
+}
+
+// sleep_for() returns an awaitable that suspends the coroutine until the
+// duration has elapsed.
+template <typename Rep, typename Period>
+MARL_NO_EXPORT inline detail::SleepAwaiter sleep_for(
+    const std::chrono::duration<Rep, Period>& duration) {
+  using SystemClock = detail::SleepAwaiter::Clock;
+  return detail::SleepAwaiter(
+      SystemClock::now() +
+      std::chrono::duration_cast<SystemClock::duration>(duration));
+}
+
+}  // namespace coro
+
+// co_await on an Event suspends the coroutine until the event is signalled.
+// See Event::wait().
+MARL_NO_EXPORT inline coro::detail::SelectableAwaiter<Event::SignalCase>
+operator co_await(const Event& event) {
+  return coro::detail::SelectableAwaiter<Event::SignalCase>(event.onSignal());
+}
+
+// co_await on a WaitGroup suspends the coroutine until the counter reaches
+// zero. See WaitGroup::wait().
+MARL_NO_EXPORT inline coro::detail::SelectableAwaiter<WaitGroup::DoneCase>
+operator co_await(const WaitGroup& wg) {
+  return coro::detail::SelectableAwaiter<WaitGroup::DoneCase>(wg.onDone());
+}
+
+// co_await on a Ticket suspends the coroutine until the ticket is called.
+// See Ticket::wait().
+MARL_NO_EXPORT inline coro::detail::TicketAwaiter operator co_await(
+    const Ticket& ticket) {
+  return coro::detail::TicketAwaiter(ticket);
+}
+
+// co_await on a Future suspends the coroutine until the value has been set,
+// and returns a copy of the value.
+template <typename T>
+MARL_NO_EXPORT inline coro::detail::FutureAwaiter<T> operator co_await(
+    const Future<T>& future) {
+  return coro::detail::FutureAwaiter<T>(future);
+}
+
+// co_await on a select() case, such as Channel::onRecv(), suspends the
+// coroutine until the case has completed.
+template <typename Case>
+MARL_NO_EXPORT inline typename std::enable_if<
+    std::is_base_of<Selectable, Case>::value,
+    coro::detail::SelectableAwaiter<Case>>::type
+operator co_await(Case&& selectable) {
+  return coro::detail::SelectableAwaiter<Case>(std::move(selectable));
+}
+
+}  // namespace marl
+
+#endif  // MARL_CORO_SUPPORTED
+
+#endif  // marl_coro_h
@@ -101,6 +101,11 @@ class DAGBase {
     MARL_NO_EXPORT inline Node() = default;
     MARL_NO_EXPORT inline Node(Work&& work);
     MARL_NO_EXPORT inline Node(const Work& work);
+    MARL_NO_EXPORT inline Node(Allocator* allocator);
+    MARL_NO_EXPORT inline Node(Work&& work, Allocator* allocator);
+
+    // Move constructor that preserves the allocator used by outs.
+    MARL_NO_EXPORT inline Node(Node&& other);
 
     // The work to perform for this node in the graph.
     Work work;
@@ -114,6 +119,9 @@ class DAGBase {
     containers::vector<NodeIndex, NumReservedNumOuts> outs;
   };
 
+  // Constructs the DAGBase, using allocator for the node lists.
+  MARL_NO_EXPORT inline DAGBase(Allocator* allocator = Allocator::Default);
+
   // initCounters() allocates and initializes the ctx->coutners from
   // initialCounters.
   MARL_NO_EXPORT inline void initCounters(RunContext* ctx,
@@ -147,6 +155,23 @@ DAGBase<T>::Node::Node(Work&& work) : work(std::move(work)) {}
 template <typename T>
 DAGBase<T>::Node::Node(const Work& work) : work(work) {}
 
+template <typename T>
+DAGBase<T>::Node::Node(Allocator* allocator) : outs(allocator) {}
+
+template <typename T>
+DAGBase<T>::Node::Node(Work&& work, Allocator* allocator)
+    : work(std::move(work)), outs(allocator) {}
+
+template <typename T>
+DAGBase<T>::Node::Node(Node&& other)
+    : work(std::move(other.work)),
+      counterIndex(other.counterIndex),
+      outs(std::move(other.outs), other.outs.allocator) {}
+
+template <typename T>
+DAGBase<T>::DAGBase(Allocator* allocator /* = Allocator::Default */)
+    : nodes(allocator), initialCounters(allocator) {}
+
 template <typename T>
 void DAGBase<T>::initCounters(RunContext* ctx, Allocator* allocator) {
   auto numCounters = initialCounters.size();
@@ -297,6 +322,7 @@ class DAGBuilder {
  private:
   static const constexpr size_t NumReservedNumIns = 4;
   using Node = typename DAG<T>::Node;
+  using Work = typename DAG<T>::Work;
 
   // The DAG being built.
   Allocator::unique_ptr<DAG<T>> dag;
@@ -307,9 +333,9 @@ class DAGBuilder {
 
 template <typename T>
 DAGBuilder<T>::DAGBuilder(Allocator* allocator /* = Allocator::Default */)
-    : dag(allocator->make_unique<DAG<T>>()), numIns(allocator) {
+    : dag(allocator->make_unique<DAG<T>>(allocator)), numIns(allocator) {
   // Add root
-  dag->nodes.emplace_back(Node{});
+  dag->nodes.emplace_back(Node{allocator});
   numIns.emplace_back(0);
 }
 
@@ -333,7 +359,8 @@ DAGNodeBuilder<T> DAGBuilder<T>::node(
               "NodeBuilder vectors out of sync");
   auto index = dag->nodes.size();
   numIns.emplace_back(0);
-  dag->nodes.emplace_back(Node{std::forward<F>(work)});
+  dag->nodes.emplace_back(
+      Node{Work{std::forward<F>(work)}, dag->nodes.allocator});
   auto node = DAGNodeBuilder<T>{this, index};
   for (auto in : after) {
     addDependency(in, node);
@@ -372,6 +399,10 @@ class DAG : public DAGBase<T> {
   using Builder = DAGBuilder<T>;
   using NodeBuilder = DAGNodeBuilder<T>;
 
+  // Constructs an empty DAG, using allocator for the graph's nodes.
+  // DAGs are usually constructed with DAGBuilder.
+  MARL_NO_EXPORT inline DAG(Allocator* allocator = Allocator::Default);
+
   // run() invokes the function of each node in the graph of the DAG, passing
   // data to each, starting with the root node. All dependencies need to have
   // completed their function before dependees will be invoked.
@@ -379,6 +410,10 @@ class DAG : public DAGBase<T> {
                                  Allocator* allocator = Allocator::Default);
 };
 
+template <typename T>
+DAG<T>::DAG(Allocator* allocator /* = Allocator::Default */)
+    : DAGBase<T>(allocator) {}
+
 template <typename T>
 void DAG<T>::run(T& arg, Allocator* allocator /* = Allocator::Default */) {
   typename DAGBase<T>::RunContext ctx{arg};
@@ -397,12 +432,19 @@ class DAG<void> : public DAGBase<void> {
   using Builder = DAGBuilder<void>;
   using NodeBuilder = DAGNodeBuilder<void>;
 
+  // Constructs an empty DAG, using allocator for the graph's nodes.
+  // DAGs are usually constructed with DAGBuilder.
+  MARL_NO_EXPORT inline DAG(Allocator* allocator = Allocator::Default);
+
   // run() invokes the function of each node in the graph of the DAG, starting
   // with the root node. All dependencies need to have completed their function
   // before dependees will be invoked.
   MARL_NO_EXPORT inline void run(Allocator* allocator = Allocator::Default);
 };
 
+DAG<void>::DAG(Allocator* allocator /* = Allocator::Default */)
+    : DAGBase<void>(allocator) {}
+
 void DAG<void>::run(Allocator* allocator /* = Allocator::Default */) {
   typename DAGBase<void>::RunContext ctx{};
   this->initCounters(&ctx, allocator);
@@ -19,6 +19,7 @@
 #include "containers.h"
 #include "export.h"
 #include "memory.h"
+#include "waiter.h"
 
 #include <chrono>
 
@@ -102,6 +103,29 @@ class Event {
   MARL_NO_EXPORT inline static Event any(const Iterator& begin,
                                          const Iterator& end);
 
+ private:
+  struct Shared;
+
+ public:
+  // SignalCase is the select() case of an Event. See onSignal().
+  class SignalCase : public Selectable {
+   public:
+    MARL_NO_EXPORT inline SignalCase(Shared* shared);
+    MARL_NO_EXPORT inline bool tryComplete() override;
+    MARL_NO_EXPORT inline void add(WaitList::Node& node,
+                                   Waiter& waiter) override;
+    MARL_NO_EXPORT inline bool remove(WaitList::Node& node) override;
+    MARL_NO_EXPORT inline void notifyNext() override;
+
+   private:
+    Shared* const shared;
+  };
+
+  // onSignal() returns a select() case that completes when the event is
+  // signalled, as test() would return true. The case must not outlive the
+  // event.
+  MARL_NO_EXPORT inline SignalCase onSignal() const;
+
  private:
   struct Shared {
     MARL_NO_EXPORT inline Shared(Allocator* allocator,
@@ -118,8 +142,9 @@ class Event {
     MARL_NO_EXPORT inline bool wait_until(
         const std::chrono::time_point<Clock, Duration>& timeout);
 
-    marl::mutex mutex;
+    marl::mutex mutex{"marl::Event"};
     ConditionVariable cv;
+    WaitList waiters;  // guarded by mutex
     containers::vector<std::shared_ptr<Shared>, 1> deps;
     const Mode mode;
     bool signalled;
@@ -129,7 +154,10 @@ class Event {
 };
 
 Event::Shared::Shared(Allocator* allocator, Mode mode_, bool initialState)
-    : cv(allocator), mode(mode_), signalled(initialState) {}
+    : cv(allocator, "marl::Event"),
+      deps(allocator),
+      mode(mode_),
+      signalled(initialState) {}
 
 void Event::Shared::signal() {
   marl::lock lock(mutex);
@@ -139,8 +167,10 @@ void Event::Shared::signal() {
   signalled = true;
   if (mode == Mode::Auto) {
     cv.notify_one();
+    waiters.notify(1);
   } else {
     cv.notify_all();
+    waiters.notifyAll();
   }
   for (auto dep : deps) {
     dep->signal();
@@ -226,6 +256,41 @@ bool Event::isSignalled() const {
   return shared->signalled;
 }
 
+Event::SignalCase Event::onSignal() const {
+  return SignalCase(shared.get());
+}
+
+Event::SignalCase::SignalCase(Shared* shared) : shared(shared) {}
+
+bool Event::SignalCase::tryComplete() {
+  marl::lock lock(shared->mutex);
+  if (!shared->signalled) {
+    return false;
+  }
+  if (shared->mode == Mode::Auto) {
+    shared->signalled = false;
+  }
+  return true;
+}
+
+void Event::SignalCase::add(WaitList::Node& node, Waiter& waiter) {
+  marl::lock lock(shared->mutex);
+  shared->waiters.add(node, waiter);
+}
+
+bool Event::SignalCase::remove(WaitList::Node& node) {
+  marl::lock lock(shared->mutex);
+  return shared->waiters.remove(node);
+}
+
+void Event::SignalCase::notifyNext() {
+  marl::lock lock(shared->mutex);
+  if (shared->signalled && shared->mode == Mode::Auto) {
+    shared->cv.notify_one();
+    shared->waiters.notify(1);
+  }
+}
+
 template <typename Iterator>
 Event Event::any(Mode mode, const Iterator& begin, const Iterator& end) {
   Event any(mode, false);
@@ -0,0 +1,822 @@
+// Copyright 2026 The Marl Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef marl_future_h
+#define marl_future_h
+
+#include "containers.h"
+#include "debug.h"
+#include "memory.h"
+#include "mutex.h"
+#include "scheduler.h"
+#include "task.h"
+#include "waiter.h"
+
+#include <atomic>
+#include <chrono>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+namespace marl {
+
+template <typename T>
+class Future;
+
+template <typename T>
+class Promise;
+
+namespace detail {
+
+struct FutureAccess;
+
+// FutureStateBase is the part of the state shared by a Promise and its
+// Futures that does not depend on the type of the value.
+//
+// The state is a single allocation, reference counted by the Promises,
+// Futures and pending continuations that use it. The Promises are also
+// counted separately: once the last Promise is destructed without setting the
+// value, the pending continuations can never run, so they are destructed,
+// releasing the references they hold.
+class FutureStateBase {
+ public:
+  MARL_NO_EXPORT inline FutureStateBase(Allocator* allocator);
+  virtual ~FutureStateBase() = default;
+
+  // acquire() adds a reference to the state.
+  MARL_NO_EXPORT inline void acquire();
+
+  // release() removes a reference to the state, destructing and freeing the
+  // state when the last reference is removed.
+  MARL_NO_EXPORT inline void release();
+
+  // acquirePromise() and releasePromise() add and remove a Promise of the
+  // state. When the last Promise is removed without setting the value, the
+  // pending continuations are destructed without being run.
+  MARL_NO_EXPORT inline void acquirePromise();
+  MARL_NO_EXPORT inline void releasePromise();
+
+  // ready() returns true if the value has been set.
+  MARL_NO_EXPORT inline bool ready() const;
+
+  // wait() blocks until the value has been set.
+  MARL_NO_EXPORT inline void wait();
+
+  // wait_until() blocks until the value has been set, or the timeout has been
+  // reached. Returns true if the value has been set.
+  template <typename Clock, typename Duration>
+  MARL_NO_EXPORT inline bool wait_until(
+      const std::chrono::time_point<Clock, Duration>& timeout);
+
+  // then() runs task once the value has been set. If scheduler is not null,
+  // task is enqueued on scheduler, otherwise task is called on the thread
+  // that sets the value. If the value has already been set, task is run
+  // immediately. If the value can no longer be set, task is discarded.
+  MARL_NO_EXPORT inline void then(Scheduler* scheduler, Task&& task);
+
+  // add() and remove() add and remove a waiter for the value, for select().
+  MARL_NO_EXPORT inline void add(WaitList::Node& node, Waiter& waiter);
+  MARL_NO_EXPORT inline bool remove(WaitList::Node& node);
+
+  Allocator* const allocator;
+
+ protected:
+  // destroy() destructs and frees the state.
+  virtual void destroy() = 0;
+
+  // setReady() marks the value as set, wakes the waiters, and runs the
+  // continuations. The value must have been constructed.
+  MARL_NO_EXPORT inline void setReady();
+
+ private:
+  // Continuation is a task to run once the value has been set.
+  struct Continuation {
+    Scheduler* scheduler;
+    Task task;
+  };
+
+  // run() enqueues or calls the task of continuation.
+  MARL_NO_EXPORT static inline void run(Continuation& continuation);
+
+  std::atomic<uint32_t> refs = {1};
+  std::atomic<uint32_t> promises = {1};
+  std::atomic<bool> isReady = {false};
+  marl::mutex mutex{"marl::Future"};
+  WaitList waiters;                                    // guarded by mutex
+  containers::vector<Continuation, 1> continuations;  // guarded by mutex
+};
+
+FutureStateBase::FutureStateBase(Allocator* allocator)
+    : allocator(allocator), continuations(allocator) {}
+
+void FutureStateBase::acquire() {
+  refs.fetch_add(1, std::memory_order_relaxed);
+}
+
+void FutureStateBase::release() {
+  if (refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    destroy();
+  }
+}
+
+void FutureStateBase::acquirePromise() {
+  promises.fetch_add(1, std::memory_order_relaxed);
+}
+
+void FutureStateBase::releasePromise() {
+  if (promises.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+    return;
+  }
+  // Destruct the continuations outside of the lock, as they may release
+  // other states.
+  containers::vector<Continuation, 1> discarded(allocator);
+  {
+    marl::lock lock(mutex);
+    if (!ready()) {
+      discarded = std::move(continuations);
+    }
+  }
+}
+
+bool FutureStateBase::ready() const {
+  return isReady.load(std::memory_order_acquire);
+}
+
+void FutureStateBase::wait() {
+  if (ready()) {
+    return;
+  }
+  Waiter waiter(this, "marl::Future");
+  WaitList::Node node;
+  {
+    marl::lock lock(mutex);
+    if (ready()) {
+      return;
+    }
+    waiters.add(node, waiter);
+  }
+  waiter.wait();
+}
+
+template <typename Clock, typename Duration>
+bool FutureStateBase::wait_until(
+    const std::chrono::time_point<Clock, Duration>& timeout) {
+  if (ready()) {
+    return true;
+  }
+  Waiter waiter(this, "marl::Future");
+  WaitList::Node node;
+  {
+    marl::lock lock(mutex);
+    if (ready()) {
+      return true;
+    }
+    waiters.add(node, waiter);
+  }
+  if (!waiter.wait_until(timeout)) {
+    marl::lock lock(mutex);
+    waiters.remove(node);
+  }
+  return ready();
+}
+
+void FutureStateBase::then(Scheduler* scheduler, Task&& task) {
+  Continuation continuation{scheduler, std::move(task)};
+  {
+    marl::lock lock(mutex);
+    if (!ready()) {
+      if (promises.load(std::memory_order_acquire) > 0) {
+        continuations.push_back(std::move(continuation));
+      }
+      return;  // continuation is discarded if there are no Promises.
+    }
+  }
+  run(continuation);
+}
+
+void FutureStateBase::add(WaitList::Node& node, Waiter& waiter) {
+  marl::lock lock(mutex);
+  waiters.add(node, waiter);
+}
+
+bool FutureStateBase::remove(WaitList::Node& node) {
+  marl::lock lock(mutex);
+  return waiters.remove(node);
+}
+
+void FutureStateBase::setReady() {
+  containers::vector<Continuation, 1> toRun(allocator);
+  {
+    marl::lock lock(mutex);
+    MARL_ASSERT(!ready(), "Promise value set more than once");
+    isReady.store(true, std::memory_order_release);
+    waiters.notifyAll();
+    toRun = std::move(continuations);
+  }
+  for (size_t i = 0; i < toRun.size(); i++) {
+    run(toRun[i]);
+  }
+}
+
+void FutureStateBase::run(Continuation& continuation) {
+  if (continuation.scheduler != nullptr) {
+    continuation.scheduler->enqueue(std::move(continuation.task));
+  } else {
+    continuation.task();
+  }
+}
+
+// FutureVoid is the value of a Future<void>.
+struct FutureVoid {};
+
+// FutureTraits describes the value of a Future<T>.
+template <typename T>
+struct FutureTraits {
+  using Value = T;
+  using Get = const T&;
+
+  MARL_NO_EXPORT static inline const T& get(const Value& value) {
+    return value;
+  }
+
+  template <typename F>
+  MARL_NO_EXPORT static inline auto call(F& f, const Value& value)
+      -> decltype(f(value)) {
+    return f(value);
+  }
+};
+
+template <>
+struct FutureTraits<void> {
+  using Value = FutureVoid;
+  using Get = void;
+
+  MARL_NO_EXPORT static inline void get(const Value&) {}
+
+  template <typename F>
+  MARL_NO_EXPORT static inline auto call(F& f, const Value&) -> decltype(f()) {
+    return f();
+  }
+};
+
+// FutureResult is the type returned by a continuation F of a Future<T>.
+template <typename T, typename F>
+using FutureResult = decltype(FutureTraits<T>::call(
+    std::declval<F&>(),
+    std::declval<const typename FutureTraits<T>::Value&>()));
+
+// FutureState is the state shared by a Promise<T> and its Futures.
+template <typename T>
+class FutureState : public FutureStateBase {
+ public:
+  using Value = typename FutureTraits<T>::Value;
+
+  MARL_NO_EXPORT inline FutureState(Allocator* allocator);
+  MARL_NO_EXPORT inline ~FutureState() override;
+
+  // set() constructs the value from args, and wakes the waiters.
+  template <typename... Args>
+  MARL_NO_EXPORT inline void set(Args&&... args);
+
+  // value() returns the value, which must have been set.
+  MARL_NO_EXPORT inline const Value& value() const;
+
+ protected:
+  MARL_NO_EXPORT inline void destroy() override;
+
+ private:
+  typename aligned_storage<sizeof(Value), alignof(Value)>::type storage;
+};
+
+template <typename T>
+FutureState<T>::FutureState(Allocator* allocator)
+    : FutureStateBase(allocator) {}
+
+template <typename T>
+FutureState<T>::~FutureState() {
+  if (ready()) {
+    reinterpret_cast<Value*>(&storage)->~Value();
+  }
+}
+
+template <typename T>
+template <typename... Args>
+void FutureState<T>::set(Args&&... args) {
+  MARL_ASSERT(!ready(), "Promise value set more than once");
+  new (&storage) Value(std::forward<Args>(args)...);
+  setReady();
+}
+
+template <typename T>
+auto FutureState<T>::value() const -> const Value& {
+  MARL_ASSERT(ready(), "Future value has not been set");
+  return *reinterpret_cast<const Value*>(&storage);
+}
+
+template <typename T>
+void FutureState<T>::destroy() {
+  allocator->destroy(this);
+}
+
+// FutureRef is a counted reference to a FutureState.
+template <typename T>
+class FutureRef {
+ public:
+  MARL_NO_EXPORT inline FutureRef() = default;
+  MARL_NO_EXPORT inline explicit FutureRef(FutureState<T>* state);
+  MARL_NO_EXPORT inline FutureRef(const FutureRef& other);
+  MARL_NO_EXPORT inline FutureRef(FutureRef&& other);
+  MARL_NO_EXPORT inline ~FutureRef();
+  MARL_NO_EXPORT inline FutureRef& operator=(FutureRef other);
+
+  MARL_NO_EXPORT inline FutureState<T>* operator->() const { return state; }
+  MARL_NO_EXPORT inline FutureState<T>* get() const { return state; }
+
+ private:
+  FutureState<T>* state = nullptr;
+};
+
+template <typename T>
+FutureRef<T>::FutureRef(FutureState<T>* state) : state(state) {}
+
+template <typename T>
+FutureRef<T>::FutureRef(const FutureRef& other) : state(other.state) {
+  if (state != nullptr) {
+    state->acquire();
+  }
+}
+
+template <typename T>
+FutureRef<T>::FutureRef(FutureRef&& other) : state(other.state) {
+  other.state = nullptr;
+}
+
+template <typename T>
+FutureRef<T>::~FutureRef() {
+  if (state != nullptr) {
+    state->release();
+  }
+}
+
+template <typename T>
+FutureRef<T>& FutureRef<T>::operator=(FutureRef other) {
+  std::swap(state, other.state);
+  return *this;
+}
+
+// fulfill() sets the value of promise to the result of f().
+template <typename R, typename F>
+MARL_NO_EXPORT inline
+    typename std::enable_if<!std::is_void<R>::value, void>::type
+    fulfill(const Promise<R>& promise, F&& f) {
+  promise.set_value(f());
+}
+
+// fulfill() calls f(), and then sets the value of promise.
+template <typename R, typename F>
+MARL_NO_EXPORT inline
+    typename std::enable_if<std::is_void<R>::value, void>::type
+    fulfill(const Promise<R>& promise, F&& f) {
+  f();
+  promise.set_value();
+}
+
+}  // namespace detail
+
+// Future is a handle to a value that is set by a Promise, possibly on
+// another fiber or thread.
+//
+// Futures are copyable, and all the copies of a Future refer to the same
+// value. get() and wait() block the calling fiber until the value is set,
+// yielding the worker thread to other tasks. then() schedules a continuation
+// on completion without blocking.
+//
+// Example:
+//
+//   marl::Promise<int> promise;
+//   marl::Future<int> future = promise.get_future();
+//   marl::schedule([=] { promise.set_value(compute()); });
+//   auto doubled = future.then([](int value) { return value * 2; });
+//   printf("%d\n", doubled.get());
+template <typename T>
+class Future {
+ public:
+  // Constructs a Future without a value, for which valid() returns false.
+  MARL_NO_EXPORT inline Future() = default;
+
+  // valid() returns true if the Future was obtained from a Promise.
+  MARL_NO_EXPORT inline bool valid() const;
+
+  // ready() returns true if the value has been set.
+  MARL_NO_EXPORT inline bool ready() const;
+
+  // get() blocks until the value has been set, and returns it.
+  MARL_NO_EXPORT inline typename detail::FutureTraits<T>::Get get() const;
+
+  // wait() blocks until the value has been set.
+  MARL_NO_EXPORT inline void wait() const;
+
+  // wait_for() blocks until the value has been set, or the timeout has been
+  // reached. Returns true if the value has been set.
+  template <typename Rep, typename Period>
+  MARL_NO_EXPORT inline bool wait_for(
+      const std::chrono::duration<Rep, Period>& duration) const;
+
+  // wait_until() blocks until the value has been set, or the timeout has been
+  // reached. Returns true if the value has been set.
+  template <typename Clock, typename Duration>
+  MARL_NO_EXPORT inline bool wait_until(
+      const std::chrono::time_point<Clock, Duration>& timeout) const;
+
+  // then() returns a Future for the result of calling f with the value, as
+  // f(value), or f() for a Future<void>.
+  // Once the value has been set, f is called by a new task on the scheduler
+  // bound to the thread that called then(). If no scheduler is bound, f is
+  // called on the thread that sets the value. No fiber blocks waiting for the
+  // value.
+  template <typename F>
+  MARL_NO_EXPORT inline Future<detail::FutureResult<T, F>> then(F&& f) const;
+
+  // ReadyCase is the select() case of a Future. See onReady().
+  class ReadyCase : public Selectable {
+   public:
+    MARL_NO_EXPORT inline ReadyCase(detail::FutureStateBase* state);
+    MARL_NO_EXPORT inline bool tryComplete() override;
+    MARL_NO_EXPORT inline void add(WaitList::Node& node,
+                                   Waiter& waiter) override;
+    MARL_NO_EXPORT inline bool remove(WaitList::Node& node) override;
+    MARL_NO_EXPORT inline void notifyNext() override;
+
+   private:
+    detail::FutureStateBase* const state;
+  };
+
+  // onReady() returns a select() case that completes when the value has
+  // been set. The case must not outlive the Future.
+  MARL_NO_EXPORT inline ReadyCase onReady() const;
+
+ private:
+  friend class Promise<T>;
+  friend struct detail::FutureAccess;
+
+  MARL_NO_EXPORT inline Future(const detail::FutureRef<T>& state);
+
+  detail::FutureRef<T> state;
+};
+
+template <typename T>
+Future<T>::Future(const detail::FutureRef<T>& state) : state(state) {}
+
+template <typename T>
+bool Future<T>::valid() const {
+  return state.get() != nullptr;
+}
+
+template <typename T>
+bool Future<T>::ready() const {
+  MARL_ASSERT(valid(), "Future is not valid");
+  return state->ready();
+}
+
+template <typename T>
+typename detail::FutureTraits<T>::Get Future<T>::get() const {
+  wait();
+  return detail::FutureTraits<T>::get(state->value());
+}
+
+template <typename T>
+void Future<T>::wait() const {
+  MARL_ASSERT(valid(), "Future is not valid");
+  state->wait();
+}
+
+template <typename T>
+template <typename Rep, typename Period>
+bool Future<T>::wait_for(
+    const std::chrono::duration<Rep, Period>& duration) const {
+  return wait_until(std::chrono::system_clock::now() + duration);
+}
+
+template <typename T>
+template <typename Clock, typename Duration>
+bool Future<T>::wait_until(
+    const std::chrono::time_point<Clock, Duration>& timeout) const {
+  MARL_ASSERT(valid(), "Future is not valid");
+  return state->wait_until(timeout);
+}
+
+template <typename T>
+template <typename F>
+Future<detail::FutureResult<T, F>> Future<T>::then(F&& f) const {
+  MARL_ASSERT(valid(), "Future is not valid");
+  using R = detail::FutureResult<T, F>;
+  using Func = typename std::decay<F>::type;
+  Promise<R> promise(state->allocator);
+  auto future = promise.get_future();
+  auto self = state;
+  Func func(std::forward<F>(f));
+  state->then(Scheduler::get(), Task([self, promise, func]() mutable {
+                detail::fulfill(promise, [&] {
+                  return detail::FutureTraits<T>::call(func, self->value());
+                });
+              }));
+  return future;
+}
+
+template <typename T>
+typename Future<T>::ReadyCase Future<T>::onReady() const {
+  MARL_ASSERT(valid(), "Future is not valid");
+  return ReadyCase(state.get());
+}
+
+template <typename T>
+Future<T>::ReadyCase::ReadyCase(detail::FutureStateBase* state)
+    : state(state) {}
+
+template <typename T>
+bool Future<T>::ReadyCase::tryComplete() {
+  return state->ready();
+}
+
+template <typename T>
+void Future<T>::ReadyCase::add(WaitList::Node& node, Waiter& waiter) {
+  state->add(node, waiter);
+}
+
+template <typename T>
+bool Future<T>::ReadyCase::remove(WaitList::Node& node) {
+  return state->remove(node);
+}
+
+template <typename T>
+void Future<T>::ReadyCase::notifyNext() {
+  // Setting the value notifies all the waiters, so there is no next waiter
+  // to notify.
+}
+
+// Promise sets the value of its Futures.
+//
+// The value, the waiters and the continuations of a Promise and its Futures
+// are held in a single allocation, which is freed once the Promise, its
+// Futures and their pending continuations have all been destructed.
+//
+// Promises are copyable, and all the copies of a Promise refer to the same
+// value. The value must be set exactly once. Futures of a Promise that is
+// destructed without setting the value never become ready, and their
+// continuations are destructed without being called.
+template <typename T>
+class Promise {
+ public:
+  // Constructs a Promise that allocates its state from the allocator of the
+  // scheduler bound to the calling thread, or Allocator::Default if no
+  // scheduler is bound.
+  MARL_NO_EXPORT inline Promise();
+
+  // Constructs a Promise that allocates its state from allocator.
+  MARL_NO_EXPORT inline explicit Promise(Allocator* allocator);
+
+  MARL_NO_EXPORT inline Promise(const Promise& other);
+  MARL_NO_EXPORT inline Promise(Promise&& other) = default;
+  MARL_NO_EXPORT inline ~Promise();
+  MARL_NO_EXPORT inline Promise& operator=(Promise other);
+
+  // get_future() returns a Future for the value of the Promise.
+  MARL_NO_EXPORT inline Future<T> get_future() const;
+
+  // set_value() constructs the value from args, wakes all the fibers and
+  // threads waiting on its Futures, and schedules their continuations.
+  // set_value() of a Promise<void> takes no arguments.
+  template <typename... Args>
+  MARL_NO_EXPORT inline void set_value(Args&&... args) const;
+
+ private:
+  detail::FutureRef<T> state;
+};
+
+template <typename T>
+Promise<T>::Promise()
+    : Promise(Scheduler::get() != nullptr ? Scheduler::get()->config().allocator
+                                          : Allocator::Default) {}
+
+template <typename T>
+Promise<T>::Promise(Allocator* allocator)
+    : state(allocator->create<detail::FutureState<T>>(allocator)) {}
+
+template <typename T>
+Promise<T>::Promise(const Promise& other) : state(other.state) {
+  if (state.get() != nullptr) {
+    state->acquirePromise();
+  }
+}
+
+template <typename T>
+Promise<T>::~Promise() {
+  if (state.get() != nullptr) {
+    state->releasePromise();
+  }
+}
+
+template <typename T>
+Promise<T>& Promise<T>::operator=(Promise other) {
+  std::swap(state, other.state);
+  return *this;
+}
+
+template <typename T>
+Future<T> Promise<T>::get_future() const {
+  return Future<T>(state);
+}
+
+template <typename T>
+template <typename... Args>
+void Promise<T>::set_value(Args&&... args) const {
+  state->set(std::forward<Args>(args)...);
+}
+
+namespace detail {
+
+// FutureAccess provides the combinators with the state of a Future.
+struct FutureAccess {
+  template <typename T>
+  MARL_NO_EXPORT static inline FutureStateBase* state(const Future<T>& f) {
+    MARL_ASSERT(f.valid(), "Future is not valid");
+    return f.state.get();
+  }
+};
+
+// WhenAll holds the state of a when_all() call. It is shared by the
+// continuations of the futures, and is destructed with the last of them,
+// whether it ran or was discarded.
+struct WhenAll {
+  MARL_NO_EXPORT inline WhenAll(Allocator* allocator, size_t count);
+
+  // onReady() is called once for each future that becomes ready.
+  MARL_NO_EXPORT inline void onReady();
+
+  std::atomic<size_t> remaining;
+  const Promise<void> promise;
+};
+
+WhenAll::WhenAll(Allocator* allocator, size_t count)
+    : remaining(count), promise(allocator) {}
+
+void WhenAll::onReady() {
+  if (remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    promise.set_value();
+  }
+}
+
+// WhenAny holds the state of a when_any() call. It is shared by the
+// continuations of the futures, and is destructed with the last of them,
+// whether it ran or was discarded.
+struct WhenAny {
+  MARL_NO_EXPORT inline WhenAny(Allocator* allocator);
+
+  // onReady() is called once for each future that becomes ready, with the
+  // index of the future.
+  MARL_NO_EXPORT inline void onReady(size_t index);
+
+  std::atomic<bool> done = {false};
+  const Promise<size_t> promise;
+};
+
+WhenAny::WhenAny(Allocator* allocator) : promise(allocator) {}
+
+void WhenAny::onReady(size_t index) {
+  if (!done.exchange(true, std::memory_order_acq_rel)) {
+    promise.set_value(index);
+  }
+}
+
+// whenAll() implements when_all() for the states [begin, end).
+template <typename Iterator>
+MARL_NO_EXPORT inline Future<void> whenAll(Allocator* allocator,
+                                           size_t count,
+                                           Iterator begin,
+                                           Iterator end) {
+  if (count == 0) {
+    Promise<void> promise(allocator);
+    promise.set_value();
+    return promise.get_future();
+  }
+  auto all = allocator->make_shared<WhenAll>(allocator, count);
+  auto future = all->promise.get_future();
+  for (auto it = begin; it != end; ++it) {
+    (*it)->then(nullptr, Task([all] { all->onReady(); }));
+  }
+  return future;
+}
+
+// whenAny() implements when_any() for the states [begin, end).
+template <typename Iterator>
+MARL_NO_EXPORT inline Future<size_t> whenAny(Allocator* allocator,
+                                             size_t count,
+                                             Iterator begin,
+                                             Iterator end) {
+  MARL_ASSERT(count > 0, "when_any() requires at least one future");
+  auto any = allocator->make_shared<WhenAny>(allocator);
+  auto future = any->promise.get_future();
+  size_t index = 0;
+  for (auto it = begin; it != end; ++it, ++index) {
+    (*it)->then(nullptr, Task([any, index] { any->onReady(index); }));
+  }
+  return future;
+}
+
+// IsFuture is derived from std::true_type if T is a Future.
+template <typename T>
+struct IsFuture : std::false_type {};
+
+template <typename T>
+struct IsFuture<Future<T>> : std::true_type {};
+
+// FutureStateIterator adapts an iterator of Futures to an iterator of their
+// states.
+template <typename Iterator>
+struct FutureStateIterator {
+  MARL_NO_EXPORT inline FutureStateBase* operator*() const {
+    return FutureAccess::state(*it);
+  }
+  MARL_NO_EXPORT inline FutureStateIterator& operator++() {
+    ++it;
+    return *this;
+  }
+  MARL_NO_EXPORT inline bool operator!=(const FutureStateIterator& o) const {
+    return it != o.it;
+  }
+  Iterator it;
+};
+
+}  // namespace detail
+
+// when_all() returns a Future that becomes ready once all the Futures in
+// [begin, end) are ready. The values are read from the Futures themselves.
+// If the range is empty, the returned Future is already ready.
+//
+// No fiber blocks waiting for the Futures. The combinator state is allocated
+// from the allocator of the first Future, and is freed once each of the
+// Futures is ready or can no longer become ready.
+template <typename Iterator>
+MARL_NO_EXPORT inline typename std::enable_if<
+    !detail::IsFuture<Iterator>::value,
+    Future<void>>::type
+when_all(Iterator begin, Iterator end) {
+  using States = detail::FutureStateIterator<Iterator>;
+  auto count = static_cast<size_t>(std::distance(begin, end));
+  auto allocator = count > 0 ? (*States{begin})->allocator
+                             : Allocator::Default;
+  return detail::whenAll(allocator, count, States{begin}, States{end});
+}
+
+// when_all() returns a Future that becomes ready once all of futures are
+// ready. See when_all() above.
+template <typename... Ts>
+MARL_NO_EXPORT inline Future<void> when_all(const Future<Ts>&... futures) {
+  detail::FutureStateBase* states[] = {detail::FutureAccess::state(futures)...};
+  return detail::whenAll(states[0]->allocator, sizeof...(Ts), states,
+                         states + sizeof...(Ts));
+}
+
+// when_any() returns a Future that becomes ready with the index in
+// [begin, end) of the first of the Futures to become ready. The range must
+// not be empty.
+//
+// No fiber blocks waiting for the Futures. The combinator state is allocated
+// from the allocator of the first Future, and is freed once each of the
+// Futures is ready or can no longer become ready.
+template <typename Iterator>
+MARL_NO_EXPORT inline typename std::enable_if<
+    !detail::IsFuture<Iterator>::value,
+    Future<size_t>>::type
+when_any(Iterator begin, Iterator end) {
+  using States = detail::FutureStateIterator<Iterator>;
+  auto count = static_cast<size_t>(std::distance(begin, end));
+  MARL_ASSERT(count > 0, "when_any() requires at least one future");
+  return detail::whenAny((*States{begin})->allocator, count, States{begin},
+                         States{end});
+}
+
+// when_any() returns a Future that becomes ready with the index of the first
+// of futures to become ready. See when_any() above.
+template <typename... Ts>
+MARL_NO_EXPORT inline Future<size_t> when_any(const Future<Ts>&... futures) {
+  detail::FutureStateBase* states[] = {detail::FutureAccess::state(futures)...};
+  return detail::whenAny(states[0]->allocator, sizeof...(Ts), states,
+                         states + sizeof...(Ts));
+}
+
+}  // namespace marl
+
+#endif  // marl_future_h
@@ -234,14 +234,29 @@ std::shared_ptr<T> Allocator::make_shared(ARGS&&... args) {
 ///////////////////////////////////////////////////////////////////////////////
 
 // TrackedAllocator wraps an Allocator to track the allocations made.
+//
+// Each thread accumulates statistics in its own shard of counters, which is
+// registered with the allocator on the thread's first allocation or free, and
+// merged with the other shards by stats(). allocate() and free() take no lock
+// and do not write to memory shared with other threads, except to publish
+// peak usage once every PeakGranularity bytes.
 class TrackedAllocator : public Allocator {
  public:
+  // Number of buckets in the allocation size histogram.
+  // Bucket i counts allocations with a size in the range (2^(i-1), 2^i].
+  // The last bucket also counts all larger allocations.
+  static constexpr size_t NumSizeBuckets = 32;
+
   struct UsageStats {
     // Total number of allocations.
     size_t count = 0;
     // total allocation size in bytes (as requested, may be higher due to
     // alignment or guards).
     size_t bytes = 0;
+    // The highest value of bytes observed. As threads publish their
+    // allocations in batches, this may be an underestimate by up to
+    // PeakGranularity bytes per thread.
+    size_t peakBytes = 0;
   };
 
   struct Stats {
@@ -255,22 +270,69 @@ class TrackedAllocator : public Allocator {
 
     // Statistics per usage.
     std::array<UsageStats, size_t(Allocation::Usage::Count)> byUsage;
+
+    // The number of allocations made since construction, bucketed by size.
+    std::array<size_t, NumSizeBuckets> sizeHistogram = {};
+  };
+
+  // CallSite holds the number of sampled allocations made by a single caller
+  // of allocate().
+  struct CallSite {
+    void* address = nullptr;  // Return address of the call to allocate().
+    size_t samples = 0;       // Number of sampled allocations.
+  };
+
+  struct Config {
+    // If non-zero, then the call site of one in every callSiteSampleRate
+    // allocations (per thread) is recorded, and can be queried with
+    // callSites().
+    uint32_t callSiteSampleRate = 0;
   };
 
   // Constructor that wraps an existing allocator.
-  inline TrackedAllocator(Allocator* allocator);
+  MARL_EXPORT TrackedAllocator(Allocator* allocator);
+
+  // Constructor that wraps an existing allocator, using the given config.
+  MARL_EXPORT TrackedAllocator(Allocator* allocator, const Config& config);
+
+  MARL_EXPORT ~TrackedAllocator();
 
   // stats() returns the current allocator statistics.
-  inline Stats stats();
+  MARL_EXPORT Stats stats();
+
+  // callSites() writes up to count of the sampled allocation call sites to
+  // out, ordered from most to fewest samples, and returns the number written.
+  // Returns 0 if call site sampling is disabled.
+  MARL_EXPORT size_t callSites(CallSite* out, size_t count);
 
   // Allocator compliance
-  inline Allocation allocate(const Allocation::Request&) override;
-  inline void free(const Allocation&) override;
+  MARL_EXPORT Allocation allocate(const Allocation::Request&) override;
+  MARL_EXPORT void free(const Allocation&) override;
+
+  // Number of bytes a thread accumulates before publishing them for peak
+  // tracking.
+  static constexpr int64_t PeakGranularity = 4096;
+
+  // Maximum number of call sites recorded by call site sampling.
+  static constexpr size_t MaxCallSites = 1024;
 
  private:
+  TrackedAllocator(const TrackedAllocator&) = delete;
+  TrackedAllocator& operator=(const TrackedAllocator&) = delete;
+
+  struct Shard;
+  struct Shared;
+
+  // shard() returns the shard of the calling thread, registering a new shard
+  // if the thread has none.
+  Shard& shard();
+
   Allocator* const allocator;
+  const Config config;
+  const uint64_t id;  // Unique for the lifetime of the process.
   std::mutex mutex;
-  Stats stats_;
+  Shard* shards = nullptr;  // guarded by mutex
+  Shared* const shared;
 };
 
 size_t TrackedAllocator::Stats::numAllocations() const {
@@ -289,38 +351,6 @@ size_t TrackedAllocator::Stats::bytesAllocated() const {
   return out;
 }
 
-TrackedAllocator::TrackedAllocator(Allocator* allocator_)
-    : allocator(allocator_) {}
-
-TrackedAllocator::Stats TrackedAllocator::stats() {
-  std::unique_lock<std::mutex> lock(mutex);
-  return stats_;
-}
-
-Allocation TrackedAllocator::allocate(const Allocation::Request& request) {
-  {
-    std::unique_lock<std::mutex> lock(mutex);
-    auto& usageStats = stats_.byUsage[int(request.usage)];
-    ++usageStats.count;
-    usageStats.bytes += request.size;
-  }
-  return allocator->allocate(request);
-}
-
-void TrackedAllocator::free(const Allocation& allocation) {
-  {
-    std::unique_lock<std::mutex> lock(mutex);
-    auto& usageStats = stats_.byUsage[int(allocation.request.usage)];
-    MARL_ASSERT(usageStats.count > 0,
-                "TrackedAllocator detected abnormal free()");
-    MARL_ASSERT(usageStats.bytes >= allocation.request.size,
-                "TrackedAllocator detected abnormal free()");
-    --usageStats.count;
-    usageStats.bytes -= allocation.request.size;
-  }
-  return allocator->free(allocation);
-}
-
 ///////////////////////////////////////////////////////////////////////////////
 // StlAllocator
 ///////////////////////////////////////////////////////////////////////////////
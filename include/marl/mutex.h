@@ -22,17 +22,74 @@
 #include "export.h"
 #include "tsa.h"
 
+#include <stdint.h>
+
+#include <chrono>
 #include <condition_variable>
 #include <mutex>
+#include <vector>
+
+// Define MARL_MUTEX_STATS_ENABLED to 1 to instrument marl::mutex with lock
+// statistics. See marl::mutexStats().
+#ifndef MARL_MUTEX_STATS_ENABLED
+#define MARL_MUTEX_STATS_ENABLED 0
+#endif
 
 namespace marl {
 
+// MutexStats holds the lock statistics of all the marl::mutexes constructed
+// with the same name.
+struct MutexStats {
+  // The name of the mutexes, or "<unnamed>" for mutexes without a name.
+  const char* name = nullptr;
+
+  // The number of times the mutexes were locked.
+  uint64_t acquisitions = 0;
+
+  // The number of acquisitions that had to wait for the mutex to be unlocked.
+  uint64_t contended = 0;
+
+  // The total time spent waiting to lock the mutexes.
+  std::chrono::nanoseconds waitTime = std::chrono::nanoseconds(0);
+
+  // The total time the mutexes were held, excluding time spent in condition
+  // variable waits.
+  std::chrono::nanoseconds holdTime = std::chrono::nanoseconds(0);
+};
+
+// mutexStats() returns the lock statistics of each name of marl::mutex,
+// accumulated since the start of the process or the last call to
+// resetMutexStats().
+// Returns an empty vector unless marl is built with MARL_MUTEX_STATS_ENABLED
+// defined to 1 (the MARL_MUTEX_STATS CMake option).
+MARL_EXPORT std::vector<MutexStats> mutexStats();
+
+// resetMutexStats() resets all the lock statistics to zero.
+MARL_EXPORT void resetMutexStats();
+
 // mutex is a wrapper around std::mutex that offers Thread Safety Analysis
 // annotations.
 // mutex also holds methods for performing std::condition_variable::wait() calls
 // as these require a std::unique_lock<> which are unsupported by the TSA.
+// If MARL_MUTEX_STATS_ENABLED is 1, mutex also records lock statistics,
+// aggregated by the name passed to the constructor.
 class CAPABILITY("mutex") mutex {
  public:
+  MARL_NO_EXPORT inline mutex();
+
+  // Constructs the mutex with the given name, which is used to aggregate lock
+  // statistics. name must outlive all uses of mutexStats().
+  MARL_NO_EXPORT inline explicit mutex(const char* name);
+
+#if MARL_MUTEX_STATS_ENABLED
+  MARL_NO_EXPORT inline void lock() ACQUIRE() { acquire(); }
+
+  MARL_NO_EXPORT inline void unlock() RELEASE() { release(); }
+
+  MARL_NO_EXPORT inline bool try_lock() TRY_ACQUIRE(true) {
+    return tryAcquire();
+  }
+#else
   MARL_NO_EXPORT inline void lock() ACQUIRE() { _.lock(); }
 
   MARL_NO_EXPORT inline void unlock() RELEASE() { _.unlock(); }
@@ -40,14 +97,17 @@ class CAPABILITY("mutex") mutex {
   MARL_NO_EXPORT inline bool try_lock() TRY_ACQUIRE(true) {
     return _.try_lock();
   }
+#endif
 
   // wait_locked calls cv.wait() on this already locked mutex.
   template <typename Predicate>
   MARL_NO_EXPORT inline void wait_locked(std::condition_variable& cv,
                                          Predicate&& p) REQUIRES(this) {
+    endHold();
     std::unique_lock<std::mutex> lock(_, std::adopt_lock);
     cv.wait(lock, std::forward<Predicate>(p));
     lock.release();  // Keep lock held.
+    beginHold();
   }
 
   // wait_until_locked calls cv.wait() on this already locked mutex.
@@ -55,15 +115,51 @@ class CAPABILITY("mutex") mutex {
   MARL_NO_EXPORT inline bool wait_until_locked(std::condition_variable& cv,
                                                Time&& time,
                                                Predicate&& p) REQUIRES(this) {
+    endHold();
     std::unique_lock<std::mutex> lock(_, std::adopt_lock);
     auto res = cv.wait_until(lock, std::forward<Time>(time),
                              std::forward<Predicate>(p));
     lock.release();  // Keep lock held.
+    beginHold();
     return res;
   }
 
  private:
   friend class lock;
+
+#if MARL_MUTEX_STATS_ENABLED
+  friend std::vector<MutexStats> mutexStats();
+  friend void resetMutexStats();
+
+  struct Stats;
+  struct Registry;
+
+  // getStats() returns the statistics for mutexes of the given name.
+  MARL_EXPORT static Stats* getStats(const char* name);
+  // acquire() locks the mutex, records the acquisition and returns _.
+  MARL_EXPORT std::mutex& acquire();
+  // tryAcquire() attempts to lock the mutex, recording the acquisition if
+  // successful.
+  MARL_EXPORT bool tryAcquire();
+  // release() records the time the mutex was held and unlocks the mutex.
+  MARL_EXPORT void release();
+  // beginHold() and endHold() record the start and end of a period that the
+  // mutex is held.
+  MARL_EXPORT void beginHold();
+  MARL_EXPORT void endHold();
+
+  Stats* const stats;
+  uint64_t heldSince = 0;  // CycleClock ticks. Guarded by the mutex.
+#else
+  MARL_NO_EXPORT inline std::mutex& acquire() {
+    _.lock();
+    return _;
+  }
+  MARL_NO_EXPORT inline void release() { _.unlock(); }
+  MARL_NO_EXPORT inline void beginHold() {}
+  MARL_NO_EXPORT inline void endHold() {}
+#endif
+
   std::mutex _;
 };
 
@@ -72,13 +168,29 @@ class CAPABILITY("mutex") mutex {
 // calls as these require a std::unique_lock<> which are unsupported by the TSA.
 class SCOPED_CAPABILITY lock {
  public:
+#if MARL_MUTEX_STATS_ENABLED
+  inline lock(mutex& m) ACQUIRE(m) : m(m), _(m.acquire(), std::adopt_lock) {}
+  inline ~lock() RELEASE() {
+    if (_.owns_lock()) {
+      _.release();
+      m.release();
+    }
+  }
+#else
   inline lock(mutex& m) ACQUIRE(m) : _(m._) {}
   inline ~lock() RELEASE() = default;
+#endif
 
   // wait calls cv.wait() on this lock.
   template <typename Predicate>
   inline void wait(std::condition_variable& cv, Predicate&& p) {
+#if MARL_MUTEX_STATS_ENABLED
+    m.endHold();
+    cv.wait(_, std::forward<Predicate>(p));
+    m.beginHold();
+#else
     cv.wait(_, std::forward<Predicate>(p));
+#endif
   }
 
   // wait_until calls cv.wait() on this lock.
@@ -86,24 +198,58 @@ class SCOPED_CAPABILITY lock {
   inline bool wait_until(std::condition_variable& cv,
                          Time&& time,
                          Predicate&& p) {
+#if MARL_MUTEX_STATS_ENABLED
+    m.endHold();
+    auto res = cv.wait_until(_, std::forward<Time>(time),
+                             std::forward<Predicate>(p));
+    m.beginHold();
+    return res;
+#else
     return cv.wait_until(_, std::forward<Time>(time),
                          std::forward<Predicate>(p));
+#endif
   }
 
   inline bool owns_lock() const { return _.owns_lock(); }
 
   // lock_no_tsa locks the mutex outside of the visiblity of the thread
   // safety analysis. Use with caution.
-  inline void lock_no_tsa() { _.lock(); }
+  inline void lock_no_tsa() {
+#if MARL_MUTEX_STATS_ENABLED
+    _ = std::unique_lock<std::mutex>(m.acquire(), std::adopt_lock);
+#else
+    _.lock();
+#endif
+  }
 
   // unlock_no_tsa unlocks the mutex outside of the visiblity of the thread
   // safety analysis. Use with caution.
-  inline void unlock_no_tsa() { _.unlock(); }
+  inline void unlock_no_tsa() {
+#if MARL_MUTEX_STATS_ENABLED
+    _.release();
+    m.release();
+#else
+    _.unlock();
+#endif
+  }
 
  private:
+#if MARL_MUTEX_STATS_ENABLED
+  mutex& m;
+#endif
   std::unique_lock<std::mutex> _;
 };
 
+#if MARL_MUTEX_STATS_ENABLED
+mutex::mutex() : mutex(nullptr) {}
+
+mutex::mutex(const char* name) : stats(getStats(name)) {}
+#else
+mutex::mutex() = default;
+
+mutex::mutex(const char*) {}
+#endif
+
 }  // namespace marl
 
 #endif  // marl_mutex_h
@@ -0,0 +1,177 @@
+// Copyright 2026 The Marl Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef marl_parallel_find_h
+#define marl_parallel_find_h
+
+#include "debug.h"
+#include "parallelfor.h"
+#include "scheduler.h"
+
+#include <atomic>
+#include <type_traits>
+
+namespace marl {
+
+namespace detail {
+
+// ParallelFind is the chunk function of parallel_find_if() and
+// parallel_any_of(). It records the offset of the lowest matching index found
+// so far, and stops the loop from running chunks that cannot hold a lower
+// match.
+template <typename Index, typename Predicate>
+class ParallelFind {
+ public:
+  // If anyMatch is true, the loop is stopped as soon as any match is found,
+  // otherwise only chunks above the lowest match found are skipped.
+  MARL_NO_EXPORT inline ParallelFind(Index begin,
+                                     Index end,
+                                     Predicate& pred,
+                                     bool anyMatch);
+
+  // stopped() returns true if the chunks starting at chunkBegin or above
+  // cannot hold a match that is needed, so the loop neither splits nor runs
+  // them.
+  MARL_NO_EXPORT inline bool stopped(Index chunkBegin) const;
+
+  // operator() calls pred for each index of the chunk [chunkBegin, chunkEnd)
+  // until a match is found. Returns false if the loop should not call
+  // operator() for higher chunks.
+  MARL_NO_EXPORT inline bool operator()(Index chunkBegin, Index chunkEnd);
+
+  // result() returns the lowest matching index found, or end if there is no
+  // match.
+  MARL_NO_EXPORT inline Index result() const;
+
+ private:
+  // offset() returns the offset of the index from begin.
+  MARL_NO_EXPORT inline size_t offset(Index i) const;
+
+  const Index begin;
+  const Index end;
+  Predicate& pred;
+  const bool anyMatch;
+  const size_t count;
+  // The offset of the lowest match found so far, or count if none.
+  std::atomic<size_t> found;
+};
+
+template <typename Index, typename Predicate>
+ParallelFind<Index, Predicate>::ParallelFind(Index begin,
+                                             Index end,
+                                             Predicate& pred,
+                                             bool anyMatch)
+    : begin(begin),
+      end(end),
+      pred(pred),
+      anyMatch(anyMatch),
+      count(offset(end)),
+      found(count) {}
+
+template <typename Index, typename Predicate>
+bool ParallelFind<Index, Predicate>::stopped(Index chunkBegin) const {
+  auto lowest = found.load(std::memory_order_relaxed);
+  return anyMatch ? lowest != count : offset(chunkBegin) >= lowest;
+}
+
+template <typename Index, typename Predicate>
+bool ParallelFind<Index, Predicate>::operator()(Index chunkBegin,
+                                                Index chunkEnd) {
+  if (stopped(chunkBegin)) {
+    return false;
+  }
+  auto lowest = found.load(std::memory_order_relaxed);
+  for (Index i = chunkBegin; i < chunkEnd; ++i) {
+    if (pred(i)) {
+      auto match = offset(i);
+      while (match < lowest && !found.compare_exchange_weak(
+                                   lowest, match, std::memory_order_relaxed)) {
+      }
+      return false;
+    }
+  }
+  return true;
+}
+
+template <typename Index, typename Predicate>
+Index ParallelFind<Index, Predicate>::result() const {
+  auto lowest = found.load(std::memory_order_relaxed);
+  return lowest == count ? end : static_cast<Index>(begin + lowest);
+}
+
+template <typename Index, typename Predicate>
+size_t ParallelFind<Index, Predicate>::offset(Index i) const {
+  return static_cast<size_t>(i - begin);
+}
+
+}  // namespace detail
+
+// parallel_find_if() returns the lowest index i in [begin, end) for which
+// pred(i) returns true, or end if there is no such index. pred may be called
+// concurrently.
+//
+// The range is divided into chunks of at most grain indices, as by
+// parallel_for(). Once a match has been found, chunks above it are neither
+// split nor started: the tasks running the range check for a match before
+// each split and chunk.
+// Chunks below the lowest match found so far still run to completion, so the
+// lowest match is always returned. pred may be called for indices above the
+// returned index.
+//
+// parallel_find_if() must be called on a thread with a bound scheduler.
+template <typename Index, typename Predicate>
+MARL_NO_EXPORT inline Index parallel_find_if(Index begin,
+                                             Index end,
+                                             size_t grain,
+                                             Predicate&& pred) {
+  MARL_ASSERT_HAS_BOUND_SCHEDULER("marl::parallel_find_if");
+  MARL_ASSERT(grain > 0, "parallel_find_if() grain must be greater than 0");
+  if (!(begin < end)) {
+    return end;
+  }
+  detail::ParallelFind<Index, typename std::remove_reference<Predicate>::type>
+      find(begin, end, pred, false);
+  detail::parallelChunks(begin, end, grain, find);
+  return find.result();
+}
+
+// parallel_any_of() returns true if pred(i) returns true for any index i in
+// [begin, end). pred may be called concurrently.
+//
+// The range is divided into chunks of at most grain indices, as by
+// parallel_for(). Once any match has been found, no more chunks are split or
+// started: the tasks running the range check for a match before each split
+// and chunk.
+//
+// parallel_any_of() must be called on a thread with a bound scheduler.
+template <typename Index, typename Predicate>
+MARL_NO_EXPORT inline bool parallel_any_of(Index begin,
+                                           Index end,
+                                           size_t grain,
+                                           Predicate&& pred) {
+  MARL_ASSERT_HAS_BOUND_SCHEDULER("marl::parallel_any_of");
+  MARL_ASSERT(grain > 0, "parallel_any_of() grain must be greater than 0");
+  if (!(begin < end)) {
+    return false;
+  }
+  detail::ParallelFind<Index, typename std::remove_reference<Predicate>::type>
+      find(begin, end, pred, true);
+  detail::parallelChunks(begin, end, grain, find);
+  return find.result() != end;
+}
+
+}  // namespace marl
+
+#endif  // marl_parallel_find_h
@@ -0,0 +1,353 @@
+// Copyright 2026 The Marl Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef marl_parallel_for_h
+#define marl_parallel_for_h
+
+#include "containers.h"
+#include "debug.h"
+#include "scheduler.h"
+#include "waitgroup.h"
+
+#include <algorithm>
+#include <atomic>
+#include <type_traits>
+
+namespace marl {
+
+namespace detail {
+
+template <typename Index, typename F>
+class AffinityParallelFor;
+
+// callChunk() calls f(begin, end), and returns true as f returns void.
+template <typename F, typename Index>
+MARL_NO_EXPORT inline auto callChunk(F& f, Index begin, Index end) ->
+    typename std::enable_if<std::is_void<decltype(f(begin, end))>::value,
+                            bool>::type {
+  f(begin, end);
+  return true;
+}
+
+// callChunk() calls f(begin, end), and returns its result.
+template <typename F, typename Index>
+MARL_NO_EXPORT inline auto callChunk(F& f, Index begin, Index end) ->
+    typename std::enable_if<!std::is_void<decltype(f(begin, end))>::value,
+                            bool>::type {
+  return f(begin, end);
+}
+
+// isStopped() returns f.stopped(begin), which returns true if f does not
+// need to be called for the chunks starting at begin or above.
+template <typename F, typename Index>
+MARL_NO_EXPORT inline auto isStopped(F& f, Index begin, int)
+    -> decltype(bool(f.stopped(begin))) {
+  return f.stopped(begin);
+}
+
+// isStopped() returns false as F has no stopped() method.
+template <typename F, typename Index>
+MARL_NO_EXPORT inline bool isStopped(F&, Index, long) {
+  return false;
+}
+
+// ParallelFor holds the state shared by the calling thread and all the tasks
+// of a single parallel_for() call.
+template <typename Index, typename F>
+class ParallelFor {
+ public:
+  MARL_NO_EXPORT inline ParallelFor(size_t grain, F& f, uint32_t maxPending);
+
+  // run() calls f(chunkBegin, chunkEnd) for chunks of at most grain indices
+  // that cover [begin, end). Before each chunk, run() splits off the upper
+  // half of the remaining range into a new task while fewer than maxPending
+  // split tasks are waiting to start. If f returns a bool, returning false
+  // stops run() from calling f for the rest of the range it holds. If f has a
+  // stopped(begin) method, it is checked before each chunk and split, and
+  // returning true stops run() from calling f or splitting the rest of the
+  // range it holds.
+  MARL_NO_EXPORT inline void run(Index begin, Index end);
+
+  // wait() blocks until all the split tasks have completed.
+  MARL_NO_EXPORT inline void wait();
+
+ private:
+  // spawn() schedules a task to run() the range [begin, end).
+  MARL_NO_EXPORT inline void spawn(Index begin, Index end);
+
+  const size_t grain;
+  F& f;
+  const uint32_t maxPending;
+  std::atomic<uint32_t> pending = {0};  // Split tasks not yet started.
+  WaitGroup wg;
+};
+
+template <typename Index, typename F>
+ParallelFor<Index, F>::ParallelFor(size_t grain, F& f, uint32_t maxPending)
+    : grain(grain), f(f), maxPending(maxPending) {}
+
+template <typename Index, typename F>
+void ParallelFor<Index, F>::run(Index begin, Index end) {
+  while (begin < end) {
+    if (isStopped(f, begin, 0)) {
+      return;
+    }
+    while (static_cast<size_t>(end - begin) > grain &&
+           pending.load(std::memory_order_relaxed) < maxPending) {
+      Index mid = static_cast<Index>(begin + (end - begin) / 2);
+      spawn(mid, end);
+      end = mid;
+    }
+    Index chunkEnd = static_cast<size_t>(end - begin) > grain
+                         ? static_cast<Index>(begin + grain)
+                         : end;
+    if (!callChunk(f, begin, chunkEnd)) {
+      return;
+    }
+    begin = chunkEnd;
+  }
+}
+
+template <typename Index, typename F>
+void ParallelFor<Index, F>::wait() {
+  wg.wait();
+}
+
+template <typename Index, typename F>
+void ParallelFor<Index, F>::spawn(Index begin, Index end) {
+  pending++;
+  wg.add(1);
+  // The WaitGroup is copied, as this may be destructed as soon as the count
+  // reaches zero.
+  auto waitGroup = wg;
+  schedule([this, begin, end, waitGroup] {
+    pending--;
+    run(begin, end);
+    waitGroup.done();
+  });
+}
+
+// parallelChunks() calls f(chunkBegin, chunkEnd) for chunks of at most grain
+// indices that cover [begin, end), using ParallelFor, and waits for all the
+// calls to complete.
+template <typename Index, typename F>
+MARL_NO_EXPORT inline void parallelChunks(Index begin,
+                                          Index end,
+                                          size_t grain,
+                                          F& f) {
+  auto numWorkers = Scheduler::get()->config().workerThread.count;
+  ParallelFor<Index, F> loop(grain, f, static_cast<uint32_t>(numWorkers));
+  loop.run(begin, end);
+  loop.wait();
+}
+
+}  // namespace detail
+
+// parallel_for() calls f(i) for each index i in [begin, end), potentially
+// concurrently, and waits for all the calls to complete before returning.
+//
+// The range is split lazily: the calling thread starts on the whole range, and
+// only splits off the upper half of its remaining range into a new task while
+// fewer split tasks are waiting to start than there are worker threads. The
+// split tasks divide their ranges in the same way, so the range is only
+// divided as finely as stealing demands. Ranges of grain or fewer indices are
+// not split, and splitting is only considered once every grain indices.
+//
+// f is called by reference, and is not copied. No memory is allocated per
+// index.
+//
+// parallel_for() must be called on a thread with a bound scheduler. If the
+// scheduler has no worker threads, all of f is called on the calling thread.
+template <typename Index, typename F>
+MARL_NO_EXPORT inline void parallel_for(Index begin,
+                                        Index end,
+                                        size_t grain,
+                                        F&& f) {
+  MARL_ASSERT_HAS_BOUND_SCHEDULER("marl::parallel_for");
+  MARL_ASSERT(grain > 0, "parallel_for() grain must be greater than 0");
+  auto chunk = [&](Index chunkBegin, Index chunkEnd) {
+    for (Index i = chunkBegin; i < chunkEnd; ++i) {
+      f(i);
+    }
+  };
+  detail::parallelChunks(begin, end, grain, chunk);
+}
+
+// AffinityPartitioner records which worker thread ran each sub-range of a
+// parallel_for() loop, so that later loops over a range of the same size run
+// each sub-range on the same worker thread as before, where the sub-range's
+// data is likely to still be in the worker's cache. Workers that run out of
+// sub-ranges steal from busy workers, and the thief becomes the worker for the
+// stolen sub-range in the next loop.
+//
+// An AffinityPartitioner must not be used by more than one loop at a time.
+class AffinityPartitioner {
+ public:
+  MARL_NO_EXPORT inline AffinityPartitioner(
+      Allocator* allocator = Allocator::Default);
+
+ private:
+  template <typename Index, typename F>
+  friend class detail::AffinityParallelFor;
+
+  AffinityPartitioner(const AffinityPartitioner&) = delete;
+  AffinityPartitioner& operator=(const AffinityPartitioner&) = delete;
+
+  // The number of sub-ranges the loop is divided into per worker thread.
+  static constexpr size_t RangesPerWorker = 4;
+
+  // prepare() resizes workers to numRanges sub-ranges of rangeSize indices,
+  // forgetting the recorded workers if the sub-ranges have changed.
+  MARL_NO_EXPORT inline void prepare(size_t numRanges, size_t rangeSize);
+
+  // The worker thread that last ran each sub-range, or -1 if unknown.
+  containers::vector<int, 64> workers;
+  // The worker thread that is running each sub-range of the current loop.
+  // Copied to workers once the loop has completed.
+  containers::vector<int, 64> running;
+  size_t rangeSize = 0;
+};
+
+AffinityPartitioner::AffinityPartitioner(
+    Allocator* allocator /* = Allocator::Default */)
+    : workers(allocator), running(allocator) {}
+
+void AffinityPartitioner::prepare(size_t numRanges, size_t size) {
+  if (workers.size() != numRanges || rangeSize != size) {
+    workers.resize(numRanges);
+    running.resize(numRanges);
+    for (size_t i = 0; i < numRanges; i++) {
+      workers[i] = -1;
+    }
+    rangeSize = size;
+  }
+}
+
+namespace detail {
+
+// AffinityParallelFor implements parallel_for() with an AffinityPartitioner.
+template <typename Index, typename F>
+class AffinityParallelFor {
+ public:
+  MARL_NO_EXPORT static inline void run(Index begin,
+                                        Index end,
+                                        size_t grain,
+                                        AffinityPartitioner& partitioner,
+                                        F& f);
+};
+
+template <typename Index, typename F>
+void AffinityParallelFor<Index, F>::run(Index begin,
+                                        Index end,
+                                        size_t grain,
+                                        AffinityPartitioner& partitioner,
+                                        F& f) {
+  if (!(begin < end)) {
+    return;
+  }
+  auto scheduler = Scheduler::get();
+  auto numWorkers = static_cast<size_t>(scheduler->config().workerThread.count);
+  if (numWorkers == 0) {
+    f(begin, end);
+    return;
+  }
+
+  auto count = static_cast<size_t>(end - begin);
+  auto maxRanges = numWorkers * AffinityPartitioner::RangesPerWorker;
+  auto rangeSize = std::max(grain, (count + maxRanges - 1) / maxRanges);
+  auto numRanges = (count + rangeSize - 1) / rangeSize;
+  partitioner.prepare(numRanges, rangeSize);
+
+  auto self = Scheduler::currentWorkerId();
+  auto workers = &partitioner.workers[0];
+  auto running = &partitioner.running[0];
+  auto range = [=](size_t i, Index& rangeBegin, Index& rangeEnd) {
+    rangeBegin = static_cast<Index>(begin + i * rangeSize);
+    rangeEnd = i + 1 < numRanges ? static_cast<Index>(rangeBegin + rangeSize)
+                                 : end;
+  };
+
+  // Schedule the sub-ranges of the other workers. Sub-ranges without a
+  // recorded worker are assigned in contiguous blocks.
+  WaitGroup wg;
+  for (size_t i = 0; i < numRanges; i++) {
+    auto worker = workers[i];
+    if (worker < 0) {
+      worker = static_cast<int>(i * numWorkers / numRanges);
+    }
+    if (worker == self) {
+      continue;
+    }
+    Index rangeBegin, rangeEnd;
+    range(i, rangeBegin, rangeEnd);
+    wg.add(1);
+    scheduler->enqueue(Task([=, &f] {
+                         running[i] = Scheduler::currentWorkerId();
+                         f(rangeBegin, rangeEnd);
+                         wg.done();
+                       }),
+                       worker);
+  }
+
+  // Run the calling worker's sub-ranges.
+  for (size_t i = 0; i < numRanges; i++) {
+    auto worker = workers[i];
+    if (worker < 0) {
+      worker = static_cast<int>(i * numWorkers / numRanges);
+    }
+    if (worker == self) {
+      Index rangeBegin, rangeEnd;
+      range(i, rangeBegin, rangeEnd);
+      running[i] = self;
+      f(rangeBegin, rangeEnd);
+    }
+  }
+
+  wg.wait();
+  for (size_t i = 0; i < numRanges; i++) {
+    workers[i] = running[i];
+  }
+}
+
+}  // namespace detail
+
+// parallel_for() calls f(rangeBegin, rangeEnd) for each of a number of
+// sub-ranges that together cover [begin, end), potentially concurrently, and
+// waits for all the calls to complete before returning.
+//
+// The range is divided into up to 4 sub-ranges per worker thread, of at least
+// grain indices each. Each sub-range is run on the worker thread recorded in
+// partitioner by the last loop with the same sub-ranges, so repeated loops
+// over the same data reuse each worker's cache. If the calling thread is a
+// worker thread, it runs its own sub-ranges.
+//
+// parallel_for() must be called on a thread with a bound scheduler. If the
+// scheduler has no worker threads, f is called once with the whole range on
+// the calling thread.
+template <typename Index, typename F>
+MARL_NO_EXPORT inline void parallel_for(Index begin,
+                                        Index end,
+                                        size_t grain,
+                                        AffinityPartitioner& partitioner,
+                                        F&& f) {
+  MARL_ASSERT_HAS_BOUND_SCHEDULER("marl::parallel_for");
+  MARL_ASSERT(grain > 0, "parallel_for() grain must be greater than 0");
+  detail::AffinityParallelFor<
+      Index, typename std::remove_reference<F>::type>::run(begin, end, grain,
+                                                           partitioner, f);
+}
+
+}  // namespace marl
+
+#endif  // marl_parallel_for_h
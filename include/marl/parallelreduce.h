@@ -0,0 +1,286 @@
+// Copyright 2026 The Marl Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef marl_parallel_reduce_h
+#define marl_parallel_reduce_h
+
+#include "containers.h"
+#include "debug.h"
+#include "parallelfor.h"
+#include "scheduler.h"
+#include "waitgroup.h"
+
+#include <atomic>
+#include <type_traits>
+
+namespace marl {
+
+// ReduceMode controls how parallel_reduce() combines partial results.
+enum class ReduceMode {
+  // Fast accumulates the ranges run by each worker thread into a partial
+  // result per worker, and then combines the partial results. The grouping
+  // and order of the combined values depend on how the range was divided
+  // between the workers, which varies from call to call, so combine must be
+  // associative and commutative.
+  Fast,
+
+  // Deterministic divides the range into fixed chunks of grain indices, and
+  // combines the chunk results in index order with a balanced binary tree
+  // that depends only on the size of the range and grain. The result is
+  // bit-reproducible regardless of the number of worker threads, so floating
+  // point reductions can be compared exactly. combine must be associative.
+  Deterministic,
+};
+
+namespace detail {
+
+// FastReduce implements parallel_reduce() with ReduceMode::Fast.
+template <typename Index, typename T, typename Body, typename Combine>
+class FastReduce {
+ public:
+  MARL_NO_EXPORT inline FastReduce(const T& identity,
+                                   Body& body,
+                                   Combine& combine,
+                                   size_t numWorkers,
+                                   Allocator* allocator);
+
+  // run() reduces the range [begin, end) in chunks of at most grain indices.
+  MARL_NO_EXPORT inline T run(Index begin, Index end, size_t grain);
+
+  // operator() accumulates the chunk [chunkBegin, chunkEnd) into the partial
+  // result of the calling thread.
+  MARL_NO_EXPORT inline void operator()(Index chunkBegin, Index chunkEnd);
+
+ private:
+  // Partial holds the partial result of a single worker thread. Partials are
+  // only written by their worker, and are padded to separate cache lines.
+  struct alignas(64) Partial {
+    T value;
+    bool used = false;
+    MARL_NO_EXPORT inline Partial(const T& value);
+  };
+
+  const T& identity;
+  Body& body;
+  Combine& combine;
+  const size_t numWorkers;
+  // One partial per worker thread, followed by one for the calling thread if
+  // it is not a worker thread.
+  containers::vector<Partial, 1> partials;
+};
+
+template <typename Index, typename T, typename Body, typename Combine>
+FastReduce<Index, T, Body, Combine>::Partial::Partial(const T& value)
+    : value(value) {}
+
+template <typename Index, typename T, typename Body, typename Combine>
+FastReduce<Index, T, Body, Combine>::FastReduce(const T& identity,
+                                                Body& body,
+                                                Combine& combine,
+                                                size_t numWorkers,
+                                                Allocator* allocator)
+    : identity(identity),
+      body(body),
+      combine(combine),
+      numWorkers(numWorkers),
+      partials(allocator) {
+  partials.reserve(numWorkers + 1);
+  for (size_t i = 0; i <= numWorkers; i++) {
+    partials.push_back(Partial(identity));
+  }
+}
+
+template <typename Index, typename T, typename Body, typename Combine>
+T FastReduce<Index, T, Body, Combine>::run(Index begin,
+                                           Index end,
+                                           size_t grain) {
+  parallelChunks(begin, end, grain, *this);
+  T result = identity;
+  for (size_t i = 0; i <= numWorkers; i++) {
+    if (partials[i].used) {
+      result = combine(result, partials[i].value);
+    }
+  }
+  return result;
+}
+
+template <typename Index, typename T, typename Body, typename Combine>
+void FastReduce<Index, T, Body, Combine>::operator()(Index chunkBegin,
+                                                     Index chunkEnd) {
+  // The chunk is reduced before the partial is read, as the body may block,
+  // letting the worker run other chunks that update the partial.
+  T value = body(chunkBegin, chunkEnd, identity);
+  auto id = Scheduler::currentWorkerId();
+  auto& partial = partials[id < 0 ? numWorkers : static_cast<size_t>(id)];
+  if (partial.used) {
+    partial.value = combine(partial.value, value);
+  } else {
+    partial.value = value;
+    partial.used = true;
+  }
+}
+
+// DeterministicReduce implements parallel_reduce() with
+// ReduceMode::Deterministic.
+template <typename Index, typename T, typename Body, typename Combine>
+class DeterministicReduce {
+ public:
+  MARL_NO_EXPORT inline DeterministicReduce(Index begin,
+                                            Index end,
+                                            size_t grain,
+                                            const T& identity,
+                                            Body& body,
+                                            Combine& combine,
+                                            uint32_t maxPending);
+
+  // run() returns the reduction of the chunks [firstChunk, lastChunk).
+  // The right half of the chunks is reduced by a new task while fewer than
+  // maxPending such tasks are waiting to start. The tree of combines does not
+  // depend on which halves are run by new tasks.
+  MARL_NO_EXPORT inline T run(size_t firstChunk, size_t lastChunk);
+
+  // numChunks() returns the number of chunks in the range.
+  MARL_NO_EXPORT inline size_t numChunks() const;
+
+ private:
+  const Index begin;
+  const Index end;
+  const size_t grain;
+  const T& identity;
+  Body& body;
+  Combine& combine;
+  const uint32_t maxPending;
+  std::atomic<uint32_t> pending = {0};  // Split tasks not yet started.
+};
+
+template <typename Index, typename T, typename Body, typename Combine>
+DeterministicReduce<Index, T, Body, Combine>::DeterministicReduce(
+    Index begin,
+    Index end,
+    size_t grain,
+    const T& identity,
+    Body& body,
+    Combine& combine,
+    uint32_t maxPending)
+    : begin(begin),
+      end(end),
+      grain(grain),
+      identity(identity),
+      body(body),
+      combine(combine),
+      maxPending(maxPending) {}
+
+template <typename Index, typename T, typename Body, typename Combine>
+T DeterministicReduce<Index, T, Body, Combine>::run(size_t firstChunk,
+                                                    size_t lastChunk) {
+  if (lastChunk - firstChunk == 1) {
+    Index chunkBegin = static_cast<Index>(begin + firstChunk * grain);
+    Index chunkEnd = lastChunk < numChunks()
+                         ? static_cast<Index>(begin + lastChunk * grain)
+                         : end;
+    return body(chunkBegin, chunkEnd, identity);
+  }
+
+  size_t mid = firstChunk + (lastChunk - firstChunk) / 2;
+  if (pending.load(std::memory_order_relaxed) >= maxPending) {
+    T left = run(firstChunk, mid);
+    return combine(left, run(mid, lastChunk));
+  }
+
+  pending++;
+  T right = identity;
+  WaitGroup wg(1);
+  schedule([this, mid, lastChunk, wg, &right] {
+    pending--;
+    right = run(mid, lastChunk);
+    wg.done();
+  });
+  T left = run(firstChunk, mid);
+  wg.wait();
+  return combine(left, right);
+}
+
+template <typename Index, typename T, typename Body, typename Combine>
+size_t DeterministicReduce<Index, T, Body, Combine>::numChunks() const {
+  return (static_cast<size_t>(end - begin) + grain - 1) / grain;
+}
+
+}  // namespace detail
+
+// parallel_reduce() reduces the range [begin, end) to a single value,
+// potentially concurrently, and returns the result.
+//
+// The range is divided into chunks of at most grain indices. Each chunk
+// [chunkBegin, chunkEnd) is reduced with a call to
+// body(chunkBegin, chunkEnd, identity), which returns identity combined with
+// the values of each index in the chunk. The chunk results are then combined
+// with calls to combine(a, b), which returns the combination of a followed by
+// b. identity must be the identity of combine, and is returned for an empty
+// range. See ReduceMode for the order in which the chunk results are combined.
+//
+// Neither the range splitting nor the partial results use atomic operations
+// or locks per chunk. body, combine and identity are used by reference, and
+// are not copied.
+//
+// parallel_reduce() must be called on a thread with a bound scheduler.
+//
+// Example usage:
+//
+//   double sum = marl::parallel_reduce(
+//       size_t(0), values.size(), 1024, 0.0,
+//       [&](size_t begin, size_t end, double init) {
+//         for (size_t i = begin; i < end; i++) {
+//           init += values[i];
+//         }
+//         return init;
+//       },
+//       [](double a, double b) { return a + b; },
+//       marl::ReduceMode::Deterministic);
+template <typename Index, typename T, typename Body, typename Combine>
+MARL_NO_EXPORT inline T parallel_reduce(Index begin,
+                                        Index end,
+                                        size_t grain,
+                                        const T& identity,
+                                        Body&& body,
+                                        Combine&& combine,
+                                        ReduceMode mode = ReduceMode::Fast) {
+  MARL_ASSERT_HAS_BOUND_SCHEDULER("marl::parallel_reduce");
+  MARL_ASSERT(grain > 0, "parallel_reduce() grain must be greater than 0");
+  if (!(begin < end)) {
+    return identity;
+  }
+  using BodyT = typename std::remove_reference<Body>::type;
+  using CombineT = typename std::remove_reference<Combine>::type;
+  auto scheduler = Scheduler::get();
+  auto numWorkers = scheduler->config().workerThread.count;
+  switch (mode) {
+    case ReduceMode::Fast: {
+      detail::FastReduce<Index, T, BodyT, CombineT> reduce(
+          identity, body, combine, static_cast<size_t>(numWorkers),
+          scheduler->config().allocator);
+      return reduce.run(begin, end, grain);
+    }
+    case ReduceMode::Deterministic: {
+      detail::DeterministicReduce<Index, T, BodyT, CombineT> reduce(
+          begin, end, grain, identity, body, combine,
+          static_cast<uint32_t>(numWorkers));
+      return reduce.run(0, reduce.numChunks());
+    }
+  }
+  return identity;
+}
+
+}  // namespace marl
+
+#endif  // marl_parallel_reduce_h
@@ -0,0 +1,125 @@
+// Copyright 2026 The Marl Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef marl_parallel_scan_h
+#define marl_parallel_scan_h
+
+#include "containers.h"
+#include "debug.h"
+#include "parallelfor.h"
+#include "scheduler.h"
+
+#include <iterator>
+
+namespace marl {
+
+// ScanKind selects whether parallel_scan() includes each element in its own
+// output.
+enum class ScanKind {
+  // Each output is the combination of the inputs up to and including the
+  // input at the same position.
+  Inclusive,
+
+  // Each output is the combination of the inputs before the input at the same
+  // position. The first output is identity.
+  Exclusive,
+};
+
+// parallel_scan() writes the prefix combinations of the inputs [first, last)
+// to the outputs starting at out, potentially concurrently, and waits for all
+// the outputs to be written before returning. out may be equal to first.
+// RandomIt and OutputIt must be random access iterators, as each chunk is
+// addressed directly by its offset from first and out.
+//
+// The inputs are divided into chunks of grain elements. The first pass
+// reduces each chunk in parallel, the chunk results are then scanned on the
+// calling thread, and a second pass scans each chunk in parallel, starting
+// from the combination of the chunks before it. combine(a, b) returns the
+// combination of a followed by b, and must be associative. identity must be
+// the identity of combine.
+//
+// The order of the calls to combine depends only on the number of inputs and
+// grain, so floating point results are bit-reproducible regardless of the
+// number of worker threads. The temporary chunk results are allocated with
+// the scheduler's allocator.
+//
+// parallel_scan() must be called on a thread with a bound scheduler.
+template <typename RandomIt, typename OutputIt, typename T, typename Combine>
+MARL_NO_EXPORT inline void parallel_scan(RandomIt first,
+                                         RandomIt last,
+                                         OutputIt out,
+                                         size_t grain,
+                                         const T& identity,
+                                         Combine&& combine,
+                                         ScanKind kind = ScanKind::Inclusive) {
+  MARL_ASSERT_HAS_BOUND_SCHEDULER("marl::parallel_scan");
+  MARL_ASSERT(grain > 0, "parallel_scan() grain must be greater than 0");
+  auto count = static_cast<size_t>(std::distance(first, last));
+  auto numChunks = (count + grain - 1) / grain;
+
+  // scanChunk() scans the inputs of the chunk, starting from init.
+  auto scanChunk = [&](size_t chunk, T init) {
+    auto in = first + chunk * grain;
+    auto end = chunk + 1 < numChunks ? in + grain : last;
+    auto o = out + chunk * grain;
+    for (; in != end; ++in, ++o) {
+      if (kind == ScanKind::Inclusive) {
+        init = combine(init, *in);
+        *o = init;
+      } else {
+        T value = *in;  // Read before writing, as out may be equal to first.
+        *o = init;
+        init = combine(init, value);
+      }
+    }
+  };
+
+  if (numChunks <= 1) {
+    if (numChunks == 1) {
+      scanChunk(0, identity);
+    }
+    return;
+  }
+
+  // Reduce all but the last chunk, which is not needed by any other chunk.
+  containers::vector<T, 16> offsets(Scheduler::get()->config().allocator);
+  offsets.reserve(numChunks);
+  for (size_t i = 0; i < numChunks; i++) {
+    offsets.push_back(identity);
+  }
+  parallel_for(size_t(0), numChunks - 1, 1, [&](size_t chunk) {
+    auto in = first + chunk * grain;
+    T sum = identity;
+    for (auto end = in + grain; in != end; ++in) {
+      sum = combine(sum, *in);
+    }
+    offsets[chunk] = sum;
+  });
+
+  // Replace each chunk result with the combination of the preceding chunks.
+  T sum = identity;
+  for (size_t chunk = 0; chunk + 1 < numChunks; chunk++) {
+    T chunkSum = offsets[chunk];
+    offsets[chunk] = sum;
+    sum = combine(sum, chunkSum);
+  }
+  offsets[numChunks - 1] = sum;
+
+  parallel_for(size_t(0), numChunks, 1,
+               [&](size_t chunk) { scanChunk(chunk, offsets[chunk]); });
+}
+
+}  // namespace marl
+
+#endif  // marl_parallel_scan_h
@@ -0,0 +1,206 @@
+// Copyright 2026 The Marl Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef marl_parallel_sort_h
+#define marl_parallel_sort_h
+
+#include "debug.h"
+#include "memory.h"
+#include "parallelfor.h"
+#include "scheduler.h"
+#include "waitgroup.h"
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <iterator>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace marl {
+
+namespace detail {
+
+// ParallelSort holds the state of a single parallel_sort() call.
+//
+// The range is merge sorted between the input and a temporary buffer of the
+// same size: each level of the sort merges the sorted halves from one array
+// into the other, so that the final merge writes to the input. Sub-ranges of
+// at most Threshold elements are sorted with std::sort(), and large merges are
+// split in two by binary search. Halves are sorted and merged by new tasks
+// while fewer than maxPending such tasks are waiting to start.
+template <typename T, typename Compare>
+class ParallelSort {
+ public:
+  // Ranges of at most Threshold elements are sorted with std::sort().
+  static constexpr size_t Threshold = 8192;
+
+  MARL_NO_EXPORT inline ParallelSort(Compare& comp, uint32_t maxPending);
+
+  // sort() sorts the n elements of src. If toDst is true, the sorted elements
+  // are moved to dst, otherwise they are left in src. The elements of dst are
+  // used as temporary storage.
+  MARL_NO_EXPORT inline void sort(T* src, T* dst, size_t n, bool toDst);
+
+ private:
+  // merge() merges the sorted ranges [a, aEnd) and [b, bEnd) into out.
+  MARL_NO_EXPORT inline void merge(T* a, T* aEnd, T* b, T* bEnd, T* out);
+
+  // fork() calls f on a new task if fewer than maxPending tasks are waiting to
+  // start, otherwise on the calling thread. f is called before fork() returns,
+  // or before wg is done.
+  template <typename F>
+  MARL_NO_EXPORT inline void fork(WaitGroup& wg, F&& f);
+
+  Compare& comp;
+  const uint32_t maxPending;
+  std::atomic<uint32_t> pending = {0};  // Forked tasks not yet started.
+};
+
+template <typename T, typename Compare>
+ParallelSort<T, Compare>::ParallelSort(Compare& comp, uint32_t maxPending)
+    : comp(comp), maxPending(maxPending) {}
+
+template <typename T, typename Compare>
+void ParallelSort<T, Compare>::sort(T* src, T* dst, size_t n, bool toDst) {
+  if (n <= Threshold) {
+    std::sort(src, src + n, comp);
+    if (toDst) {
+      std::move(src, src + n, dst);
+    }
+    return;
+  }
+
+  // Sort the halves into the array that is not the destination, then merge
+  // them into the destination.
+  size_t mid = n / 2;
+  WaitGroup wg;
+  fork(wg, [this, src, dst, mid, toDst] { sort(src, dst, mid, !toDst); });
+  sort(src + mid, dst + mid, n - mid, !toDst);
+  wg.wait();
+
+  T* from = toDst ? src : dst;
+  T* to = toDst ? dst : src;
+  merge(from, from + mid, from + mid, from + n, to);
+}
+
+template <typename T, typename Compare>
+void ParallelSort<T, Compare>::merge(T* a, T* aEnd, T* b, T* bEnd, T* out) {
+  auto aCount = static_cast<size_t>(aEnd - a);
+  auto bCount = static_cast<size_t>(bEnd - b);
+  if (aCount + bCount <= Threshold) {
+    std::merge(std::make_move_iterator(a), std::make_move_iterator(aEnd),
+               std::make_move_iterator(b), std::make_move_iterator(bEnd), out,
+               comp);
+    return;
+  }
+
+  // Split the larger range at its middle, and the other range at the same
+  // value, so that each half of the output can be merged independently.
+  T *aMid, *bMid;
+  if (aCount >= bCount) {
+    aMid = a + aCount / 2;
+    bMid = std::lower_bound(b, bEnd, *aMid, comp);
+  } else {
+    bMid = b + bCount / 2;
+    aMid = std::upper_bound(a, aEnd, *bMid, comp);
+  }
+  T* outMid = out + (aMid - a) + (bMid - b);
+  WaitGroup wg;
+  fork(wg, [this, a, aMid, b, bMid, out] { merge(a, aMid, b, bMid, out); });
+  merge(aMid, aEnd, bMid, bEnd, outMid);
+  wg.wait();
+}
+
+template <typename T, typename Compare>
+template <typename F>
+void ParallelSort<T, Compare>::fork(WaitGroup& wg, F&& f) {
+  if (pending.load(std::memory_order_relaxed) >= maxPending) {
+    f();
+    return;
+  }
+  pending++;
+  wg.add(1);
+  schedule([this, wg, f] {
+    pending--;
+    f();
+    wg.done();
+  });
+}
+
+}  // namespace detail
+
+// parallel_sort() sorts the elements of the contiguous range [first, last)
+// into ascending order according to comp, potentially concurrently, and
+// waits for the sort to complete before returning. Like std::sort(), the
+// order of equal elements is not preserved.
+//
+// Ranges of 8192 or fewer elements, and all ranges if the scheduler has no
+// worker threads, are sorted with std::sort() on the calling thread. Larger
+// ranges are merge sorted on the scheduler's worker threads, using a
+// temporary buffer of elements that is allocated from the scheduler's
+// allocator. The elements must be move constructible and move assignable.
+//
+// parallel_sort() must be called on a thread with a bound scheduler.
+template <typename RandomIt, typename Compare>
+MARL_NO_EXPORT inline void parallel_sort(RandomIt first,
+                                         RandomIt last,
+                                         Compare comp) {
+  MARL_ASSERT_HAS_BOUND_SCHEDULER("marl::parallel_sort");
+  using T = typename std::iterator_traits<RandomIt>::value_type;
+  using Sort = detail::ParallelSort<T, Compare>;
+
+  auto scheduler = Scheduler::get();
+  auto numWorkers = scheduler->config().workerThread.count;
+  auto n = static_cast<size_t>(last - first);
+  if (n <= Sort::Threshold || numWorkers == 0) {
+    std::sort(first, last, comp);
+    return;
+  }
+
+  Allocation::Request request;
+  request.size = sizeof(T) * n;
+  request.alignment = alignof(T);
+  request.usage = Allocation::Usage::Vector;
+  auto allocator = scheduler->config().allocator;
+  auto allocation = allocator->allocate(request);
+  auto data = &*first;
+  auto buffer = reinterpret_cast<T*>(allocation.ptr);
+
+  // Move the elements to the buffer, and sort them back into the range.
+  parallel_for(size_t(0), n, Sort::Threshold, [&](size_t i) {
+    new (&buffer[i]) T(std::move(data[i]));
+  });
+  Sort sorter(comp, static_cast<uint32_t>(numWorkers));
+  sorter.sort(buffer, data, n, true);
+  if (!std::is_trivially_destructible<T>::value) {
+    parallel_for(size_t(0), n, Sort::Threshold,
+                 [&](size_t i) { buffer[i].~T(); });
+  }
+
+  allocator->free(allocation);
+}
+
+// parallel_sort() sorts the elements of the contiguous range [first, last)
+// into ascending order with operator<. See parallel_sort() above.
+template <typename RandomIt>
+MARL_NO_EXPORT inline void parallel_sort(RandomIt first, RandomIt last) {
+  using T = typename std::iterator_traits<RandomIt>::value_type;
+  parallel_sort(first, last, std::less<T>());
+}
+
+}  // namespace marl
+
+#endif  // marl_parallel_sort_h
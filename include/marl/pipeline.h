@@ -0,0 +1,277 @@
+// Copyright 2026 The Marl Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef marl_pipeline_h
+#define marl_pipeline_h
+
+#include "conditionvariable.h"
+#include "containers.h"
+#include "debug.h"
+#include "memory.h"
+#include "mutex.h"
+#include "scheduler.h"
+#include "sequencer.h"
+#include "waitgroup.h"
+
+#include <functional>
+
+namespace marl {
+
+// StageKind controls how the tokens of a Pipeline pass through a stage.
+enum class StageKind {
+  // The stage runs one token at a time, in the order that the tokens were
+  // produced by the source.
+  SerialInOrder,
+
+  // The stage runs one token at a time, in any order.
+  SerialOutOfOrder,
+
+  // The stage may run any number of tokens concurrently.
+  Parallel,
+};
+
+// Pipeline runs a sequence of stages over a stream of items of type T.
+//
+// Items are produced by a source function, which is called serially. Each
+// item is held in a token, which then runs through each of the stages in the
+// order they were added. At most maxTokens tokens are in flight at any time,
+// which bounds the memory used by the items. Each token runs the whole
+// sequence of stages on a single task, so an item stays in the cache of the
+// worker thread that produced it. Tokens that wait for a serial stage yield
+// their worker thread to other tokens.
+//
+// SerialInOrder stages are ordered with a Sequencer ticket per token, taken
+// when the source produces the item.
+//
+// T must be default constructible. Each token's T is reused for the
+// following items, so the source must assign every field it relies on.
+//
+// Example usage:
+//
+//   marl::Pipeline<Record> pipeline(16);
+//   pipeline.stage(marl::StageKind::Parallel, [](Record& r) { parse(r); })
+//       .stage(marl::StageKind::Parallel, [](Record& r) { transform(r); })
+//       .stage(marl::StageKind::SerialInOrder, [&](Record& r) { write(r); });
+//   pipeline.run([&](Record& r) { return read(r); });
+template <typename T>
+class Pipeline {
+ public:
+  // Source is called serially to produce each item. It returns false once
+  // there are no more items.
+  using Source = std::function<bool(T&)>;
+
+  // Function is called by a stage to process an item.
+  using Function = std::function<void(T&)>;
+
+  // Constructs a Pipeline that processes at most maxTokens items at once.
+  // maxTokens must be greater than 0.
+  MARL_NO_EXPORT inline Pipeline(size_t maxTokens,
+                                 Allocator* allocator = Allocator::Default);
+
+  // stage() appends a stage of the given kind that calls f with each item.
+  // Returns this Pipeline, so calls can be chained.
+  MARL_NO_EXPORT inline Pipeline& stage(StageKind kind, Function f);
+
+  // run() passes every item produced by source through the stages, and
+  // blocks until all the items have completed the last stage. Returns the
+  // number of items produced. run() must be called on a thread with a bound
+  // scheduler, and must not be called concurrently on the same Pipeline.
+  MARL_NO_EXPORT inline uint64_t run(const Source& source);
+
+ private:
+  Pipeline(const Pipeline&) = delete;
+  Pipeline& operator=(const Pipeline&) = delete;
+
+  using Tickets = containers::vector<Sequencer::Ticket, 8>;
+
+  // Stage holds a stage's function, and the state used to serialize the
+  // tokens that pass through it.
+  struct Stage {
+    MARL_NO_EXPORT inline Stage(StageKind kind,
+                                Function f,
+                                size_t maxTokens,
+                                Allocator* allocator);
+
+    // enter() blocks until the token holding ticket may run the stage.
+    MARL_NO_EXPORT inline void enter(const Sequencer::Ticket& ticket);
+
+    // leave() lets the next token run the stage.
+    MARL_NO_EXPORT inline void leave(Sequencer::Ticket& ticket);
+
+    const StageKind kind;
+    const Function f;
+    const Allocator::unique_ptr<Sequencer> sequencer;  // SerialInOrder only.
+    marl::mutex mutex{"marl::Pipeline"};
+    ConditionVariable cv;
+    bool busy = false;  // guarded by mutex. SerialOutOfOrder only.
+  };
+
+  // SourceState holds the state used to call the source serially.
+  struct SourceState {
+    MARL_NO_EXPORT inline SourceState(const Source& source,
+                                      Allocator* allocator);
+
+    marl::mutex mutex{"marl::Pipeline"};
+    ConditionVariable cv;
+    const Source& source;
+    bool busy = false;      // guarded by mutex
+    bool finished = false;  // guarded by mutex
+    uint64_t count = 0;     // guarded by mutex
+  };
+
+  // produce() calls the source to produce the next item into item, and takes
+  // the token's tickets for the SerialInOrder stages. Returns false if there
+  // are no more items.
+  MARL_NO_EXPORT inline bool produce(SourceState& state,
+                                     T& item,
+                                     Tickets& tickets);
+
+  const size_t maxTokens;
+  Allocator* const allocator;
+  containers::vector<Allocator::unique_ptr<Stage>, 8> stages;
+};
+
+template <typename T>
+Pipeline<T>::Stage::Stage(StageKind kind,
+                          Function f,
+                          size_t maxTokens,
+                          Allocator* allocator)
+    : kind(kind),
+      f(std::move(f)),
+      sequencer(kind == StageKind::SerialInOrder
+                    ? allocator->make_unique<Sequencer>(maxTokens, allocator)
+                    : nullptr),
+      cv(allocator, "marl::Pipeline") {}
+
+template <typename T>
+void Pipeline<T>::Stage::enter(const Sequencer::Ticket& ticket) {
+  switch (kind) {
+    case StageKind::SerialInOrder:
+      ticket.wait();
+      break;
+    case StageKind::SerialOutOfOrder: {
+      marl::lock lock(mutex);
+      cv.wait(lock, [&] { return !busy; });
+      busy = true;
+      break;
+    }
+    case StageKind::Parallel:
+      break;
+  }
+}
+
+template <typename T>
+void Pipeline<T>::Stage::leave(Sequencer::Ticket& ticket) {
+  switch (kind) {
+    case StageKind::SerialInOrder:
+      ticket.done();
+      ticket = Sequencer::Ticket();
+      break;
+    case StageKind::SerialOutOfOrder: {
+      marl::lock lock(mutex);
+      busy = false;
+      cv.notify_one();
+      break;
+    }
+    case StageKind::Parallel:
+      break;
+  }
+}
+
+template <typename T>
+Pipeline<T>::SourceState::SourceState(const Source& source,
+                                      Allocator* allocator)
+    : cv(allocator, "marl::Pipeline"), source(source) {}
+
+template <typename T>
+Pipeline<T>::Pipeline(size_t maxTokens,
+                      Allocator* allocator /* = Allocator::Default */)
+    : maxTokens(maxTokens), allocator(allocator), stages(allocator) {
+  MARL_ASSERT(maxTokens > 0, "Pipeline maxTokens must be greater than 0");
+}
+
+template <typename T>
+Pipeline<T>& Pipeline<T>::stage(StageKind kind, Function f) {
+  stages.emplace_back(
+      allocator->make_unique<Stage>(kind, std::move(f), maxTokens, allocator));
+  return *this;
+}
+
+template <typename T>
+bool Pipeline<T>::produce(SourceState& state, T& item, Tickets& tickets) {
+  {
+    marl::lock lock(state.mutex);
+    state.cv.wait(lock, [&] { return !state.busy; });
+    if (state.finished) {
+      return false;
+    }
+    state.busy = true;
+  }
+  // The source is called without the lock held, as it may block. The busy
+  // flag keeps the calls serial, so the tickets are taken in item order.
+  bool produced = state.source(item);
+  if (produced) {
+    for (size_t i = 0; i < stages.size(); i++) {
+      if (stages[i]->kind == StageKind::SerialInOrder) {
+        tickets[i] = stages[i]->sequencer->take();
+      }
+    }
+  }
+  marl::lock lock(state.mutex);
+  state.busy = false;
+  if (produced) {
+    state.count++;
+    state.cv.notify_one();
+  } else {
+    // Wake all the waiting tokens, so they can see the source is finished.
+    state.finished = true;
+    state.cv.notify_all();
+  }
+  return produced;
+}
+
+template <typename T>
+uint64_t Pipeline<T>::run(const Source& source) {
+  MARL_ASSERT_HAS_BOUND_SCHEDULER("marl::Pipeline::run");
+
+  // Each task holds one token, and loops over the items until the source is
+  // exhausted.
+  SourceState state(source, allocator);
+  WaitGroup wg(static_cast<unsigned int>(maxTokens));
+  for (size_t i = 0; i < maxTokens; i++) {
+    schedule([this, &state, wg] {
+      auto item = allocator->make_unique<T>();
+      Tickets tickets(allocator);
+      tickets.resize(stages.size());
+      while (produce(state, *item, tickets)) {
+        for (size_t s = 0; s < stages.size(); s++) {
+          auto& stage = *stages[s];
+          stage.enter(tickets[s]);
+          stage.f(*item);
+          stage.leave(tickets[s]);
+        }
+      }
+      wg.done();
+    });
+  }
+  wg.wait();
+
+  marl::lock lock(state.mutex);
+  return state.count;
+}
+
+}  // namespace marl
+
+#endif  // marl_pipeline_h
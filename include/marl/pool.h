@@ -18,6 +18,7 @@
 #include "conditionvariable.h"
 #include "memory.h"
 #include "mutex.h"
+#include "scheduler.h"
 
 #include <atomic>
 
@@ -41,6 +42,13 @@ enum class PoolPolicy {
 ////////////////////////////////////////////////////////////////////////////////
 
 // Pool is the abstract base class for BoundedPool<> and UnboundedPool<>.
+//
+// To reduce contention when items are borrowed and returned from many worker
+// threads, each pool holds a small cache of free items (a magazine) per worker
+// thread of the scheduler that first borrows from the pool. Magazines are
+// refilled from, and flushed to, the pool's shared free list in batches.
+// Threads that are not worker threads of that scheduler use the shared free
+// list directly.
 template <typename T>
 class Pool {
  protected:
@@ -54,7 +62,7 @@ class Pool {
   class Loan {
    public:
     MARL_NO_EXPORT inline Loan() = default;
-    MARL_NO_EXPORT inline Loan(Item*, const std::shared_ptr<Storage>&);
+    MARL_NO_EXPORT inline Loan(Item*);
     MARL_NO_EXPORT inline Loan(const Loan&);
     MARL_NO_EXPORT inline Loan(Loan&&);
     MARL_NO_EXPORT inline ~Loan();
@@ -67,17 +75,107 @@ class Pool {
 
    private:
     Item* item = nullptr;
-    std::shared_ptr<Storage> storage;
   };
 
  protected:
   Pool() = default;
 
+  // Maximum number of items held by a single magazine.
+  static constexpr size_t MagazineCapacity = 16;
+
+  // Magazine is a cache of free items used by a single worker thread.
+  // The mutex is only contended when a borrower steals from the magazine of
+  // another worker, or when the pool is released.
+  struct alignas(64) Magazine {
+    marl::mutex mutex;
+    Item* items[MagazineCapacity];
+    size_t capacity = 0;      // Maximum number of cached items.
+    size_t count = 0;         // guarded by mutex
+    int64_t outstanding = 0;  // borrows minus returns. guarded by mutex
+    bool orphaned = false;    // guarded by mutex
+  };
+
+  // Magazines holds a magazine per worker thread of a scheduler.
+  struct Magazines {
+    MARL_NO_EXPORT inline Magazines(Scheduler* scheduler,
+                                    size_t count,
+                                    size_t capacity,
+                                    Allocator* allocator);
+    MARL_NO_EXPORT inline ~Magazines();
+
+    Scheduler* const scheduler;
+    const size_t count;
+    Allocator* const allocator;
+    Allocation allocation;
+    Magazine* magazines;
+  };
+
   // The shared storage between the pool and all loans.
+  // Storage is kept alive by the pools that reference it, and once all pools
+  // have been destructed, by the items that are still on loan.
   class Storage {
    public:
-    virtual ~Storage() = default;
+    // maxCached is the maximum number of items that may be cached across all
+    // the magazines.
+    MARL_NO_EXPORT inline Storage(Allocator* allocator, size_t maxCached);
+    virtual ~Storage();
+
+    // return_() returns the loaned item to the pool.
     virtual void return_(Item*) = 0;
+
+    // acquire() adds a pool reference to the storage.
+    MARL_NO_EXPORT inline void acquire();
+
+    // release() drops a pool reference to the storage. Once all pool
+    // references are dropped, the storage is destroyed when the last loaned
+    // item is returned.
+    MARL_NO_EXPORT inline void release();
+
+   protected:
+    // destroy() destructs and frees this storage.
+    virtual void destroy() = 0;
+
+    // magazine() returns the magazine of the calling worker thread, or the
+    // shared magazine, which caches no items, if the calling thread is not a
+    // worker thread of the scheduler that the magazines were created for. If
+    // create is true and the magazines have not been created, they are created
+    // for the scheduler of the calling worker thread.
+    MARL_NO_EXPORT inline Magazine& magazine(bool create);
+
+    // takeCached() accounts for a new loan, and returns a free item from the
+    // calling thread's magazine, or nullptr if the magazine is empty.
+    MARL_NO_EXPORT inline Item* takeCached();
+
+    // takeSharedAndUnlock() pops an item from the shared free list, moving up
+    // to half a magazine of additional free items into the calling thread's
+    // magazine.
+    // Returns nullptr if the shared free list is empty.
+    // mutex must be locked by the caller, and is unlocked on return.
+    MARL_NO_EXPORT inline Item* takeSharedAndUnlock(marl::lock& lock);
+
+    // steal() returns a free item from any of the magazines, or nullptr if all
+    // magazines are empty.
+    MARL_NO_EXPORT inline Item* steal();
+
+    // put() places the returned item into the calling thread's magazine,
+    // flushing items to the shared free list if the magazine is full or there
+    // are borrowers waiting for free items.
+    MARL_NO_EXPORT inline void put(Item* item);
+
+    // pushShared() pushes the list of n items to the shared free list.
+    MARL_NO_EXPORT inline void pushShared(Item** items, size_t n);
+
+    Allocator* const storageAllocator;
+    const size_t maxCached;
+    std::atomic<int> handles = {1};        // Number of pool references.
+    std::atomic<int64_t> remaining = {0};  // Loans remaining once orphaned.
+    std::atomic<int> numWaiting = {0};     // Number of blocked borrowers.
+    // Created on the first borrow by a worker thread.
+    std::atomic<Magazines*> workerMagazines = {nullptr};
+    Magazine sharedMagazine;
+    marl::mutex mutex;
+    ConditionVariable returned;
+    Item* free = nullptr;  // guarded by mutex
   };
 
   // The backing data of a single item in the pool.
@@ -94,7 +192,8 @@ class Pool {
     using Data = typename aligned_storage<sizeof(T), alignof(T)>::type;
     Data data;
     std::atomic<int> refcount = {0};
-    Item* next = nullptr;  // pointer to the next free item in the pool.
+    Storage* storage = nullptr;  // the storage that owns this item.
+    Item* next = nullptr;        // pointer to the next free item in the pool.
   };
 };
 
@@ -120,27 +219,237 @@ void Pool<T>::Item::destruct() {
   get()->~T();
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// Pool<T>::Magazines
+////////////////////////////////////////////////////////////////////////////////
+template <typename T>
+Pool<T>::Magazines::Magazines(Scheduler* scheduler,
+                              size_t count,
+                              size_t capacity,
+                              Allocator* allocator)
+    : scheduler(scheduler), count(count), allocator(allocator) {
+  Allocation::Request request;
+  request.size = sizeof(Magazine) * count;
+  request.alignment = alignof(Magazine);
+  request.usage = Allocation::Usage::Create;
+  allocation = allocator->allocate(request);
+  magazines = reinterpret_cast<Magazine*>(allocation.ptr);
+  for (size_t i = 0; i < count; i++) {
+    new (&magazines[i]) Magazine();
+    magazines[i].capacity = capacity;
+  }
+}
+
+template <typename T>
+Pool<T>::Magazines::~Magazines() {
+  for (size_t i = 0; i < count; i++) {
+    magazines[i].~Magazine();
+  }
+  allocator->free(allocation);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Pool<T>::Storage
+////////////////////////////////////////////////////////////////////////////////
+template <typename T>
+Pool<T>::Storage::Storage(Allocator* allocator, size_t maxCached)
+    : storageAllocator(allocator), maxCached(maxCached), returned(allocator) {}
+
+template <typename T>
+Pool<T>::Storage::~Storage() {
+  if (auto mags = workerMagazines.load(std::memory_order_acquire)) {
+    storageAllocator->destroy(mags);
+  }
+}
+
+template <typename T>
+void Pool<T>::Storage::acquire() {
+  handles++;
+}
+
+template <typename T>
+void Pool<T>::Storage::release() {
+  if (--handles != 0) {
+    return;
+  }
+  // No more pools reference the storage, so there can be no more borrows.
+  // Count the loans still outstanding, and mark each magazine as orphaned so
+  // that returns from this point on decrement remaining.
+  // Magazines are only created by borrows, so cannot be created here.
+  int64_t outstanding = 0;
+  auto orphan = [&](Magazine& mag) {
+    marl::lock lock(mag.mutex);
+    outstanding += mag.outstanding;
+    mag.orphaned = true;
+  };
+  orphan(sharedMagazine);
+  if (auto mags = workerMagazines.load(std::memory_order_acquire)) {
+    for (size_t i = 0; i < mags->count; i++) {
+      orphan(mags->magazines[i]);
+    }
+  }
+  if ((remaining += outstanding) == 0) {
+    destroy();
+  }
+}
+
+template <typename T>
+typename Pool<T>::Magazine& Pool<T>::Storage::magazine(bool create) {
+  auto id = Scheduler::currentWorkerId();
+  if (id < 0) {
+    return sharedMagazine;
+  }
+  auto scheduler = Scheduler::get();
+  auto mags = workerMagazines.load(std::memory_order_acquire);
+  if (mags == nullptr && create) {
+    auto count = static_cast<size_t>(scheduler->config().workerThread.count);
+    auto capacity = maxCached / count;
+    if (capacity > MagazineCapacity) {
+      capacity = MagazineCapacity;
+    }
+    auto created = storageAllocator->create<Magazines>(scheduler, count,
+                                                       capacity,
+                                                       storageAllocator);
+    if (workerMagazines.compare_exchange_strong(mags, created,
+                                                std::memory_order_acq_rel)) {
+      mags = created;
+    } else {
+      storageAllocator->destroy(created);  // Created by another worker.
+    }
+  }
+  if (mags == nullptr || mags->scheduler != scheduler ||
+      static_cast<size_t>(id) >= mags->count) {
+    return sharedMagazine;
+  }
+  return mags->magazines[id];
+}
+
+template <typename T>
+typename Pool<T>::Item* Pool<T>::Storage::takeCached() {
+  auto& mag = magazine(true);
+  marl::lock lock(mag.mutex);
+  mag.outstanding++;
+  return mag.count > 0 ? mag.items[--mag.count] : nullptr;
+}
+
+template <typename T>
+typename Pool<T>::Item* Pool<T>::Storage::takeSharedAndUnlock(
+    marl::lock& lock) {
+  Item* batch[MagazineCapacity];
+  size_t n = 0;
+  auto& mag = magazine(false);
+  auto item = free;
+  if (item != nullptr) {
+    free = item->next;
+    auto max = mag.capacity / 2;
+    while (free != nullptr && n < max) {
+      batch[n++] = free;
+      free = free->next;
+    }
+  }
+  lock.unlock_no_tsa();
+
+  if (n > 0) {
+    marl::lock magLock(mag.mutex);
+    while (n > 0 && mag.count < mag.capacity) {
+      mag.items[mag.count++] = batch[--n];
+    }
+  }
+  if (n > 0) {
+    pushShared(batch, n);
+  }
+  return item;
+}
+
+template <typename T>
+typename Pool<T>::Item* Pool<T>::Storage::steal() {
+  auto mags = workerMagazines.load(std::memory_order_acquire);
+  if (mags == nullptr) {
+    return nullptr;
+  }
+  for (size_t i = 0; i < mags->count; i++) {
+    auto& mag = mags->magazines[i];
+    marl::lock lock(mag.mutex);
+    if (mag.count > 0) {
+      return mag.items[--mag.count];
+    }
+  }
+  return nullptr;
+}
+
+template <typename T>
+void Pool<T>::Storage::put(Item* item) {
+  Item* flush[MagazineCapacity + 1];
+  size_t n = 0;
+  {
+    auto& mag = magazine(false);
+    marl::lock lock(mag.mutex);
+    mag.outstanding--;
+    if (mag.orphaned) {
+      lock.unlock_no_tsa();
+      if (--remaining == 0) {
+        destroy();
+      }
+      return;
+    }
+    if (mag.count == mag.capacity) {
+      // Magazine is full. Flush half of it to the shared free list.
+      auto keep = mag.capacity / 2;
+      while (mag.count > keep) {
+        flush[n++] = mag.items[--mag.count];
+      }
+    }
+    if (mag.count < mag.capacity) {
+      mag.items[mag.count++] = item;
+    } else {
+      flush[n++] = item;
+    }
+    // Borrowers blocked on an empty pool only wait on the shared free list.
+    // As the item is pushed before checking numWaiting, either the borrower
+    // will find the item in this magazine, or we will see the borrower.
+    if (numWaiting > 0) {
+      while (mag.count > 0) {
+        flush[n++] = mag.items[--mag.count];
+      }
+    }
+  }
+  if (n > 0) {
+    pushShared(flush, n);
+  }
+}
+
+template <typename T>
+void Pool<T>::Storage::pushShared(Item** items, size_t n) {
+  {
+    marl::lock lock(mutex);
+    for (size_t i = 0; i < n; i++) {
+      items[i]->next = free;
+      free = items[i];
+    }
+  }
+  if (numWaiting > 0) {
+    returned.notify_all();
+  }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // Pool<T>::Loan
 ////////////////////////////////////////////////////////////////////////////////
 template <typename T>
-Pool<T>::Loan::Loan(Item* item, const std::shared_ptr<Storage>& storage)
-    : item(item), storage(storage) {
+Pool<T>::Loan::Loan(Item* item) : item(item) {
   item->refcount++;
 }
 
 template <typename T>
-Pool<T>::Loan::Loan(const Loan& other)
-    : item(other.item), storage(other.storage) {
+Pool<T>::Loan::Loan(const Loan& other) : item(other.item) {
   if (item != nullptr) {
     item->refcount++;
   }
 }
 
 template <typename T>
-Pool<T>::Loan::Loan(Loan&& other) : item(other.item), storage(other.storage) {
+Pool<T>::Loan::Loan(Loan&& other) : item(other.item) {
   other.item = nullptr;
-  other.storage = nullptr;
 }
 
 template <typename T>
@@ -154,21 +463,19 @@ void Pool<T>::Loan::reset() {
     auto refs = --item->refcount;
     MARL_ASSERT(refs >= 0, "reset() called on zero-ref pool item");
     if (refs == 0) {
-      storage->return_(item);
+      item->storage->return_(item);
     }
     item = nullptr;
-    storage = nullptr;
   }
 }
 
 template <typename T>
 typename Pool<T>::Loan& Pool<T>::Loan::operator=(const Loan& rhs) {
-  reset();
   if (rhs.item != nullptr) {
-    item = rhs.item;
-    storage = rhs.storage;
     rhs.item->refcount++;
   }
+  reset();
+  item = rhs.item;
   return *this;
 }
 
@@ -176,7 +483,6 @@ template <typename T>
 typename Pool<T>::Loan& Pool<T>::Loan::operator=(Loan&& rhs) {
   reset();
   std::swap(item, rhs.item);
-  std::swap(storage, rhs.storage);
   return *this;
 }
 
@@ -211,6 +517,9 @@ class BoundedPool : public Pool<T> {
   using Loan = typename Pool<T>::Loan;
 
   MARL_NO_EXPORT inline BoundedPool(Allocator* allocator = Allocator::Default);
+  MARL_NO_EXPORT inline BoundedPool(const BoundedPool&);
+  MARL_NO_EXPORT inline ~BoundedPool();
+  MARL_NO_EXPORT inline BoundedPool& operator=(const BoundedPool&);
 
   // borrow() borrows a single item from the pool, blocking until an item is
   // returned if the pool is empty.
@@ -241,21 +550,30 @@ class BoundedPool : public Pool<T> {
     MARL_NO_EXPORT inline Storage(const Storage&) = delete;
     MARL_NO_EXPORT inline Storage& operator=(const Storage&) = delete;
 
+    // take() takes a free item, blocking if wait is true and the pool is
+    // empty. Returns nullptr if wait is false and the pool is empty.
+    MARL_NO_EXPORT inline Item* take(bool wait);
+
+   protected:
+    MARL_NO_EXPORT inline void destroy() override;
+
+   private:
+    Allocator* const allocator;
     Item items[N];
-    marl::mutex mutex;
-    ConditionVariable returned;
-    Item* free = nullptr;
   };
-  std::shared_ptr<Storage> storage;
+  Storage* storage;
 };
 
 template <typename T, int N, PoolPolicy POLICY>
 BoundedPool<T, N, POLICY>::Storage::Storage(Allocator* allocator)
-    : returned(allocator) {
+    // At most half the items are cached, so that caching items per worker
+    // does not starve other workers.
+    : Pool<T>::Storage(allocator, size_t(N) / 2), allocator(allocator) {
   for (int i = 0; i < N; i++) {
     if (POLICY == PoolPolicy::Preserve) {
       items[i].construct();
     }
+    items[i].storage = this;
     items[i].next = this->free;
     this->free = &items[i];
   }
@@ -270,10 +588,74 @@ BoundedPool<T, N, POLICY>::Storage::~Storage() {
   }
 }
 
+template <typename T, int N, PoolPolicy POLICY>
+void BoundedPool<T, N, POLICY>::Storage::destroy() {
+  allocator->destroy(this);
+}
+
+template <typename T, int N, PoolPolicy POLICY>
+typename BoundedPool<T, N, POLICY>::Item*
+BoundedPool<T, N, POLICY>::Storage::take(bool wait) {
+  if (auto item = this->takeCached()) {
+    return item;
+  }
+  {
+    marl::lock lock(this->mutex);
+    if (auto item = this->takeSharedAndUnlock(lock)) {
+      return item;
+    }
+  }
+
+  // The calling thread's magazine and the shared free list are empty.
+  // Announce that we are waiting before searching the other magazines, so
+  // that any item returned after the search is flushed to the shared list.
+  this->numWaiting++;
+  Item* item = this->steal();
+  if (item == nullptr) {
+    marl::lock lock(this->mutex);
+    if (wait) {
+      this->returned.wait(lock, [&] { return this->free != nullptr; });
+    }
+    item = this->free;
+    if (item != nullptr) {
+      this->free = item->next;
+    }
+  }
+  this->numWaiting--;
+
+  if (item == nullptr) {
+    // tryBorrow() failed. Undo the loan accounting of takeCached().
+    auto& mag = this->magazine(false);
+    marl::lock lock(mag.mutex);
+    mag.outstanding--;
+  }
+  return item;
+}
+
 template <typename T, int N, PoolPolicy POLICY>
 BoundedPool<T, N, POLICY>::BoundedPool(
     Allocator* allocator /* = Allocator::Default */)
-    : storage(allocator->make_shared<Storage>(allocator)) {}
+    : storage(allocator->create<Storage>(allocator)) {}
+
+template <typename T, int N, PoolPolicy POLICY>
+BoundedPool<T, N, POLICY>::BoundedPool(const BoundedPool& other)
+    : storage(other.storage) {
+  storage->acquire();
+}
+
+template <typename T, int N, PoolPolicy POLICY>
+BoundedPool<T, N, POLICY>::~BoundedPool() {
+  storage->release();
+}
+
+template <typename T, int N, PoolPolicy POLICY>
+BoundedPool<T, N, POLICY>& BoundedPool<T, N, POLICY>::operator=(
+    const BoundedPool& other) {
+  other.storage->acquire();
+  storage->release();
+  storage = other.storage;
+  return *this;
+}
 
 template <typename T, int N, PoolPolicy POLICY>
 typename BoundedPool<T, N, POLICY>::Loan BoundedPool<T, N, POLICY>::borrow()
@@ -286,35 +668,26 @@ typename BoundedPool<T, N, POLICY>::Loan BoundedPool<T, N, POLICY>::borrow()
 template <typename T, int N, PoolPolicy POLICY>
 template <typename F>
 void BoundedPool<T, N, POLICY>::borrow(size_t n, const F& f) const {
-  marl::lock lock(storage->mutex);
   for (size_t i = 0; i < n; i++) {
-    storage->returned.wait(lock, [&] { return storage->free != nullptr; });
-    auto item = storage->free;
-    storage->free = storage->free->next;
+    auto item = storage->take(true);
     if (POLICY == PoolPolicy::Reconstruct) {
       item->construct();
     }
-    f(std::move(Loan(item, storage)));
+    f(std::move(Loan(item)));
   }
 }
 
 template <typename T, int N, PoolPolicy POLICY>
 std::pair<typename BoundedPool<T, N, POLICY>::Loan, bool>
 BoundedPool<T, N, POLICY>::tryBorrow() const {
-  Item* item = nullptr;
-  {
-    marl::lock lock(storage->mutex);
-    if (storage->free == nullptr) {
-      return std::make_pair(Loan(), false);
-    }
-    item = storage->free;
-    storage->free = storage->free->next;
-    item->pool = this;
+  auto item = storage->take(false);
+  if (item == nullptr) {
+    return std::make_pair(Loan(), false);
   }
   if (POLICY == PoolPolicy::Reconstruct) {
     item->construct();
   }
-  return std::make_pair(Loan(item, storage), true);
+  return std::make_pair(Loan(item), true);
 }
 
 template <typename T, int N, PoolPolicy POLICY>
@@ -322,12 +695,7 @@ void BoundedPool<T, N, POLICY>::Storage::return_(Item* item) {
   if (POLICY == PoolPolicy::Reconstruct) {
     item->destruct();
   }
-  {
-    marl::lock lock(mutex);
-    item->next = free;
-    free = item;
-  }
-  returned.notify_one();
+  this->put(item);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -347,6 +715,9 @@ class UnboundedPool : public Pool<T> {
 
   MARL_NO_EXPORT inline UnboundedPool(
       Allocator* allocator = Allocator::Default);
+  MARL_NO_EXPORT inline UnboundedPool(const UnboundedPool&);
+  MARL_NO_EXPORT inline ~UnboundedPool();
+  MARL_NO_EXPORT inline UnboundedPool& operator=(const UnboundedPool&);
 
   // borrow() borrows a single item from the pool, automatically allocating
   // more items if the pool is empty.
@@ -372,19 +743,25 @@ class UnboundedPool : public Pool<T> {
     MARL_NO_EXPORT inline Storage(const Storage&) = delete;
     MARL_NO_EXPORT inline Storage& operator=(const Storage&) = delete;
 
+    // take() takes a free item, allocating more items if the pool is empty.
+    MARL_NO_EXPORT inline Item* take();
+
+   protected:
+    MARL_NO_EXPORT inline void destroy() override;
+
+   private:
     Allocator* allocator;
-    marl::mutex mutex;
-    containers::vector<Item*, 4> items;
-    Item* free = nullptr;
+    containers::vector<Item*, 4> items;  // guarded by mutex
   };
 
-  Allocator* allocator;
-  std::shared_ptr<Storage> storage;
+  Storage* storage;
 };
 
 template <typename T, PoolPolicy POLICY>
 UnboundedPool<T, POLICY>::Storage::Storage(Allocator* allocator)
-    : allocator(allocator), items(allocator) {}
+    : Pool<T>::Storage(allocator, ~size_t(0)),
+      allocator(allocator),
+      items(allocator) {}
 
 template <typename T, PoolPolicy POLICY>
 UnboundedPool<T, POLICY>::Storage::~Storage() {
@@ -396,11 +773,58 @@ UnboundedPool<T, POLICY>::Storage::~Storage() {
   }
 }
 
+template <typename T, PoolPolicy POLICY>
+void UnboundedPool<T, POLICY>::Storage::destroy() {
+  allocator->destroy(this);
+}
+
+template <typename T, PoolPolicy POLICY>
+typename UnboundedPool<T, POLICY>::Item*
+UnboundedPool<T, POLICY>::Storage::take() {
+  if (auto item = this->takeCached()) {
+    return item;
+  }
+  marl::lock lock(this->mutex);
+  if (this->free == nullptr) {
+    auto count = std::max<size_t>(items.size(), 32);
+    for (size_t j = 0; j < count; j++) {
+      auto item = allocator->create<Item>();
+      if (POLICY == PoolPolicy::Preserve) {
+        item->construct();
+      }
+      item->storage = this;
+      items.push_back(item);
+      item->next = this->free;
+      this->free = item;
+    }
+  }
+  return this->takeSharedAndUnlock(lock);
+}
+
 template <typename T, PoolPolicy POLICY>
 UnboundedPool<T, POLICY>::UnboundedPool(
     Allocator* allocator /* = Allocator::Default */)
-    : allocator(allocator),
-      storage(allocator->make_shared<Storage>(allocator)) {}
+    : storage(allocator->create<Storage>(allocator)) {}
+
+template <typename T, PoolPolicy POLICY>
+UnboundedPool<T, POLICY>::UnboundedPool(const UnboundedPool& other)
+    : storage(other.storage) {
+  storage->acquire();
+}
+
+template <typename T, PoolPolicy POLICY>
+UnboundedPool<T, POLICY>::~UnboundedPool() {
+  storage->release();
+}
+
+template <typename T, PoolPolicy POLICY>
+UnboundedPool<T, POLICY>& UnboundedPool<T, POLICY>::operator=(
+    const UnboundedPool& other) {
+  other.storage->acquire();
+  storage->release();
+  storage = other.storage;
+  return *this;
+}
 
 template <typename T, PoolPolicy POLICY>
 Loan<T> UnboundedPool<T, POLICY>::borrow() const {
@@ -412,27 +836,12 @@ Loan<T> UnboundedPool<T, POLICY>::borrow() const {
 template <typename T, PoolPolicy POLICY>
 template <typename F>
 inline void UnboundedPool<T, POLICY>::borrow(size_t n, const F& f) const {
-  marl::lock lock(storage->mutex);
   for (size_t i = 0; i < n; i++) {
-    if (storage->free == nullptr) {
-      auto count = std::max<size_t>(storage->items.size(), 32);
-      for (size_t j = 0; j < count; j++) {
-        auto item = allocator->create<Item>();
-        if (POLICY == PoolPolicy::Preserve) {
-          item->construct();
-        }
-        storage->items.push_back(item);
-        item->next = storage->free;
-        storage->free = item;
-      }
-    }
-
-    auto item = storage->free;
-    storage->free = storage->free->next;
+    auto item = storage->take();
     if (POLICY == PoolPolicy::Reconstruct) {
       item->construct();
     }
-    f(std::move(Loan(item, storage)));
+    f(std::move(Loan(item)));
   }
 }
 
@@ -441,9 +850,7 @@ void UnboundedPool<T, POLICY>::Storage::return_(Item* item) {
   if (POLICY == PoolPolicy::Reconstruct) {
     item->destruct();
   }
-  marl::lock lock(mutex);
-  item->next = free;
-  free = item;
+  this->put(item);
 }
 
 }  // namespace marl
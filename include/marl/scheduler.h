@@ -16,6 +16,7 @@
 #define marl_scheduler_h
 
 #include "containers.h"
+#include "contentionprofiler.h"
 #include "debug.h"
 #include "deprecated.h"
 #include "export.h"
@@ -32,6 +33,7 @@
 #include <condition_variable>
 #include <functional>
 #include <thread>
+#include <vector>
 
 namespace marl {
 
@@ -45,12 +47,84 @@ class OSFiber;
 // Call setWorkerThreadCount() to spawn dedicated worker threads.
 class Scheduler {
   class Worker;
+  class CounterSampler;
 
  public:
   using TimePoint = std::chrono::system_clock::time_point;
   using Predicate = std::function<bool()>;
   using ThreadInitializer = std::function<void(int workerId)>;
 
+  class Fiber;
+
+  // Observer is an interface for receiving notifications of scheduler events,
+  // allowing external profilers to instrument the scheduler.
+  // All methods have empty default implementations, so implementations only
+  // need to override the events they are interested in.
+  // Observer methods are called on the scheduler's worker threads or on the
+  // thread that enqueues a task, possibly concurrently, and may be called with
+  // internal scheduler locks held. Implementations must be thread-safe, and
+  // must not block or call back into the scheduler.
+  class Observer {
+   public:
+    virtual ~Observer() {}
+
+    // onTaskEnqueued() is called when task is enqueued on the scheduler.
+    virtual void onTaskEnqueued(const Task& task) { (void)task; }
+
+    // onTaskBegin() is called on the worker thread just before task is run on
+    // fiber.
+    virtual void onTaskBegin(const Fiber* fiber, const Task& task) {
+      (void)fiber;
+      (void)task;
+    }
+
+    // onTaskEnd() is called on the worker thread just after task has run on
+    // fiber.
+    virtual void onTaskEnd(const Fiber* fiber, const Task& task) {
+      (void)fiber;
+      (void)task;
+    }
+
+    // onFiberCreated() is called when the worker with the given identifier
+    // creates a new fiber.
+    virtual void onFiberCreated(uint32_t workerId, const Fiber* fiber) {
+      (void)workerId;
+      (void)fiber;
+    }
+
+    // onFiberSwitch() is called on the worker thread just before execution
+    // switches from one fiber to another.
+    virtual void onFiberSwitch(const Fiber* from, const Fiber* to) {
+      (void)from;
+      (void)to;
+    }
+
+    // onFiberSuspend() is called when fiber blocks in a wait.
+    virtual void onFiberSuspend(const Fiber* fiber) { (void)fiber; }
+
+    // onFiberResume() is called when fiber resumes execution after a wait.
+    virtual void onFiberResume(const Fiber* fiber) { (void)fiber; }
+
+    // onStealSucceeded() is called when the worker with the given identifier
+    // steals task from another worker.
+    virtual void onStealSucceeded(uint32_t workerId, const Task& task) {
+      (void)workerId;
+      (void)task;
+    }
+
+    // onStealFailed() is called when the worker with the given identifier
+    // fails to steal a task from another worker.
+    virtual void onStealFailed(uint32_t workerId) { (void)workerId; }
+
+    // onWorkerPark() is called when the worker with the given identifier
+    // blocks its thread waiting for new work.
+    virtual void onWorkerPark(uint32_t workerId) { (void)workerId; }
+
+    // onWorkerUnpark() is called when the worker with the given identifier
+    // wakes after being parked.
+    virtual void onWorkerUnpark(uint32_t workerId) { (void)workerId; }
+  };
+
   // Config holds scheduler configuration settings that can be passed to the
   // Scheduler constructor.
   struct Config {
@@ -78,6 +152,34 @@ class Scheduler {
     // allocation granularity for the given platform.
     size_t fiberStackSize = DefaultFiberStackSize;
 
+    // Interval at which the load of each worker thread is sampled and
+    // recorded as trace counter events while tracing is enabled.
+    // Zero disables sampling.
+    std::chrono::microseconds counterSampleInterval{0};
+
+    // Observer notified of scheduler events, or nullptr for none.
+    std::shared_ptr<Observer> observer;
+
+    // If true, the time spent executing each fiber and each task tag is
+    // accounted. See Fiber::cpuTime() and Scheduler::cpuTime().
+    // Accounting reads the CycleClock on each fiber switch and around each
+    // task, so is disabled by default.
+    bool taskAccounting = false;
+
+    // Fair-share weights of the task classes, indexed by Task::Tag. Tasks
+    // with a tag outside of the weights belong to class 0.
+    // If not empty, each worker divides its time between the classes with
+    // queued tasks in proportion to their weights, by running the task of the
+    // class with the lowest virtual time (time run divided by weight). Workers
+    // steal the task of the class with their own lowest virtual time.
+    // Fair-share scheduling enables task accounting.
+    // If empty, tasks are run in the order they were enqueued.
+    std::vector<uint32_t> fairShareWeights;
+
+    // Profiler of the time fibers spend suspended on synchronization
+    // primitives, or nullptr for none. See ContentionProfiler.
+    std::shared_ptr<ContentionProfiler> contentionProfiler;
+
     // allCores() returns a Config with a worker thread for each of the logical
     // cpus available to the process.
     MARL_EXPORT
@@ -91,6 +193,14 @@ class Scheduler {
         const ThreadInitializer&);
     MARL_NO_EXPORT inline Config& setWorkerThreadAffinityPolicy(
         const std::shared_ptr<Thread::Affinity::Policy>&);
+    MARL_NO_EXPORT inline Config& setCounterSampleInterval(
+        std::chrono::microseconds);
+    MARL_NO_EXPORT inline Config& setObserver(const std::shared_ptr<Observer>&);
+    MARL_NO_EXPORT inline Config& setTaskAccounting(bool);
+    MARL_NO_EXPORT inline Config& setFairShareWeights(
+        const std::vector<uint32_t>&);
+    MARL_NO_EXPORT inline Config& setContentionProfiler(
+        const std::shared_ptr<ContentionProfiler>&);
   };
 
   // Constructor.
@@ -122,10 +232,59 @@ class Scheduler {
   MARL_EXPORT
   void enqueue(Task&& task);
 
+  // enqueue() queues the task for asynchronous execution on the worker thread
+  // with the identifier workerId. Worker threads with no work of their own may
+  // still steal the task. If workerId is not in the range
+  // [0, config().workerThread.count), the task is enqueued as if by
+  // enqueue(Task&&).
+  MARL_EXPORT
+  void enqueue(Task&& task, int workerId);
+
+  // enqueue() queues the task for asynchronous execution once the deadline
+  // has been reached. The task is held by the calling worker thread if it
+  // belongs to this scheduler, otherwise by another of the worker threads,
+  // or by the calling thread's single-threaded worker if the scheduler has no
+  // worker threads. The worker does not stop until the task has been run. No
+  // thread or fiber is blocked waiting for the deadline.
+  MARL_EXPORT
+  void enqueue(Task&& task, const TimePoint& deadline);
+
+  // currentWorkerId() returns the identifier of the worker thread that is
+  // calling, in the range [0, config().workerThread.count), or -1 if the
+  // calling thread is not a worker thread.
+  MARL_EXPORT
+  static int currentWorkerId();
+
   // config() returns the Config that was used to build the scheduler.
   MARL_EXPORT
   const Config& config() const;
 
+  // TaskStats holds the accounting statistics of the tasks with a given tag.
+  struct TaskStats {
+    // The number of tasks that have finished running.
+    uint64_t tasks = 0;
+
+    // The time spent executing the tasks.
+    std::chrono::nanoseconds cpuTime = std::chrono::nanoseconds(0);
+
+    // The time between the tasks being enqueued and starting to run.
+    std::chrono::nanoseconds queueTime = std::chrono::nanoseconds(0);
+
+    // The time the tasks spent suspended, blocked in a wait.
+    std::chrono::nanoseconds blockedTime = std::chrono::nanoseconds(0);
+  };
+
+  // taskStats() returns the statistics of the tasks with the given tag run on
+  // all of the scheduler's workers, including workers of threads that have
+  // since been unbound. The per-worker statistics are merged on each call.
+  // Returns zeroed statistics unless Config::taskAccounting is enabled.
+  MARL_EXPORT
+  TaskStats taskStats(Task::Tag tag);
+
+  // cpuTime() returns taskStats(tag).cpuTime.
+  MARL_EXPORT
+  std::chrono::nanoseconds cpuTime(Task::Tag tag);
+
   // Fibers expose methods to perform cooperative multitasking and are
   // automatically created by the Scheduler.
   //
@@ -217,6 +376,20 @@ class Scheduler {
     MARL_EXPORT
     void notify();
 
+    // cpuTime() returns the total time the Fiber has spent executing on its
+    // worker's thread. Time the thread spends parked waiting for work is
+    // excluded, but time the thread is preempted by the OS is not.
+    // Returns 0 unless Config::taskAccounting is enabled.
+    MARL_EXPORT
+    std::chrono::nanoseconds cpuTime() const;
+
+    // setBlocker() sets the synchronization primitive that the following
+    // waits of this Fiber are blocked on, as reported to the
+    // Config::contentionProfiler. object identifies the primitive instance,
+    // and kind is the name of its type. Pass nullptrs to clear the blocker.
+    // setBlocker() must only be called on the currently executing fiber.
+    MARL_NO_EXPORT inline void setBlocker(const void* object, const char* kind);
+
     // id is the thread-unique identifier of the Fiber.
     uint32_t const id;
 
@@ -272,6 +445,22 @@ class Scheduler {
     Allocator::unique_ptr<OSFiber> const impl;
     Worker* const worker;
     State state = State::Running;  // Guarded by Worker's work.mutex.
+    // The trace flow from notify() to resumption. Guarded by Worker's
+    // work.mutex.
+    uint64_t flow = 0;
+    // The CycleClock ticks spent executing this fiber. Only written by the
+    // worker's thread.
+    std::atomic<uint64_t> cpuTicks = {0};
+    // The task currently running on this fiber, or nullptr. Only accessed by
+    // the worker's thread.
+    const Task* task = nullptr;
+    // The CycleClock ticks when the fiber was last suspended. Only accessed
+    // by the worker's thread.
+    uint64_t suspendedTicks = 0;
+    // The synchronization primitive the fiber is blocked on, and the name of
+    // its type. Only accessed by the worker's thread.
+    const void* blocker = nullptr;
+    const char* blockerKind = nullptr;
   };
 
  private:
@@ -283,6 +472,21 @@ class Scheduler {
   // Maximum number of worker threads.
   static constexpr size_t MaxWorkerThreads = 256;
 
+  // TagStats holds the statistics of tasks with the same tag, accumulated by
+  // a single worker. Each field is only written by the worker's thread, and
+  // is read by other threads when merging the tables of all workers.
+  struct TagStats {
+    std::atomic<uint64_t> tasks = {0};
+    std::atomic<uint64_t> cpuTicks = {0};
+    std::atomic<uint64_t> queueTicks = {0};
+    std::atomic<uint64_t> blockedTicks = {0};
+
+    // mergeInto() adds these statistics to other, which must only be written
+    // by the calling thread.
+    inline void mergeInto(TagStats& other) const;
+  };
+  using TagTable = std::array<TagStats, Task::NumTags>;
+
   // WaitingFibers holds all the fibers waiting on a timeout.
   struct WaitingFibers {
     inline WaitingFibers(Allocator*);
@@ -317,9 +521,82 @@ class Scheduler {
     containers::unordered_map<Fiber*, TimePoint> fibers;
   };
 
+  // DelayedTasks holds the tasks that are waiting for a deadline before they
+  // are enqueued.
+  struct DelayedTasks {
+    inline DelayedTasks(Allocator*);
+
+    // operator bool() returns true iff there are any delayed tasks.
+    inline operator bool() const;
+
+    // take() assigns the task with the earliest deadline to out and returns
+    // true if that deadline is at or before now, otherwise returns false.
+    inline bool take(const TimePoint& now, Task& out);
+
+    // next() returns the earliest deadline of the tasks.
+    // next() can only be called if operator bool() returns true.
+    inline TimePoint next() const;
+
+    // add() adds the task to be enqueued once deadline has been reached.
+    inline void add(const TimePoint& deadline, Task&& task);
+
+   private:
+    struct Delayed {
+      TimePoint deadline;
+      Task task;
+    };
+
+    // later() orders the heap of tasks with the earliest deadline first.
+    static inline bool later(const Delayed& a, const Delayed& b);
+
+    containers::vector<Delayed, 8> heap;
+  };
+
+  // VirtualTimes holds the fair-share virtual time of each task class for a
+  // single worker. Only accessed by the worker's thread.
+  struct VirtualTimes {
+    inline VirtualTimes(Allocator*, const std::vector<uint32_t>& weights);
+
+    // charge() advances the virtual time of the class by the ticks the class
+    // has run for, divided by the class weight.
+    inline void charge(size_t cls, uint64_t ticks);
+
+    containers::vector<double, 8> times;  // Virtual time of each class.
+    containers::vector<double, 8> costs;  // Reciprocal of each class weight.
+    double now = 0;  // Virtual time of the most recently selected class.
+  };
+
+  // TaskQueue holds the tasks enqueued on a worker, in a FIFO queue for each
+  // fair-share class. Without fair-share weights there is a single class.
   // TODO: Implement a queue that recycles elements to reduce number of
   // heap allocations.
-  using TaskQueue = containers::deque<Task>;
+  class TaskQueue {
+   public:
+    inline TaskQueue(Allocator*, size_t numClasses);
+
+    // classOf() returns the fair-share class of the task.
+    inline size_t classOf(const Task& task) const;
+
+    // empty() returns true if there are no queued tasks.
+    inline bool empty() const;
+
+    // size() returns the number of queued tasks.
+    inline size_t size() const;
+
+    // push() appends the task to the queue of its class.
+    inline void push(Task&& task);
+
+    // take() removes the front task of the class with the lowest virtual time
+    // in times, and assigns it to out. If stealing is true, tasks with the
+    // SameThread flag are not taken. times must be non-null if there is more
+    // than one class. Returns false if no task was taken.
+    inline bool take(Task& out, VirtualTimes* times, bool stealing);
+
+   private:
+    containers::vector<containers::deque<Task>, 1> classes;
+    size_t count = 0;
+  };
+
   using FiberQueue = containers::deque<Fiber*>;
   using FiberSet = containers::unordered_set<Fiber*>;
 
@@ -369,6 +646,10 @@ class Scheduler {
     // enqueue(Task&&) enqueues a new, unstarted task.
     void enqueue(Task&& task) EXCLUDES(work.mutex);
 
+    // enqueue(Task&&, const TimePoint&) enqueues a new, unstarted task once
+    // the deadline has been reached.
+    void enqueue(Task&& task, const TimePoint& deadline) EXCLUDES(work.mutex);
+
     // tryLock() attempts to lock the worker for task enqueuing.
     // If the lock was successful then true is returned, and the caller must
     // call enqueueAndUnlock().
@@ -383,9 +664,9 @@ class Scheduler {
     // and shutdown is true, upon runUntilShutdown() returns.
     void runUntilShutdown() REQUIRES(work.mutex);
 
-    // steal() attempts to steal a Task from the worker for another worker.
+    // steal() attempts to steal a Task from the worker for the thief worker.
     // Returns true if a task was taken and assigned to out, otherwise false.
-    bool steal(Task& out) EXCLUDES(work.mutex);
+    bool steal(Worker* thief, Task& out) EXCLUDES(work.mutex);
 
     // getCurrent() returns the Worker currently bound to the current
     // thread.
@@ -397,7 +678,12 @@ class Scheduler {
     // Unique identifier of the Worker.
     const uint32_t id;
 
+    // Statistics of the tasks run by this worker, indexed by tag.
+    TagTable tags;
+
    private:
+    friend class CounterSampler;
+
     // run() is the task processing function for the worker.
     // run() processes tasks until stop() is called.
     void run() REQUIRES(work.mutex);
@@ -427,6 +713,20 @@ class Scheduler {
     // waiting.
     void enqueueFiberTimeouts() REQUIRES(work.mutex);
 
+    // enqueueDelayedTasks() enqueues all the delayed tasks that have reached
+    // their deadlines.
+    void enqueueDelayedTasks() REQUIRES(work.mutex);
+
+    // account() charges the time elapsed since the last call to the current
+    // fiber, and to the tag of the task that the fiber is running, if any.
+    // Does nothing if task accounting is disabled.
+    inline void account();
+
+    // beginTask() and endTask() account the start and end of running task on
+    // the current fiber, and set the fiber's running task.
+    inline void beginTask(const Task& task);
+    inline void endTask();
+
     inline void changeFiberState(Fiber* fiber,
                                  Fiber::State from,
                                  Fiber::State to) const REQUIRES(work.mutex);
@@ -436,16 +736,17 @@ class Scheduler {
 
     // Work holds tasks and fibers that are enqueued on the Worker.
     struct Work {
-      inline Work(Allocator*);
+      inline Work(Allocator*, size_t numClasses);
 
       std::atomic<uint64_t> num = {0};  // tasks.size() + fibers.size()
       GUARDED_BY(mutex) uint64_t numBlockedFibers = 0;
       GUARDED_BY(mutex) TaskQueue tasks;
       GUARDED_BY(mutex) FiberQueue fibers;
       GUARDED_BY(mutex) WaitingFibers waiting;
+      GUARDED_BY(mutex) DelayedTasks delayed;
       GUARDED_BY(mutex) bool notifyAdded = true;
       std::condition_variable added;
-      marl::mutex mutex;
+      marl::mutex mutex{"marl::Scheduler::Worker::Work"};
 
       template <typename F>
       inline void wait(F&&) REQUIRES(mutex);
@@ -470,8 +771,16 @@ class Scheduler {
 
     Mode const mode;
     Scheduler* const scheduler;
+    Observer* const observer;  // Copied from the config to avoid indirection.
+    const bool accounting;     // Copied from the config to avoid indirection.
     Allocator::unique_ptr<Fiber> mainFiber;
     Fiber* currentFiber = nullptr;
+    uint64_t lastAccounted = 0;  // CycleClock ticks at the last account().
+    VirtualTimes virtualTimes;
+    VirtualTimes* const fairShare;  // &virtualTimes, or nullptr if disabled.
+    ContentionProfiler* const contention;  // Copied from the config.
+    ContentionProfiler::Table* const contentionTable;  // Of contention.
+    uint32_t contentionSamples = 0;  // Waits since the last sampled wait.
     Thread thread;
     Work work;
     FiberSet idleFibers;  // Fibers that have completed which can be reused.
@@ -479,8 +788,22 @@ class Scheduler {
         workerFibers;  // All fibers created by this worker.
     FastRnd rng;
     bool shutdown = false;
+
+    // Load counters sampled by the CounterSampler. Only written by the
+    // worker's thread.
+    struct Counters {
+      std::atomic<uint32_t> blockedFibers = {0};
+      std::atomic<uint32_t> idleFibers = {0};
+      std::atomic<bool> spinning = {false};
+      std::atomic<bool> parked = {false};
+    };
+    Counters counters;
   };
 
+  // prepareEnqueue() prepares the task for being enqueued, notifying the
+  // observer.
+  inline void prepareEnqueue(Task& task);
+
   // stealWork() attempts to steal a task from the worker with the given id.
   // Returns true if a task was stolen and assigned to out, otherwise false.
   bool stealWork(Worker* thief, uint64_t from, Task& out);
@@ -505,15 +828,21 @@ class Scheduler {
   std::atomic<unsigned int> nextEnqueueIndex = {0};
   std::array<Worker*, MaxWorkerThreads> workerThreads;
 
+  // Emits trace counters for the worker threads, if enabled by the config.
+  CounterSampler* counterSampler = nullptr;
+
   struct SingleThreadedWorkers {
     inline SingleThreadedWorkers(Allocator*);
 
     using WorkerByTid =
         containers::unordered_map<std::thread::id,
                                   Allocator::unique_ptr<Worker>>;
-    marl::mutex mutex;
+    marl::mutex mutex{"marl::Scheduler::SingleThreadedWorkers"};
     GUARDED_BY(mutex) std::condition_variable unbind;
     GUARDED_BY(mutex) WorkerByTid byTid;
+    // Statistics accumulated by single threaded workers that have been
+    // unbound.
+    GUARDED_BY(mutex) TagTable retiredTags;
   };
   SingleThreadedWorkers singleThreadedWorkers;
 };
@@ -548,6 +877,35 @@ Scheduler::Config& Scheduler::Config::setWorkerThreadAffinityPolicy(
   return *this;
 }
 
+Scheduler::Config& Scheduler::Config::setCounterSampleInterval(
+    std::chrono::microseconds interval) {
+  counterSampleInterval = interval;
+  return *this;
+}
+
+Scheduler::Config& Scheduler::Config::setObserver(
+    const std::shared_ptr<Observer>& o) {
+  observer = o;
+  return *this;
+}
+
+Scheduler::Config& Scheduler::Config::setTaskAccounting(bool enabled) {
+  taskAccounting = enabled;
+  return *this;
+}
+
+Scheduler::Config& Scheduler::Config::setFairShareWeights(
+    const std::vector<uint32_t>& weights) {
+  fairShareWeights = weights;
+  return *this;
+}
+
+Scheduler::Config& Scheduler::Config::setContentionProfiler(
+    const std::shared_ptr<ContentionProfiler>& profiler) {
+  contentionProfiler = profiler;
+  return *this;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // Scheduler::Fiber
 ////////////////////////////////////////////////////////////////////////////////
@@ -566,6 +924,11 @@ void Scheduler::Fiber::wait() {
   worker->wait(nullptr);
 }
 
+void Scheduler::Fiber::setBlocker(const void* object, const char* kind) {
+  blocker = object;
+  blockerKind = kind;
+}
+
 template <typename Clock, typename Duration>
 bool Scheduler::Fiber::wait(
     const std::chrono::time_point<Clock, Duration>& timeout) {
@@ -0,0 +1,169 @@
+// Copyright 2026 The Marl Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef marl_select_h
+#define marl_select_h
+
+#include "debug.h"
+#include "waiter.h"
+
+#include <array>
+#include <chrono>
+
+namespace marl {
+
+namespace detail {
+
+// SelectCase holds the per-case state of a single select() call.
+struct SelectCase {
+  Selectable* selectable = nullptr;
+  WaitList::Node node;
+  // True if the case's object notified the waiter, and tryComplete() has not
+  // been called since.
+  bool notified = false;
+};
+
+// selectCases() implements select(). wait(waiter) blocks until the waiter is
+// notified, and returns false if the wait has timed out.
+template <typename Wait>
+MARL_NO_EXPORT inline int selectCases(SelectCase* cases,
+                                      int count,
+                                      const Wait& wait) {
+  for (int i = 0; i < count; i++) {
+    if (cases[i].selectable->tryComplete()) {
+      return i;
+    }
+  }
+
+  // Add the waiter to every object before trying the cases again, so that an
+  // object that becomes ready after the failed attempt notifies the waiter.
+  Waiter waiter(cases, "marl::select");
+  for (;;) {
+    for (int i = 0; i < count; i++) {
+      cases[i].selectable->add(cases[i].node, waiter);
+    }
+    int completed = -1;
+    for (int i = 0; i < count && completed < 0; i++) {
+      cases[i].notified = false;
+      if (cases[i].selectable->tryComplete()) {
+        completed = i;
+      }
+    }
+    bool timedOut = completed < 0 && !wait(waiter);
+
+    bool notified = false;
+    for (int i = 0; i < count; i++) {
+      if (!cases[i].selectable->remove(cases[i].node)) {
+        cases[i].notified = true;
+        notified = true;
+      }
+    }
+    if (completed >= 0 || (timedOut && !notified)) {
+      // Pass on the notifications this call will not act on.
+      for (int i = 0; i < count; i++) {
+        if (cases[i].notified && i != completed) {
+          cases[i].selectable->notifyNext();
+        }
+      }
+      return completed;
+    }
+    waiter.reset();
+  }
+}
+
+// SelectBlock waits on a Waiter without a timeout.
+struct SelectBlock {
+  MARL_NO_EXPORT inline bool operator()(Waiter& waiter) const {
+    waiter.wait();
+    return true;
+  }
+};
+
+// SelectUntil waits on a Waiter until a timeout.
+template <typename Clock, typename Duration>
+struct SelectUntil {
+  MARL_NO_EXPORT inline bool operator()(Waiter& waiter) const {
+    return waiter.wait_until(timeout);
+  }
+  const std::chrono::time_point<Clock, Duration>& timeout;
+};
+
+}  // namespace detail
+
+// select() blocks until one of the cases completes, and returns the index of
+// the completed case. Exactly one case is completed per call. If more than
+// one case can complete, the case with the lowest index is completed.
+//
+// A single waiter is added to the objects of all the cases, and is removed
+// from all of them before select() returns. select() does not allocate
+// memory or schedule tasks.
+//
+// Example:
+//
+//   int data;
+//   bool dataOk;
+//   Control control;
+//   bool controlOk;
+//   switch (marl::select(dataChannel.onRecv(data, dataOk),
+//                        controlChannel.onRecv(control, controlOk),
+//                        shutdown.onSignal())) {
+//     case 0: ...
+//     case 1: ...
+//     case 2: ...
+//   }
+template <typename... Cases>
+MARL_NO_EXPORT inline int select(Cases&&... cases) {
+  static_assert(sizeof...(Cases) > 0, "select() requires at least one case");
+  std::array<detail::SelectCase, sizeof...(Cases)> state;
+  Selectable* selectables[] = {&cases...};
+  for (size_t i = 0; i < state.size(); i++) {
+    state[i].selectable = selectables[i];
+  }
+  return detail::selectCases(state.data(), static_cast<int>(state.size()),
+                             detail::SelectBlock{});
+}
+
+// select_until() blocks until one of the cases completes, or the timeout has
+// been reached. Returns the index of the completed case, or -1 if the timeout
+// was reached. See select().
+template <typename Clock, typename Duration, typename... Cases>
+MARL_NO_EXPORT inline int select_until(
+    const std::chrono::time_point<Clock, Duration>& timeout,
+    Cases&&... cases) {
+  static_assert(sizeof...(Cases) > 0,
+                "select_until() requires at least one case");
+  std::array<detail::SelectCase, sizeof...(Cases)> state;
+  Selectable* selectables[] = {&cases...};
+  for (size_t i = 0; i < state.size(); i++) {
+    state[i].selectable = selectables[i];
+  }
+  return detail::selectCases(state.data(), static_cast<int>(state.size()),
+                             detail::SelectUntil<Clock, Duration>{timeout});
+}
+
+// select_for() blocks until one of the cases completes, or the duration has
+// elapsed. Returns the index of the completed case, or -1 if the duration
+// elapsed. See select().
+template <typename Rep, typename Period, typename... Cases>
+MARL_NO_EXPORT inline int select_for(
+    const std::chrono::duration<Rep, Period>& duration,
+    Cases&&... cases) {
+  return select_until(std::chrono::system_clock::now() + duration,
+                      std::forward<Cases>(cases)...);
+}
+
+}  // namespace marl
+
+#endif  // marl_select_h
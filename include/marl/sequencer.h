@@ -0,0 +1,466 @@
+// Copyright 2026 The Marl Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef marl_sequencer_h
+#define marl_sequencer_h
+
+#include "conditionvariable.h"
+#include "containers.h"
+#include "debug.h"
+#include "memory.h"
+#include "scheduler.h"
+
+#include <atomic>
+
+namespace marl {
+
+// Sequencer is a lock-free alternative to Ticket::Queue, used to serially
+// order execution.
+//
+// Sequencer::Tickets have the same semantics as marl::Ticket: the first ticket
+// taken is in the 'called' state, each subsequent ticket is called once all
+// the tickets taken before it are finished, and dropping the last reference
+// to an unfinished ticket automatically calls done().
+//
+// Each ticket is assigned a monotonically increasing sequence number, and its
+// state is held in a fixed-size ring of slots. Taking, calling and finishing
+// tickets only use atomic operations. A mutex is only locked when a ticket has
+// to block in wait(), or has callbacks registered with onCall().
+//
+// Unlike Ticket::Queue, the number of outstanding tickets is bounded by the
+// capacity of the ring. A ticket's slot is recycled once the ticket has been
+// finished, all tickets before it have been finished, and all references to
+// the ticket have been dropped. take() blocks while the slot for the next
+// ticket is still in use.
+//
+// Example:
+//
+//  void runTasksConcurrentThenSerially(int numConcurrentTasks)
+//  {
+//      marl::Sequencer sequencer;
+//      for (int i = 0; i < numConcurrentTasks; i++)
+//      {
+//          auto ticket = sequencer.take();
+//          marl::schedule([=] {
+//              doConcurrentWork(); // <- function may be called concurrently
+//              ticket.wait(); // <- serialize tasks
+//              doSerialWork(); // <- function will not be called concurrently
+//              ticket.done(); // <- optional, as done() is called implicitly on
+//                             // dropping of last reference
+//          });
+//      }
+//  }
+class Sequencer {
+  struct Shared;
+  struct Slot;
+
+ public:
+  using OnCall = std::function<void()>;
+
+  // The default number of slots in the ring.
+  static constexpr size_t DefaultCapacity = 256;
+
+  // Ticket is a position in the sequence, handed out by Sequencer::take().
+  class Ticket {
+   public:
+    MARL_NO_EXPORT inline Ticket() = default;
+    MARL_NO_EXPORT inline Ticket(const Ticket& other);
+    MARL_NO_EXPORT inline Ticket(Ticket&& other);
+    MARL_NO_EXPORT inline ~Ticket();
+    MARL_NO_EXPORT inline Ticket& operator=(const Ticket& other);
+    MARL_NO_EXPORT inline Ticket& operator=(Ticket&& other);
+
+    // wait() blocks until the ticket is called.
+    MARL_NO_EXPORT inline void wait() const;
+
+    // done() marks the ticket as finished and calls the next ticket.
+    MARL_NO_EXPORT inline void done() const;
+
+    // onCall() registers the function f to be invoked when this ticket is
+    // called. If the ticket is already called prior to calling onCall(), then
+    // f() will be executed immediately.
+    // F must be a function of the OnCall signature.
+    template <typename F>
+    MARL_NO_EXPORT inline void onCall(F&& f) const;
+
+   private:
+    friend class Sequencer;
+
+    MARL_NO_EXPORT inline Ticket(Shared* shared, uint64_t seq);
+
+    // reset() drops this reference to the ticket.
+    MARL_NO_EXPORT inline void reset();
+
+    Shared* shared = nullptr;
+    uint64_t seq = 0;
+  };
+
+  // Constructs a Sequencer with a ring of at least capacity slots.
+  MARL_NO_EXPORT inline Sequencer(size_t capacity = DefaultCapacity,
+                                  Allocator* allocator = Allocator::Default);
+  MARL_NO_EXPORT inline Sequencer(const Sequencer& other);
+  MARL_NO_EXPORT inline ~Sequencer();
+  MARL_NO_EXPORT inline Sequencer& operator=(const Sequencer& other);
+
+  // take() returns a single ticket from the sequencer.
+  MARL_NO_EXPORT inline Ticket take();
+
+  // take() retrieves count tickets from the sequencer, calling f() with each
+  // retrieved ticket.
+  // F must be a function of the signature: void(Ticket&&)
+  template <typename F>
+  MARL_NO_EXPORT inline void take(size_t count, const F& f);
+
+ private:
+  // Slot holds the state of a single ticket.
+  struct Slot {
+    MARL_NO_EXPORT inline Slot(Allocator* allocator, uint64_t seq);
+
+    // The sequence number of the next ticket that may claim this slot.
+    std::atomic<uint64_t> ready;
+    // One more than the sequence number of the last finished ticket.
+    std::atomic<uint64_t> finished = {0};
+    // Number of Ticket references to the owning ticket.
+    std::atomic<uint32_t> handles = {0};
+    // Number of holders of the slot: one for all the Ticket references, and
+    // one for the sequencer until the ticket has been passed.
+    std::atomic<uint32_t> pins = {0};
+    // Number of waiting fibers and registered callbacks.
+    std::atomic<uint32_t> interest = {0};
+    std::atomic<bool> isDone = {false};
+
+    marl::mutex mutex;
+    ConditionVariable isCalledCondVar;
+    // Callbacks registered with onCall(), tagged with the ticket's sequence
+    // number. Guarded by mutex.
+    containers::vector<std::pair<uint64_t, OnCall>, 1> onCall;
+  };
+
+  // Data shared between the sequencer and all tickets.
+  struct Shared {
+    MARL_NO_EXPORT inline Shared(Allocator* allocator, size_t capacity);
+    MARL_NO_EXPORT inline ~Shared();
+
+    // roundUpToPowerOfTwo() returns the smallest power of two not less than n.
+    MARL_NO_EXPORT static inline uint64_t roundUpToPowerOfTwo(uint64_t n);
+
+    // slot() returns the slot for the ticket with the given sequence number.
+    MARL_NO_EXPORT inline Slot& slot(uint64_t seq);
+
+    // claim() blocks until the slot for seq is free, then initializes it.
+    MARL_NO_EXPORT inline void claim(uint64_t seq);
+
+    // finish() marks the ticket as finished and advances the sequence.
+    MARL_NO_EXPORT inline void finish(uint64_t seq);
+
+    // call() wakes the waiters and schedules the callbacks of seq.
+    MARL_NO_EXPORT inline void call(uint64_t seq);
+
+    // unpin() drops a hold on the slot of seq, recycling the slot when there
+    // are no more holders.
+    MARL_NO_EXPORT inline void unpin(uint64_t seq);
+
+    // unref() drops a reference to the Shared, destructing it when there are
+    // no more references.
+    MARL_NO_EXPORT inline void unref();
+
+    Allocator* const allocator;
+    const uint64_t capacity;  // Always a power of two.
+    Slot* slots = nullptr;
+
+    std::atomic<uint64_t> head = {0};     // Sequence number of the next take.
+    std::atomic<uint64_t> serving = {0};  // Sequence number of called ticket.
+    std::atomic<uint32_t> refs = {1};     // Sequencers and claimed slots.
+    std::atomic<uint32_t> numClaimWaiting = {0};
+
+    marl::mutex mutex;
+    ConditionVariable released;
+  };
+
+  Shared* shared;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Sequencer::Ticket
+////////////////////////////////////////////////////////////////////////////////
+
+Sequencer::Ticket::Ticket(Shared* shared, uint64_t seq)
+    : shared(shared), seq(seq) {}
+
+Sequencer::Ticket::Ticket(const Ticket& other)
+    : shared(other.shared), seq(other.seq) {
+  if (shared != nullptr) {
+    shared->slot(seq).handles++;
+  }
+}
+
+Sequencer::Ticket::Ticket(Ticket&& other)
+    : shared(other.shared), seq(other.seq) {
+  other.shared = nullptr;
+}
+
+Sequencer::Ticket::~Ticket() {
+  reset();
+}
+
+Sequencer::Ticket& Sequencer::Ticket::operator=(const Ticket& other) {
+  if (other.shared != nullptr) {
+    other.shared->slot(other.seq).handles++;
+  }
+  reset();
+  shared = other.shared;
+  seq = other.seq;
+  return *this;
+}
+
+Sequencer::Ticket& Sequencer::Ticket::operator=(Ticket&& other) {
+  if (this != &other) {
+    reset();
+    shared = other.shared;
+    seq = other.seq;
+    other.shared = nullptr;
+  }
+  return *this;
+}
+
+void Sequencer::Ticket::reset() {
+  if (shared == nullptr) {
+    return;
+  }
+  if (--shared->slot(seq).handles == 0) {
+    done();
+    shared->unpin(seq);
+  }
+  shared = nullptr;
+}
+
+void Sequencer::Ticket::wait() const {
+  MARL_ASSERT(shared != nullptr, "wait() called on null ticket");
+  if (shared->serving.load(std::memory_order_acquire) >= seq) {
+    return;
+  }
+  auto& slot = shared->slot(seq);
+  slot.interest++;
+  {
+    marl::lock lock(slot.mutex);
+    auto s = shared;
+    auto n = seq;
+    slot.isCalledCondVar.wait(lock, [s, n] { return s->serving >= n; });
+  }
+  slot.interest--;
+}
+
+void Sequencer::Ticket::done() const {
+  MARL_ASSERT(shared != nullptr, "done() called on null ticket");
+  if (shared->slot(seq).isDone.exchange(true)) {
+    return;
+  }
+  shared->finish(seq);
+}
+
+template <typename Function>
+void Sequencer::Ticket::onCall(Function&& f) const {
+  MARL_ASSERT(shared != nullptr, "onCall() called on null ticket");
+  auto& slot = shared->slot(seq);
+  slot.interest++;
+  {
+    marl::lock lock(slot.mutex);
+    if (shared->serving < seq) {
+      slot.onCall.emplace_back(
+          std::make_pair(seq, OnCall(std::forward<Function>(f))));
+      return;
+    }
+  }
+  slot.interest--;
+  marl::schedule(std::forward<Function>(f));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Sequencer
+////////////////////////////////////////////////////////////////////////////////
+
+Sequencer::Sequencer(size_t capacity /* = DefaultCapacity */,
+                     Allocator* allocator /* = Allocator::Default */)
+    : shared(allocator->create<Shared>(allocator, capacity)) {}
+
+Sequencer::Sequencer(const Sequencer& other) : shared(other.shared) {
+  shared->refs++;
+}
+
+Sequencer::~Sequencer() {
+  shared->unref();
+}
+
+Sequencer& Sequencer::operator=(const Sequencer& other) {
+  other.shared->refs++;
+  shared->unref();
+  shared = other.shared;
+  return *this;
+}
+
+Sequencer::Ticket Sequencer::take() {
+  Ticket out;
+  take(1, [&](Ticket&& ticket) { out = std::move(ticket); });
+  return out;
+}
+
+template <typename F>
+void Sequencer::take(size_t n, const F& f) {
+  if (n == 0) {
+    return;
+  }
+  auto first = shared->head.fetch_add(n);
+  shared->refs.fetch_add(static_cast<uint32_t>(n));
+  for (size_t i = 0; i < n; i++) {
+    shared->claim(first + i);
+    f(std::move(Ticket(shared, first + i)));
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Sequencer::Slot
+////////////////////////////////////////////////////////////////////////////////
+
+Sequencer::Slot::Slot(Allocator* allocator, uint64_t seq)
+    : ready(seq), isCalledCondVar(allocator), onCall(allocator) {}
+
+////////////////////////////////////////////////////////////////////////////////
+// Sequencer::Shared
+////////////////////////////////////////////////////////////////////////////////
+
+Sequencer::Shared::Shared(Allocator* allocator, size_t minCapacity)
+    : allocator(allocator),
+      capacity(roundUpToPowerOfTwo(minCapacity)),
+      released(allocator) {
+  Allocation::Request request;
+  request.size = sizeof(Slot) * capacity;
+  request.alignment = alignof(Slot);
+  request.usage = Allocation::Usage::Create;
+  slots = reinterpret_cast<Slot*>(allocator->allocate(request).ptr);
+  for (uint64_t i = 0; i < capacity; i++) {
+    new (&slots[i]) Slot(allocator, i);
+  }
+}
+
+Sequencer::Shared::~Shared() {
+  for (uint64_t i = 0; i < capacity; i++) {
+    slots[i].~Slot();
+  }
+  Allocation allocation;
+  allocation.ptr = slots;
+  allocation.request.size = sizeof(Slot) * capacity;
+  allocation.request.alignment = alignof(Slot);
+  allocation.request.usage = Allocation::Usage::Create;
+  allocator->free(allocation);
+}
+
+uint64_t Sequencer::Shared::roundUpToPowerOfTwo(uint64_t n) {
+  uint64_t out = 1;
+  while (out < n) {
+    out <<= 1;
+  }
+  return out;
+}
+
+Sequencer::Slot& Sequencer::Shared::slot(uint64_t seq) {
+  return slots[seq & (capacity - 1)];
+}
+
+void Sequencer::Shared::claim(uint64_t seq) {
+  auto& s = slot(seq);
+  if (s.ready.load(std::memory_order_acquire) != seq) {
+    // The ring is full. Wait for the previous owner to release the slot.
+    numClaimWaiting++;
+    {
+      marl::lock lock(mutex);
+      released.wait(lock, [&s, seq] { return s.ready == seq; });
+    }
+    numClaimWaiting--;
+  }
+  s.isDone.store(false, std::memory_order_relaxed);
+  s.handles.store(1, std::memory_order_relaxed);
+  s.pins.store(2, std::memory_order_release);
+}
+
+void Sequencer::Shared::finish(uint64_t seq) {
+  slot(seq).finished.store(seq + 1);
+  // Advance the sequence past all the consecutively finished tickets.
+  // Whichever of finish() or the preceding ticket's advance observes the
+  // other's store first continues the chain.
+  while (slot(seq).finished.load() == seq + 1) {
+    auto expected = seq;
+    if (!serving.compare_exchange_strong(expected, seq + 1)) {
+      return;  // A preceding ticket is still to be finished.
+    }
+    unpin(seq);
+    seq++;
+    call(seq);
+  }
+}
+
+void Sequencer::Shared::call(uint64_t seq) {
+  auto& s = slot(seq);
+  if (s.interest.load() == 0) {
+    return;
+  }
+  containers::vector<OnCall, 1> callbacks(allocator);
+  {
+    marl::lock lock(s.mutex);
+    // The slot may already be reused by a later ticket. Only take the
+    // callbacks registered for seq. The ticket may also have been finished
+    // between serving being advanced to seq and now, but its callbacks were
+    // registered before it was called, so they must still be dispatched.
+    size_t n = 0;
+    for (size_t i = 0; i < s.onCall.size(); i++) {
+      auto& entry = s.onCall[i];
+      if (entry.first != seq) {
+        if (n != i) {
+          s.onCall[n] = std::move(entry);
+        }
+        n++;
+      } else {
+        callbacks.emplace_back(std::move(entry.second));
+      }
+    }
+    s.interest -= static_cast<uint32_t>(s.onCall.size() - n);
+    s.onCall.resize(n);
+    s.isCalledCondVar.notify_all();
+  }
+  for (auto& callback : callbacks) {
+    marl::schedule(std::move(callback));
+  }
+}
+
+void Sequencer::Shared::unpin(uint64_t seq) {
+  auto& s = slot(seq);
+  if (--s.pins != 0) {
+    return;
+  }
+  s.ready.store(seq + capacity);
+  if (numClaimWaiting > 0) {
+    marl::lock lock(mutex);
+    released.notify_all();
+  }
+  unref();
+}
+
+void Sequencer::Shared::unref() {
+  if (--refs == 0) {
+    allocator->destroy(this);
+  }
+}
+
+}  // namespace marl
+
+#endif  // marl_sequencer_h
@@ -0,0 +1,161 @@
+// Copyright 2026 The Marl Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef marl_slab_allocator_h
+#define marl_slab_allocator_h
+
+#include "containers.h"
+#include "export.h"
+#include "memory.h"
+#include "mutex.h"
+#include "thread_local.h"
+
+#include <atomic>
+#include <thread>
+
+namespace marl {
+
+// SlabAllocator is an Allocator that serves small allocations from slabs of
+// memory carved into fixed size blocks, one set of slabs per size class.
+//
+// Each thread that uses the allocator claims its own cache of free blocks, so
+// that most allocations and frees require no synchronization. Blocks freed by
+// a thread are placed into the calling thread's cache, regardless of which
+// thread allocated them, and are moved back to the size class's shared free
+// list in batches once the cache is full. A thread's caches are flushed back
+// to the shared free lists and released when the thread exits. Threads beyond
+// the number of caches allocate and free directly from the shared free lists.
+//
+// Allocations that are larger than MaxBlockSize, have an alignment greater
+// than MaxBlockSize, or use guards (such as fiber stacks) are forwarded to the
+// parent allocator.
+//
+// SlabAllocator can be used as the Scheduler allocator with
+// Scheduler::Config::setAllocator().
+//
+// All allocations must be freed before the SlabAllocator is destructed.
+class SlabAllocator : public Allocator {
+ public:
+  // The largest allocation size in bytes served from slabs.
+  static constexpr size_t MaxBlockSize = 4096;
+
+  // Config holds the configuration of a SlabAllocator.
+  struct Config {
+    // The size in bytes of each slab allocated from the parent allocator.
+    size_t slabSize = 64 * 1024;
+
+    // The maximum number of free blocks held by each thread cache, per size
+    // class.
+    size_t cacheCapacity = 64;
+
+    // The maximum number of threads that can hold a cache at the same time.
+    // Caches are released when their threads exit.
+    // 0 means the larger of 64 and four times the number of logical CPUs.
+    size_t numCaches = 0;
+  };
+
+  // Constructs the SlabAllocator with the default configuration, allocating
+  // slabs and large allocations from parent.
+  MARL_EXPORT SlabAllocator(Allocator* parent = Allocator::Default);
+
+  // Constructs the SlabAllocator with the given configuration, allocating
+  // slabs and large allocations from parent.
+  MARL_EXPORT SlabAllocator(const Config& config,
+                            Allocator* parent = Allocator::Default);
+
+  MARL_EXPORT ~SlabAllocator();
+
+  // bytesReserved() returns the total number of bytes of slabs allocated from
+  // the parent allocator.
+  MARL_EXPORT size_t bytesReserved() const;
+
+  // Allocator compliance
+  MARL_EXPORT Allocation allocate(const Allocation::Request&) override;
+  MARL_EXPORT void free(const Allocation&) override;
+
+ private:
+  SlabAllocator(const SlabAllocator&) = delete;
+  SlabAllocator& operator=(const SlabAllocator&) = delete;
+
+  // Number of size classes.
+  static constexpr size_t NumClasses = 28;
+
+  // A free block.
+  struct Block {
+    Block* next;
+  };
+
+  // A singly linked list of free blocks.
+  struct BlockList {
+    Block* head = nullptr;
+    size_t count = 0;
+  };
+
+  // Cache holds free blocks for a single thread.
+  struct alignas(64) Cache {
+    std::atomic<std::thread::id> owner;  // Default id if unclaimed.
+    BlockList lists[NumClasses];
+  };
+
+  // SizeClass holds the free blocks shared by all threads for a single size
+  // class, and the slab currently being carved into blocks.
+  struct alignas(64) SizeClass {
+    marl::mutex mutex;
+    GUARDED_BY(mutex) BlockList free;
+    GUARDED_BY(mutex) uint8_t* next = nullptr;  // Next unused block in slab.
+    GUARDED_BY(mutex) uint8_t* end = nullptr;   // End of the current slab.
+  };
+
+  // classOf() returns the size class index for the request, or -1 if the
+  // request should be forwarded to the parent allocator.
+  MARL_NO_EXPORT int classOf(const Allocation::Request&) const;
+
+  // ThreadCaches holds the caches claimed by a thread, and releases them
+  // when the thread exits.
+  struct ThreadCaches;
+
+  // cache() returns the cache for the calling thread, or nullptr if all the
+  // caches have been claimed by other threads.
+  MARL_NO_EXPORT Cache* cache();
+
+  // releaseCache() moves the blocks of the calling thread's cache c back to
+  // the size classes, and releases c for other threads to claim.
+  MARL_NO_EXPORT void releaseCache(Cache* c);
+
+  // refill() takes up to count free blocks from the size class cls, allocating
+  // a new slab if there are no free blocks. The blocks are appended to out.
+  MARL_NO_EXPORT void refill(int cls, size_t count, BlockList& out);
+
+  // release() returns the list of free blocks to the size class cls.
+  MARL_NO_EXPORT void release(int cls, BlockList& list);
+
+  const Config config;
+  Allocator* const parent;
+  const uint64_t id;  // Unique for the lifetime of the process.
+  size_t numCaches = 0;
+  Cache* caches = nullptr;
+  SizeClass classes[NumClasses];
+
+  marl::mutex slabsMutex;
+  GUARDED_BY(slabsMutex) containers::vector<Allocation, 16> slabs;
+  std::atomic<size_t> reserved = {0};
+
+  // The cache last used by the calling thread. May refer to a cache of a
+  // different, or destructed, SlabAllocator.
+  MARL_DECLARE_THREAD_LOCAL(Cache*, current);
+};
+
+}  // namespace marl
+
+#endif  // marl_slab_allocator_h
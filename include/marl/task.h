@@ -17,7 +17,17 @@
 
 #include "export.h"
 
+#include <stddef.h>
+#include <stdint.h>
+
 #include <functional>
+#include <typeinfo>
+
+#if defined(__GXX_RTTI) || defined(_CPPRTTI)
+#define MARL_TASK_HAS_RTTI 1
+#else
+#define MARL_TASK_HAS_RTTI 0
+#endif
 
 namespace marl {
 
@@ -26,6 +36,14 @@ class Task {
  public:
   using Function = std::function<void()>;
 
+  // Tag is a small user-supplied integer used to group tasks for accounting.
+  // Tasks are untagged (0) by default. When task accounting is enabled, an
+  // untagged task inherits the tag of the task that enqueues it.
+  using Tag = uint8_t;
+
+  // The number of distinct tags.
+  static constexpr size_t NumTags = 256;
+
   enum class Flags {
     None = 0,
 
@@ -56,14 +74,47 @@ class Task {
   // is() returns true if the Task was created with the given flag.
   MARL_NO_EXPORT inline bool is(Flags flag) const;
 
+  // flowID() returns the trace flow identifier stamped on the task when it
+  // was enqueued, or 0 if tracing was disabled.
+  MARL_NO_EXPORT inline uint64_t flowID() const;
+
+  // setFlowID() sets the trace flow identifier of the task.
+  MARL_NO_EXPORT inline void setFlowID(uint64_t id);
+
+  // tag() returns the accounting tag of the task.
+  MARL_NO_EXPORT inline Tag tag() const;
+
+  // setTag() sets the accounting tag of the task.
+  MARL_NO_EXPORT inline void setTag(Tag tag);
+
+  // site() returns the type of the task's function. As each lambda has a
+  // unique type, this identifies the code that scheduled the task.
+  // Returns nullptr if the task has no function, or if RTTI is disabled.
+  MARL_NO_EXPORT inline const std::type_info* site() const;
+
  private:
+  friend class Scheduler;
+
   Function function;
   Flags flags = Flags::None;
+  uint64_t flow = 0;
+  Tag accountingTag = 0;
+  uint64_t enqueueTicks = 0;  // CycleClock ticks when enqueued, or 0.
 };
 
 Task::Task() = default;
-Task::Task(const Task& o) : function(o.function), flags(o.flags) {}
-Task::Task(Task&& o) : function(std::move(o.function)), flags(o.flags) {}
+Task::Task(const Task& o)
+    : function(o.function),
+      flags(o.flags),
+      flow(o.flow),
+      accountingTag(o.accountingTag),
+      enqueueTicks(o.enqueueTicks) {}
+Task::Task(Task&& o)
+    : function(std::move(o.function)),
+      flags(o.flags),
+      flow(o.flow),
+      accountingTag(o.accountingTag),
+      enqueueTicks(o.enqueueTicks) {}
 Task::Task(const Function& function_, Flags flags_ /* = Flags::None */)
     : function(function_), flags(flags_) {}
 Task::Task(Function&& function_, Flags flags_ /* = Flags::None */)
@@ -71,22 +122,34 @@ Task::Task(Function&& function_, Flags flags_ /* = Flags::None */)
 Task& Task::operator=(const Task& o) {
   function = o.function;
   flags = o.flags;
+  flow = o.flow;
+  accountingTag = o.accountingTag;
+  enqueueTicks = o.enqueueTicks;
   return *this;
 }
 Task& Task::operator=(Task&& o) {
   function = std::move(o.function);
   flags = o.flags;
+  flow = o.flow;
+  accountingTag = o.accountingTag;
+  enqueueTicks = o.enqueueTicks;
   return *this;
 }
 
 Task& Task::operator=(const Function& f) {
   function = f;
   flags = Flags::None;
+  flow = 0;
+  accountingTag = 0;
+  enqueueTicks = 0;
   return *this;
 }
 Task& Task::operator=(Function&& f) {
   function = std::move(f);
   flags = Flags::None;
+  flow = 0;
+  accountingTag = 0;
+  enqueueTicks = 0;
   return *this;
 }
 Task::operator bool() const {
@@ -102,6 +165,30 @@ bool Task::is(Flags flag) const {
          static_cast<int>(flag);
 }
 
+uint64_t Task::flowID() const {
+  return flow;
+}
+
+void Task::setFlowID(uint64_t id) {
+  flow = id;
+}
+
+Task::Tag Task::tag() const {
+  return accountingTag;
+}
+
+void Task::setTag(Tag tag) {
+  accountingTag = tag;
+}
+
+const std::type_info* Task::site() const {
+#if MARL_TASK_HAS_RTTI
+  return function ? &function.target_type() : nullptr;
+#else
+  return nullptr;
+#endif
+}
+
 }  // namespace marl
 
 #endif  // marl_task_h
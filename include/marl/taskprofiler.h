@@ -0,0 +1,103 @@
+// Copyright 2026 The Marl Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef marl_task_profiler_h
+#define marl_task_profiler_h
+
+#include "containers.h"
+#include "export.h"
+#include "mutex.h"
+#include "scheduler.h"
+
+#include <chrono>
+#include <typeinfo>
+
+namespace marl {
+
+// TaskProfiler is a Scheduler::Observer that aggregates the time spent running
+// tasks, grouped by the site that scheduled them (see Task::site()).
+//
+// TaskProfiler serializes all task begin and end events on a single mutex,
+// and so is intended for profiling rather than for use in production.
+//
+// Example usage:
+//
+//   auto profiler = std::make_shared<marl::TaskProfiler>();
+//   marl::Scheduler scheduler(marl::Scheduler::Config::allCores()
+//                                 .setObserver(profiler));
+//   ...
+//   for (auto& site : profiler->sites()) {
+//     printf("%s: %d tasks\n", site.name, int(site.count));
+//   }
+class TaskProfiler : public Scheduler::Observer {
+ public:
+  using Duration = std::chrono::nanoseconds;
+
+  // Site holds the timings of the tasks scheduled by a single site.
+  struct Site {
+    // The name of the site's function type, or "<unknown>" if the site is
+    // unknown.
+    const char* name = nullptr;
+
+    // The number of tasks that have finished running.
+    uint64_t count = 0;
+
+    // The total time from the start to the end of the tasks.
+    Duration total = Duration(0);
+
+    // The portion of total that the tasks' fibers were suspended.
+    Duration blocked = Duration(0);
+
+    // The longest time from the start to the end of a single task.
+    Duration max = Duration(0);
+  };
+
+  using Sites = containers::vector<Site, 16>;
+
+  MARL_EXPORT TaskProfiler(Allocator* allocator = Allocator::Default);
+
+  // sites() returns the timings of all sites that have run tasks since
+  // construction or the last call to reset(), sorted by descending total time.
+  MARL_EXPORT Sites sites();
+
+  // reset() clears all the site timings.
+  MARL_EXPORT void reset();
+
+  // Scheduler::Observer compliance
+  MARL_EXPORT void onTaskBegin(const Scheduler::Fiber*, const Task&) override;
+  MARL_EXPORT void onTaskEnd(const Scheduler::Fiber*, const Task&) override;
+  MARL_EXPORT void onFiberSuspend(const Scheduler::Fiber*) override;
+  MARL_EXPORT void onFiberResume(const Scheduler::Fiber*) override;
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  // Running holds the state of a task currently running on a fiber.
+  struct Running {
+    Clock::time_point start;
+    Clock::time_point suspended;
+    Duration blocked = Duration(0);
+  };
+
+  Allocator* const allocator;
+  marl::mutex mutex;
+  GUARDED_BY(mutex)
+  containers::unordered_map<const std::type_info*, Site> timings;
+  GUARDED_BY(mutex)
+  containers::unordered_map<const Scheduler::Fiber*, Running> running;
+};
+
+}  // namespace marl
+
+#endif  // marl_task_profiler_h
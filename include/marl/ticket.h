@@ -108,7 +108,7 @@ class Ticket {
     MARL_NO_EXPORT inline void callAndUnlock(marl::lock& lock);
     MARL_NO_EXPORT inline void unlink();  // guarded by shared->mutex
 
-    ConditionVariable isCalledCondVar;
+    ConditionVariable isCalledCondVar{Allocator::Default, "marl::Ticket"};
 
     std::shared_ptr<Shared> shared;
     Record* next = nullptr;  // guarded by shared->mutex
@@ -120,7 +120,7 @@ class Ticket {
 
   // Data shared between all tickets and the queue.
   struct Shared {
-    marl::mutex mutex;
+    marl::mutex mutex{"marl::Ticket"};
     Record tail;
   };
 
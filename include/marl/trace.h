@@ -21,64 +21,77 @@
 #ifndef marl_trace_h
 #define marl_trace_h
 
-#define MARL_TRACE_ENABLED 0
+// Tracing support is compiled in by default, but is disabled until enabled
+// at runtime with marl::Trace::enable(). Define MARL_TRACE_ENABLED to 0 to
+// compile out all tracing.
+#ifndef MARL_TRACE_ENABLED
+#define MARL_TRACE_ENABLED 1
+#endif
 
 #if MARL_TRACE_ENABLED
 
-#include <array>
+#include "export.h"
+
+#include <stdint.h>
+
 #include <atomic>
 #include <chrono>
-#include <condition_variable>
-#include <cstdarg>
-#include <cstring>
-#include <mutex>
-#include <ostream>
-#include <queue>
-#include <thread>
+#include <string>
 
 namespace marl {
 
-// Trace writes a trace event file into the current working directory that can
-// be consumed with Chrome's chrome://tracing viewer.
+// Trace records trace events into lock-free, per-thread ring buffers. The
+// buffers are periodically drained by a background thread, which streams the
+// events to a trace file that can be consumed with Chrome's chrome://tracing
+// viewer or the Perfetto UI (https://ui.perfetto.dev).
+//
+// Tracing is disabled until enable() is called, and can be disabled again with
+// disable(). While disabled, each trace macro costs a single relaxed atomic
+// load.
+//
 // Use the MARL_* macros below instead of using this class directly.
 class Trace {
  public:
-  static constexpr size_t MaxEventNameLength = 64;
+  // Name is the identifier of an interned event name.
+  using Name = uint32_t;
+
+  // NameCache holds the Name interned for a single call site.
+  using NameCache = std::atomic<Name>;
+
+  // Config holds the settings used by enable().
+  struct Config {
+    // Format is an enumerator of trace file formats.
+    enum class Format {
+      // Chrome JSON trace event format, one event per line.
+      JSON,
+      // Perfetto protobuf format. Each thread and fiber has its own track.
+      Perfetto,
+    };
 
-  static Trace* get();
+    // The format of the trace file to write.
+    Format format = Format::JSON;
 
-  void nameThread(const char* fmt, ...);
-  void beginEvent(const char* fmt, ...);
-  void endEvent();
-  void beginAsyncEvent(uint32_t id, const char* fmt, ...);
-  void endAsyncEvent(uint32_t id, const char* fmt, ...);
+    // The path of the trace file to write.
+    std::string path = "chrome.trace";
 
-  class ScopedEvent {
-   public:
-    inline ScopedEvent(const char* fmt, ...);
-    inline ~ScopedEvent();
+    // If not -1, the trace is written to this file descriptor instead of
+    // path. The file descriptor is not closed by disable().
+    int fd = -1;
 
-   private:
-    Trace* const trace;
-  };
+    // Record only one in every sampleRate scoped events, per thread.
+    // All other events are always recorded.
+    uint32_t sampleRate = 1;
 
-  class ScopedAsyncEvent {
-   public:
-    inline ScopedAsyncEvent(uint32_t id, const char* fmt, ...);
-    inline ~ScopedAsyncEvent();
+    // The number of events held by each thread's ring buffer. Rounded up to a
+    // power of two. Events are dropped if a thread's buffer is full.
+    // Threads that have already recorded events keep their existing buffer.
+    size_t bufferSize = 16384;
 
-   private:
-    Trace* const trace;
-    const uint32_t id;
-    std::string name;
+    // How often the background thread drains the thread buffers.
+    std::chrono::milliseconds flushInterval = std::chrono::milliseconds(10);
   };
 
- private:
-  Trace();
-  ~Trace();
-  Trace(const Trace&) = delete;
-  Trace& operator=(const Trace&) = delete;
-
+  // Event is a single, fixed-size trace event.
   struct Event {
     enum class Type : uint8_t {
       Begin = 'B',
@@ -103,109 +116,175 @@ class Trace {
       ClockSync = 'c',
       ContextEnter = '(',
       ContextLeave = ')',
-
-      // Internal types
-      Shutdown = 'S',
     };
 
-    Event();
-    virtual ~Event() = default;
-    virtual Type type() const = 0;
-    virtual void write(std::ostream& out) const;
-
-    char name[MaxEventNameLength] = {};
-    const char** categories = nullptr;
-    uint64_t timestamp = 0;  // in microseconds
-    uint32_t processID = 0;
-    uint32_t threadID;
-    uint32_t fiberID;
+    uint64_t timestamp;  // in nanoseconds
+    uint64_t value;      // async / flow id, or counter value
+    Name name;           // interned event name
+    uint32_t fiberID;    // the fiber that emitted the event, or 0
+    Type type;
   };
 
-  struct BeginEvent : public Event {
-    Type type() const override { return Type::Begin; }
-  };
-  struct EndEvent : public Event {
-    Type type() const override { return Type::End; }
-  };
-  struct MetadataEvent : public Event {
-    Type type() const override { return Type::Metadata; }
-  };
-  struct Shutdown : public Event {
-    Type type() const override { return Type::Shutdown; }
-  };
+  // enable() starts recording trace events, writing them as described by
+  // config. If tracing is already enabled, then it is first disabled.
+  MARL_EXPORT static void enable();
+  MARL_EXPORT static void enable(const Config& config);
 
-  struct AsyncEvent : public Event {
-    void write(std::ostream& out) const override;
-    uint32_t id;
-  };
+  // disable() stops recording trace events, and flushes and closes the trace
+  // file.
+  MARL_EXPORT static void disable();
 
-  struct AsyncStartEvent : public AsyncEvent {
-    Type type() const override { return Type::AsyncStart; }
-  };
-  struct AsyncEndEvent : public AsyncEvent {
-    Type type() const override { return Type::AsyncEnd; }
+  // isEnabled() returns true if tracing is enabled.
+  static inline bool isEnabled();
+
+  // get() returns the Trace if tracing is enabled, otherwise nullptr.
+  static inline Trace* get();
+
+  // intern() returns the Name for the given event name string, registering
+  // the name if it has not been seen before.
+  MARL_EXPORT static Name intern(const char* name);
+
+  // eventName() returns the Name for the event name string, interning it on
+  // the first call with the given cache.
+  static inline Name eventName(NameCache& cache, const char* name);
+
+  // eventName() returns the Name for the event name formatted from the
+  // printf-style format string and arguments. The name is formatted and
+  // interned on every call. Once a bounded number of distinct formatted names
+  // have been interned, new formatted names are replaced with fmt.
+  template <typename... ARGS>
+  static inline Name eventName(NameCache& cache,
+                               const char* fmt,
+                               const ARGS&... args);
+
+  // internFormatted() returns the Name for the event name formatted from the
+  // printf-style format string and arguments, registering the name if it has
+  // not been seen before. If the bounded table of formatted names is full,
+  // the Name for fmt is returned instead.
+  MARL_EXPORT static Name internFormatted(const char* fmt, ...);
+
+  // nameThread() names the calling thread, or fiber if called on a fiber.
+  // Names are remembered even when tracing is disabled.
+  MARL_EXPORT static void nameThread(const char* fmt, ...);
+
+  // beginEvent() records the start of a scoped event on the calling thread.
+  // Returns false if the event was not recorded due to sampling, in which case
+  // endEvent() must not be called for this event.
+  MARL_EXPORT bool beginEvent(Name name);
+
+  // endEvent() records the end of the scoped event started with beginEvent().
+  MARL_EXPORT void endEvent(Name name);
+
+  // beginAsyncEvent() records the start of an asynchronous event with the
+  // given id.
+  MARL_EXPORT void beginAsyncEvent(uint64_t id, Name name);
+
+  // endAsyncEvent() records the end of an asynchronous event with the given
+  // id.
+  MARL_EXPORT void endAsyncEvent(uint64_t id, Name name);
+
+  // instantEvent() records an event with no duration.
+  MARL_EXPORT void instantEvent(Name name);
+
+  // counterEvent() records the value of the named counter.
+  MARL_EXPORT void counterEvent(Name name, int64_t value);
+
+  // beginFlow() records the start of a flow, which links causally related
+  // events across threads and fibers, returning the new flow's identifier.
+  MARL_EXPORT uint64_t beginFlow(Name name);
+
+  // stepFlow() records an intermediate step of the flow with the given id.
+  MARL_EXPORT void stepFlow(uint64_t id, Name name);
+
+  // endFlow() records the end of the flow with the given id.
+  MARL_EXPORT void endFlow(uint64_t id, Name name);
+
+  class ScopedEvent {
+   public:
+    inline ScopedEvent(Name name);
+    inline ~ScopedEvent();
+
+   private:
+    Trace* trace;
+    const Name name;
   };
 
-  struct NameThreadEvent : public MetadataEvent {
-    void write(std::ostream& out) const override;
+  class ScopedAsyncEvent {
+   public:
+    inline ScopedAsyncEvent(uint64_t id, Name name);
+    inline ~ScopedAsyncEvent();
+
+   private:
+    Trace* const trace;
+    const uint64_t id;
+    const Name name;
   };
 
-  uint64_t timestamp();  // in microseconds
+ private:
+  class Buffer;
+  class Impl;
 
-  void put(Event*);
-  std::unique_ptr<Event> take();
+  Trace();
+  ~Trace();
+  Trace(const Trace&) = delete;
+  Trace& operator=(const Trace&) = delete;
 
-  struct EventQueue {
-    std::queue<std::unique_ptr<Event> > data;  // guarded by mutes
-    std::condition_variable condition;
-    std::mutex mutex;
-  };
-  // TODO: Increasing this from 1 can cause events to go out of order.
-  // Investigate, fix.
-  std::array<EventQueue, 1> eventQueues;
-  std::atomic<unsigned int> eventQueueWriteIdx = {0};
-  unsigned int eventQueueReadIdx = 0;
-  std::chrono::time_point<std::chrono::high_resolution_clock> createdAt =
-      std::chrono::high_resolution_clock::now();
-  std::thread thread;
-  std::atomic<bool> stopped = {false};
+  // record() records the event of the given type into the calling thread's
+  // buffer.
+  void record(Event::Type type, Name name, uint64_t value);
+
+  // singleton() returns the Trace singleton.
+  MARL_EXPORT static Trace* singleton();
+
+  MARL_EXPORT static std::atomic<bool> enabled;
+
+  Impl* const impl;
 };
 
-Trace::ScopedEvent::ScopedEvent(const char* fmt, ...) : trace(Trace::get()) {
-  if (trace != nullptr) {
-    char name[Trace::MaxEventNameLength];
-    va_list vararg;
-    va_start(vararg, fmt);
-    vsnprintf(name, Trace::MaxEventNameLength, fmt, vararg);
-    va_end(vararg);
+bool Trace::isEnabled() {
+  return enabled.load(std::memory_order_relaxed);
+}
+
+Trace* Trace::get() {
+  return isEnabled() ? singleton() : nullptr;
+}
 
-    trace->beginEvent(name);
+Trace::Name Trace::eventName(NameCache& cache, const char* name) {
+  auto interned = cache.load(std::memory_order_relaxed);
+  if (interned == 0) {  // Name 0 is never returned by intern().
+    interned = intern(name);
+    cache.store(interned, std::memory_order_relaxed);
+  }
+  return interned;
+}
+
+template <typename... ARGS>
+Trace::Name Trace::eventName(NameCache&, const char* fmt, const ARGS&... args) {
+  return internFormatted(fmt, args...);
+}
+
+Trace::ScopedEvent::ScopedEvent(Name name) : trace(Trace::get()), name(name) {
+  if (trace != nullptr && !trace->beginEvent(name)) {
+    trace = nullptr;
   }
 }
 
 Trace::ScopedEvent::~ScopedEvent() {
   if (trace != nullptr) {
-    trace->endEvent();
+    trace->endEvent(name);
   }
 }
 
-Trace::ScopedAsyncEvent::ScopedAsyncEvent(uint32_t id, const char* fmt, ...)
-    : trace(Trace::get()), id(id) {
+Trace::ScopedAsyncEvent::ScopedAsyncEvent(uint64_t id, Name name)
+    : trace(Trace::get()), id(id), name(name) {
   if (trace != nullptr) {
-    char buf[Trace::MaxEventNameLength];
-    va_list vararg;
-    va_start(vararg, fmt);
-    vsnprintf(buf, Trace::MaxEventNameLength, fmt, vararg);
-    va_end(vararg);
-    name = buf;
-
-    trace->beginAsyncEvent(id, "%s", buf);
+    trace->beginAsyncEvent(id, name);
   }
 }
 
 Trace::ScopedAsyncEvent::~ScopedAsyncEvent() {
   if (trace != nullptr) {
-    trace->endAsyncEvent(id, "%s", name.c_str());
+    trace->endAsyncEvent(id, name);
   }
 }
 
@@ -213,28 +292,73 @@ Trace::ScopedAsyncEvent::~ScopedAsyncEvent() {
 
 #define MARL_CONCAT_(a, b) a##b
 #define MARL_CONCAT(a, b) MARL_CONCAT_(a, b)
-#define MARL_SCOPED_EVENT(...) \
-  marl::Trace::ScopedEvent MARL_CONCAT(scoped_event, __LINE__)(__VA_ARGS__);
-#define MARL_BEGIN_ASYNC_EVENT(id, ...)    \
-  do {                                     \
-    if (auto t = marl::Trace::get()) {     \
-      t->beginAsyncEvent(id, __VA_ARGS__); \
-    }                                      \
+
+// MARL_TRACE_NAME() returns the interned marl::Trace::Name for an event name.
+// The name is either a string literal, which is interned once per call site,
+// or a printf-style format string followed by its arguments, which is
+// formatted and interned on each call. Formatted names are bounded; once the
+// limit is reached, new formatted names are replaced with the format string.
+// The event macros below only evaluate the name while tracing is enabled.
+#define MARL_TRACE_NAME(...)                            \
+  marl::Trace::eventName(                               \
+      []() -> marl::Trace::NameCache& {                 \
+        static marl::Trace::NameCache cache;            \
+        return cache;                                   \
+      }(),                                              \
+      __VA_ARGS__)
+
+#define MARL_SCOPED_EVENT(...)                                  \
+  marl::Trace::ScopedEvent MARL_CONCAT(scoped_event, __LINE__)( \
+      marl::Trace::isEnabled() ? MARL_TRACE_NAME(__VA_ARGS__) : 0);
+#define MARL_BEGIN_ASYNC_EVENT(id, ...)                     \
+  do {                                                      \
+    if (auto t = marl::Trace::get()) {                      \
+      t->beginAsyncEvent(id, MARL_TRACE_NAME(__VA_ARGS__)); \
+    }                                                       \
+  } while (false);
+#define MARL_END_ASYNC_EVENT(id, ...)                     \
+  do {                                                    \
+    if (auto t = marl::Trace::get()) {                    \
+      t->endAsyncEvent(id, MARL_TRACE_NAME(__VA_ARGS__)); \
+    }                                                     \
+  } while (false);
+#define MARL_SCOPED_ASYNC_EVENT(id, ...)                       \
+  marl::Trace::ScopedAsyncEvent MARL_CONCAT(defer_, __LINE__)( \
+      id, marl::Trace::isEnabled() ? MARL_TRACE_NAME(__VA_ARGS__) : 0);
+#define MARL_INSTANT_EVENT(...)                      \
+  do {                                               \
+    if (auto t = marl::Trace::get()) {               \
+      t->instantEvent(MARL_TRACE_NAME(__VA_ARGS__)); \
+    }                                                \
+  } while (false);
+// The name of a counter must be a string literal.
+#define MARL_COUNTER_EVENT(name, value)              \
+  do {                                               \
+    if (auto t = marl::Trace::get()) {               \
+      t->counterEvent(MARL_TRACE_NAME(name), value); \
+    }                                                \
   } while (false);
-#define MARL_END_ASYNC_EVENT(id, ...)    \
-  do {                                   \
-    if (auto t = marl::Trace::get()) {   \
-      t->endAsyncEvent(id, __VA_ARGS__); \
-    }                                    \
+#define MARL_BEGIN_FLOW(...)                                         \
+  [&] {                                                              \
+    auto t = marl::Trace::get();                                     \
+    return t != nullptr ? t->beginFlow(MARL_TRACE_NAME(__VA_ARGS__)) \
+                        : static_cast<uint64_t>(0);                  \
+  }()
+#define MARL_STEP_FLOW(id, ...)                      \
+  do {                                               \
+    auto t = marl::Trace::get();                     \
+    if (t != nullptr && (id) != 0) {                 \
+      t->stepFlow(id, MARL_TRACE_NAME(__VA_ARGS__)); \
+    }                                                \
   } while (false);
-#define MARL_SCOPED_ASYNC_EVENT(id, ...) \
-  marl::Trace::ScopedAsyncEvent MARL_CONCAT(defer_, __LINE__)(id, __VA_ARGS__);
-#define MARL_NAME_THREAD(...)          \
-  do {                                 \
-    if (auto t = marl::Trace::get()) { \
-      t->nameThread(__VA_ARGS__);      \
-    }                                  \
+#define MARL_END_FLOW(id, ...)                      \
+  do {                                              \
+    auto t = marl::Trace::get();                    \
+    if (t != nullptr && (id) != 0) {                \
+      t->endFlow(id, MARL_TRACE_NAME(__VA_ARGS__)); \
+    }                                               \
   } while (false);
+#define MARL_NAME_THREAD(...) marl::Trace::nameThread(__VA_ARGS__);
 
 #else  // MARL_TRACE_ENABLED
 
@@ -242,6 +366,11 @@ Trace::ScopedAsyncEvent::~ScopedAsyncEvent() {
 #define MARL_BEGIN_ASYNC_EVENT(id, ...)
 #define MARL_END_ASYNC_EVENT(id, ...)
 #define MARL_SCOPED_ASYNC_EVENT(id, ...)
+#define MARL_INSTANT_EVENT(...)
+#define MARL_COUNTER_EVENT(name, value)
+#define MARL_BEGIN_FLOW(...) static_cast<uint64_t>(0)
+#define MARL_STEP_FLOW(id, ...)
+#define MARL_END_FLOW(id, ...)
 #define MARL_NAME_THREAD(...)
 
 #endif  // MARL_TRACE_ENABLED
@@ -0,0 +1,272 @@
+// Copyright 2026 The Marl Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef marl_waiter_h
+#define marl_waiter_h
+
+#include "debug.h"
+#include "mutex.h"
+#include "scheduler.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+
+namespace marl {
+
+// Waiter is a fiber or thread that blocks until it is notified.
+//
+// Objects that can be waited on hold a WaitList of Waiters. A Waiter may be
+// added to the WaitLists of several objects at once, and is woken by whichever
+// object notifies it first. Unlike ConditionVariable, each notification wakes
+// exactly the Waiter that was removed from the list, so a Waiter is never
+// woken twice for the same event.
+//
+// A Waiter must be constructed and waited on by the same fiber or thread.
+// Alternatively, a Waiter can call a function when notified instead of waking
+// a fiber or thread, for waiters that do not block, such as coroutines.
+class Waiter {
+ public:
+  // OnNotify is the function called by notify(), with the data passed to the
+  // constructor.
+  using OnNotify = void (*)(void* data);
+
+  // Constructs a Waiter for the calling fiber or thread. object and kind are
+  // reported as the blocker of a waiting fiber (see
+  // Scheduler::Fiber::setBlocker()).
+  MARL_NO_EXPORT inline Waiter(const void* object, const char* kind);
+
+  // Constructs a Waiter that calls onNotify(data) from notify(), instead of
+  // waking a fiber or thread. onNotify is called while holding the lock of
+  // the notifying object, so must not block or call back into the object.
+  // wait(), wait_until() and reset() must not be called on such a Waiter.
+  MARL_NO_EXPORT inline Waiter(OnNotify onNotify, void* data);
+
+  // notify() wakes the waiter. notify() may be called before wait().
+  MARL_NO_EXPORT inline void notify();
+
+  // wait() blocks until notify() has been called since the last call to
+  // reset().
+  MARL_NO_EXPORT inline void wait();
+
+  // wait_until() blocks until notify() has been called since the last call to
+  // reset(), or the timeout has been reached. Returns true if notify() was
+  // called.
+  template <typename Clock, typename Duration>
+  MARL_NO_EXPORT inline bool wait_until(
+      const std::chrono::time_point<Clock, Duration>& timeout);
+
+  // reset() clears the notification, so that the Waiter can wait again.
+  MARL_NO_EXPORT inline void reset();
+
+ private:
+  Waiter(const Waiter&) = delete;
+  Waiter& operator=(const Waiter&) = delete;
+
+  marl::mutex mutex{"marl::Waiter"};
+  std::condition_variable condition;
+  Scheduler::Fiber* const fiber;
+  const void* const object;
+  const char* const kind;
+  const OnNotify onNotify = nullptr;
+  void* const data = nullptr;
+  bool notified = false;  // guarded by mutex
+};
+
+Waiter::Waiter(const void* object, const char* kind)
+    : fiber(Scheduler::Fiber::current()), object(object), kind(kind) {}
+
+Waiter::Waiter(OnNotify onNotify, void* data)
+    : fiber(nullptr),
+      object(nullptr),
+      kind(nullptr),
+      onNotify(onNotify),
+      data(data) {}
+
+void Waiter::notify() {
+  if (onNotify != nullptr) {
+    onNotify(data);
+    return;
+  }
+  marl::lock lock(mutex);
+  notified = true;
+  if (fiber != nullptr) {
+    fiber->notify();
+  } else {
+    condition.notify_one();
+  }
+}
+
+void Waiter::wait() {
+  marl::lock lock(mutex);
+  auto pred = [this]() REQUIRES(mutex) { return notified; };
+  if (fiber != nullptr) {
+    fiber->setBlocker(object, kind);
+    fiber->wait(lock, pred);
+    fiber->setBlocker(nullptr, nullptr);
+  } else {
+    lock.wait(condition, pred);
+  }
+}
+
+template <typename Clock, typename Duration>
+bool Waiter::wait_until(
+    const std::chrono::time_point<Clock, Duration>& timeout) {
+  marl::lock lock(mutex);
+  auto pred = [this]() REQUIRES(mutex) { return notified; };
+  if (fiber != nullptr) {
+    fiber->setBlocker(object, kind);
+    auto res = fiber->wait(lock, timeout, pred);
+    fiber->setBlocker(nullptr, nullptr);
+    return res;
+  }
+  return lock.wait_until(condition, timeout, pred);
+}
+
+void Waiter::reset() {
+  marl::lock lock(mutex);
+  notified = false;
+}
+
+// WaitList is a first-in, first-out list of the Waiters blocked on an object.
+//
+// WaitList is not synchronized: add(), remove() and notify() must be called
+// while holding the lock of the object that owns the list. The object must
+// add a Waiter to the list before checking whether it can proceed, and must
+// call notify() after each change that may let a Waiter proceed, so that
+// either the Waiter sees the change, or the change notifies the Waiter.
+class WaitList {
+ public:
+  // Node is an entry of a WaitList. Each list that a Waiter is added to needs
+  // its own Node, which is usually held on the waiter's stack.
+  struct Node {
+    Waiter* waiter = nullptr;
+    Node* prev = nullptr;
+    Node* next = nullptr;
+    bool queued = false;
+  };
+
+  MARL_NO_EXPORT inline WaitList() = default;
+
+  // add() appends waiter to the end of the list, using node.
+  MARL_NO_EXPORT inline void add(Node& node, Waiter& waiter);
+
+  // remove() removes node from the list. Returns false if node has already
+  // been removed by notify().
+  MARL_NO_EXPORT inline bool remove(Node& node);
+
+  // notify() removes and notifies up to count Waiters from the front of the
+  // list. Returns the number of Waiters notified.
+  MARL_NO_EXPORT inline size_t notify(size_t count);
+
+  // notifyAll() removes and notifies all the Waiters in the list.
+  MARL_NO_EXPORT inline void notifyAll();
+
+  // empty() returns true if the list has no Waiters. empty() may be called
+  // without holding the owner's lock, as a hint that notify() can be skipped.
+  // A sequentially consistent fence must separate the change that may let a
+  // Waiter proceed from the call to empty().
+  MARL_NO_EXPORT inline bool empty() const;
+
+ private:
+  WaitList(const WaitList&) = delete;
+  WaitList& operator=(const WaitList&) = delete;
+
+  Node* head = nullptr;
+  Node* tail = nullptr;
+  std::atomic<size_t> count = {0};
+};
+
+void WaitList::add(Node& node, Waiter& waiter) {
+  MARL_ASSERT(!node.queued, "WaitList node is already in a list");
+  node.waiter = &waiter;
+  node.prev = tail;
+  node.next = nullptr;
+  node.queued = true;
+  if (tail != nullptr) {
+    tail->next = &node;
+  } else {
+    head = &node;
+  }
+  tail = &node;
+  count.fetch_add(1, std::memory_order_relaxed);
+  // Order the count before the owner's check of whether the waiter can
+  // proceed. Pairs with the fence before empty().
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+}
+
+bool WaitList::remove(Node& node) {
+  if (!node.queued) {
+    return false;
+  }
+  (node.prev != nullptr ? node.prev->next : head) = node.next;
+  (node.next != nullptr ? node.next->prev : tail) = node.prev;
+  node.queued = false;
+  count.fetch_sub(1, std::memory_order_relaxed);
+  return true;
+}
+
+size_t WaitList::notify(size_t n) {
+  size_t notified = 0;
+  while (notified < n && head != nullptr) {
+    auto node = head;
+    remove(*node);
+    node->waiter->notify();
+    notified++;
+  }
+  return notified;
+}
+
+void WaitList::notifyAll() {
+  notify(~size_t(0));
+}
+
+bool WaitList::empty() const {
+  return count.load(std::memory_order_relaxed) == 0;
+}
+
+// Selectable is a single case of a call to select(): an operation on an
+// object with a WaitList that either completes immediately, or waits for the
+// object to notify it.
+//
+// Objects implement Selectable to be waited on by select() alongside other
+// objects, without a helper task per object. Event::onSignal(),
+// WaitGroup::onDone(), Channel::onRecv() and Channel::onSend() return the
+// Selectables of the marl primitives.
+class Selectable {
+ public:
+  virtual ~Selectable() = default;
+
+  // tryComplete() performs the operation and returns true if it can complete
+  // without blocking, otherwise returns false.
+  virtual bool tryComplete() = 0;
+
+  // add() adds waiter to the object's WaitList using node, while holding the
+  // object's lock.
+  virtual void add(WaitList::Node& node, Waiter& waiter) = 0;
+
+  // remove() removes node from the object's WaitList, while holding the
+  // object's lock. Returns false if the object has notified the waiter.
+  virtual bool remove(WaitList::Node& node) = 0;
+
+  // notifyNext() is called if the object notified the waiter, but the waiter
+  // did not call tryComplete() again before completing another case. The
+  // object should notify the next Waiter that may now be able to proceed.
+  virtual void notifyNext() = 0;
+};
+
+}  // namespace marl
+
+#endif  // marl_waiter_h
@@ -17,6 +17,7 @@
 
 #include "conditionvariable.h"
 #include "debug.h"
+#include "waiter.h"
 
 #include <atomic>
 #include <mutex>
@@ -64,18 +65,42 @@ class WaitGroup {
   // wait() blocks until the WaitGroup counter reaches zero.
   MARL_NO_EXPORT inline void wait() const;
 
+ private:
+  struct Data;
+
+ public:
+  // DoneCase is the select() case of a WaitGroup. See onDone().
+  class DoneCase : public Selectable {
+   public:
+    MARL_NO_EXPORT inline DoneCase(Data* data);
+    MARL_NO_EXPORT inline bool tryComplete() override;
+    MARL_NO_EXPORT inline void add(WaitList::Node& node,
+                                   Waiter& waiter) override;
+    MARL_NO_EXPORT inline bool remove(WaitList::Node& node) override;
+    MARL_NO_EXPORT inline void notifyNext() override;
+
+   private:
+    Data* const data;
+  };
+
+  // onDone() returns a select() case that completes when the WaitGroup
+  // counter is zero. The case must not outlive the WaitGroup.
+  MARL_NO_EXPORT inline DoneCase onDone() const;
+
  private:
   struct Data {
     MARL_NO_EXPORT inline Data(Allocator* allocator);
 
     std::atomic<unsigned int> count = {0};
     ConditionVariable cv;
-    marl::mutex mutex;
+    marl::mutex mutex{"marl::WaitGroup"};
+    WaitList waiters;  // guarded by mutex
   };
   const std::shared_ptr<Data> data;
 };
 
-WaitGroup::Data::Data(Allocator* allocator) : cv(allocator) {}
+WaitGroup::Data::Data(Allocator* allocator)
+    : cv(allocator, "marl::WaitGroup") {}
 
 WaitGroup::WaitGroup(unsigned int initialCount /* = 0 */,
                      Allocator* allocator /* = Allocator::Default */)
@@ -93,6 +118,7 @@ bool WaitGroup::done() const {
   if (count == 0) {
     marl::lock lock(data->mutex);
     data->cv.notify_all();
+    data->waiters.notifyAll();
     return true;
   }
   return false;
@@ -103,6 +129,30 @@ void WaitGroup::wait() const {
   data->cv.wait(lock, [this] { return data->count == 0; });
 }
 
+WaitGroup::DoneCase WaitGroup::onDone() const {
+  return DoneCase(data.get());
+}
+
+WaitGroup::DoneCase::DoneCase(Data* data) : data(data) {}
+
+bool WaitGroup::DoneCase::tryComplete() {
+  return data->count == 0;
+}
+
+void WaitGroup::DoneCase::add(WaitList::Node& node, Waiter& waiter) {
+  marl::lock lock(data->mutex);
+  data->waiters.add(node, waiter);
+}
+
+bool WaitGroup::DoneCase::remove(WaitList::Node& node) {
+  marl::lock lock(data->mutex);
+  return data->waiters.remove(node);
+}
+
+void WaitGroup::DoneCase::notifyNext() {
+  // done() notifies all the waiters, so there is no next waiter to notify.
+}
+
 }  // namespace marl
 
 #endif  // marl_waitgroup_h
@@ -0,0 +1,162 @@
+// Copyright 2026 The Marl Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "marl/arenaallocator.h"
+
+#include "marl/debug.h"
+
+#include <algorithm>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+namespace {
+
+// The size and alignment of a transparent huge page.
+constexpr size_t kHugePageSize = 2 * 1024 * 1024;
+
+// The alignment of regular chunks.
+constexpr size_t kChunkAlignment = 64;
+
+// adviseHugePages() advises the OS to back the memory range with transparent
+// huge pages, if supported.
+void adviseHugePages(void* ptr, size_t size) {
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+  madvise(ptr, size, MADV_HUGEPAGE);
+#else
+  (void)ptr;
+  (void)size;
+#endif
+}
+
+}  // anonymous namespace
+
+namespace marl {
+
+ArenaAllocator::ArenaAllocator(Allocator* parent /* = Allocator::Default */)
+    : ArenaAllocator(Config{}, parent) {}
+
+ArenaAllocator::ArenaAllocator(const Config& config_,
+                               Allocator* parent_ /* = Allocator::Default */)
+    : config(config_),
+      parent(parent_),
+      chunkSize(config.useHugePages ? alignUp(config.chunkSize, kHugePageSize)
+                                    : config.chunkSize),
+      chunkAlignment(config.useHugePages ? kHugePageSize : kChunkAlignment),
+      chunks(parent_),
+      large(parent_) {
+  MARL_ASSERT(config.chunkSize > 0, "ArenaAllocator chunkSize must be > 0");
+}
+
+ArenaAllocator::~ArenaAllocator() {
+  marl::lock lock(mutex);
+  for (auto& allocation : large) {
+    parent->free(allocation);
+  }
+  for (auto& chunk : chunks) {
+    parent->free(chunk);
+  }
+}
+
+void ArenaAllocator::reset() {
+  marl::lock lock(mutex);
+  for (auto& allocation : large) {
+    parent->free(allocation);
+    reserved -= allocation.request.size;
+  }
+  large.resize(0);
+  allocated = 0;
+  if (chunks.size() > 0) {
+    useChunk(0);
+  }
+}
+
+size_t ArenaAllocator::bytesAllocated() {
+  marl::lock lock(mutex);
+  return allocated;
+}
+
+size_t ArenaAllocator::bytesReserved() {
+  marl::lock lock(mutex);
+  return reserved;
+}
+
+void ArenaAllocator::newChunk() {
+  Allocation::Request request;
+  request.size = chunkSize;
+  request.alignment = chunkAlignment;
+  request.usage = Allocation::Usage::Undefined;
+  auto chunk = parent->allocate(request);
+  if (config.useHugePages) {
+    adviseHugePages(chunk.ptr, chunkSize);
+  }
+  chunks.push_back(chunk);
+  reserved += chunkSize;
+  useChunk(chunks.size() - 1);
+}
+
+void ArenaAllocator::useChunk(size_t index) {
+  current = index;
+  next = reinterpret_cast<uintptr_t>(chunks[index].ptr);
+  end = next + chunks[index].request.size;
+}
+
+Allocation ArenaAllocator::allocate(const Allocation::Request& request) {
+  if (request.useGuards) {
+    return parent->allocate(request);
+  }
+
+  auto alignment = std::max<size_t>(request.alignment, 1);
+
+  marl::lock lock(mutex);
+
+  if (request.size + alignment > chunkSize / 4) {
+    // Too large to bump allocate without wasting a large part of a chunk.
+    auto allocation = parent->allocate(request);
+    large.push_back(allocation);
+    reserved += request.size;
+    allocated += request.size;
+    return allocation;
+  }
+
+  while (true) {
+    auto ptr = alignUp(next, static_cast<uintptr_t>(alignment));
+    if (next != 0 && ptr + request.size <= end) {
+      next = ptr + request.size;
+      allocated += request.size;
+
+      Allocation allocation;
+      allocation.ptr = reinterpret_cast<void*>(ptr);
+      allocation.request = request;
+      return allocation;
+    }
+    // Current chunk is exhausted. Move to the next recycled chunk, or allocate
+    // a new one.
+    if (next != 0 && current + 1 < chunks.size()) {
+      useChunk(current + 1);
+    } else {
+      newChunk();
+    }
+  }
+}
+
+void ArenaAllocator::free(const Allocation& allocation) {
+  if (allocation.request.useGuards) {
+    parent->free(allocation);
+  }
+  // All other allocations are released by reset().
+}
+
+}  // namespace marl
@@ -0,0 +1,121 @@
+// Copyright 2026 The Marl Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "marl/arenaallocator.h"
+
+#include "marl_test.h"
+
+#include "marl/dag.h"
+#include "marl/event.h"
+
+#include <cstring>
+
+TEST_F(WithoutBoundScheduler, ArenaAllocatorAlignedAllocate) {
+  marl::ArenaAllocator arena(allocator);
+  for (auto alignment : {1, 2, 4, 8, 16, 32, 64, 128, 4096}) {
+    for (auto size : {1,   2,   3,   4,   5,   7,    8,     14,   16,
+                      17,  31,  34,  50,  63,  64,   65,    100,  127,
+                      128, 129, 200, 255, 256, 1000, 10000, 50000}) {
+      marl::Allocation::Request request;
+      request.alignment = alignment;
+      request.size = size;
+
+      auto allocation = arena.allocate(request);
+      auto ptr = allocation.ptr;
+      ASSERT_EQ(allocation.request.size, request.size);
+      ASSERT_EQ(allocation.request.alignment, request.alignment);
+      ASSERT_EQ(reinterpret_cast<uintptr_t>(ptr) & (alignment - 1), 0U);
+      memset(ptr, 0, size);  // Check the memory was actually allocated.
+      arena.free(allocation);
+    }
+  }
+}
+
+TEST_F(WithoutBoundScheduler, ArenaAllocatorReset) {
+  marl::ArenaAllocator::Config config;
+  config.chunkSize = 4096;
+  marl::ArenaAllocator arena(config, allocator);
+
+  marl::Allocation::Request request;
+  request.size = 100;
+  request.alignment = 8;
+
+  auto first = arena.allocate(request);
+  for (int i = 0; i < 100; i++) {
+    arena.allocate(request);
+  }
+  ASSERT_GE(arena.bytesAllocated(), 101U * 100U);
+  auto reserved = arena.bytesReserved();
+  ASSERT_GE(reserved, 101U * 100U);
+
+  // Reset recycles the chunks.
+  arena.reset();
+  ASSERT_EQ(arena.bytesAllocated(), 0U);
+  ASSERT_EQ(arena.allocate(request).ptr, first.ptr);
+  for (int i = 0; i < 100; i++) {
+    arena.allocate(request);
+  }
+  ASSERT_EQ(arena.bytesReserved(), reserved);
+
+  // Large allocations are released on reset.
+  request.size = 8192;
+  arena.allocate(request);
+  ASSERT_EQ(arena.bytesReserved(), reserved + 8192);
+  arena.reset();
+  ASSERT_EQ(arena.bytesReserved(), reserved);
+}
+
+TEST_F(WithoutBoundScheduler, ArenaAllocatorHugePages) {
+  marl::ArenaAllocator::Config config;
+  config.useHugePages = true;
+  marl::ArenaAllocator arena(config, allocator);
+
+  marl::Allocation::Request request;
+  request.size = 1000;
+  request.alignment = 16;
+  auto allocation = arena.allocate(request);
+  memset(allocation.ptr, 0, request.size);
+  ASSERT_EQ(arena.bytesReserved() % (2 * 1024 * 1024), 0U);
+}
+
+TEST_P(WithBoundScheduler, ArenaAllocatorDAG) {
+  marl::ArenaAllocator arena(allocator);
+
+  for (int frame = 0; frame < 3; frame++) {
+    {
+      marl::DAG<>::Builder builder(&arena);
+      std::atomic<int> counter = {0};
+      auto root = builder.root();
+      for (int i = 0; i < 100; i++) {
+        root.then([&] { counter++; });
+      }
+      auto dag = builder.build();
+
+      // The DAG's nodes are allocated from the arena.
+      ASSERT_GT(arena.bytesAllocated(), 100U * sizeof(std::function<void()>));
+
+      dag->run(&arena);
+      ASSERT_EQ(counter, 100);
+
+      marl::Event event(marl::Event::Mode::Manual, false, &arena);
+      marl::containers::vector<marl::Event, 4> events(&arena);
+      for (int i = 0; i < 10; i++) {
+        events.push_back(event);
+      }
+      event.signal();
+      events.back().wait();
+    }
+    arena.reset();
+  }
+}
@@ -0,0 +1,120 @@
+// Copyright 2026 The Marl Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "marl_bench.h"
+
+#include "marl/channel.h"
+#include "marl/conditionvariable.h"
+#include "marl/waitgroup.h"
+
+#include "benchmark/benchmark.h"
+
+#include <deque>
+
+// The Channel benchmarks pass numTasks values from 4 producer tasks to 4
+// consumer tasks through a queue of 64 values. ChannelDeque is the equivalent
+// built from a ConditionVariable and a std::deque.
+
+namespace {
+
+constexpr int numProducers = 4;
+constexpr int numConsumers = 4;
+constexpr size_t queueCapacity = 64;
+
+// DequeChannel is a bounded queue built from a marl::mutex, two
+// marl::ConditionVariables and a std::deque.
+class DequeChannel {
+ public:
+  void send(int value) {
+    marl::lock lock(mutex);
+    notFull.wait(lock, [&] { return queue.size() < queueCapacity; });
+    queue.push_back(value);
+    notEmpty.notify_one();
+  }
+
+  bool recv(int& value) {
+    marl::lock lock(mutex);
+    notEmpty.wait(lock, [&] { return !queue.empty() || closed; });
+    if (queue.empty()) {
+      return false;
+    }
+    value = queue.front();
+    queue.pop_front();
+    notFull.notify_one();
+    return true;
+  }
+
+  void close() {
+    marl::lock lock(mutex);
+    closed = true;
+    notEmpty.notify_all();
+  }
+
+ private:
+  marl::mutex mutex;
+  marl::ConditionVariable notFull;
+  marl::ConditionVariable notEmpty;
+  std::deque<int> queue;
+  bool closed = false;
+};
+
+// produceConsume() passes numValues values through the channel.
+template <typename Channel>
+void produceConsume(Channel& channel, int numValues) {
+  marl::WaitGroup producers(numProducers);
+  marl::WaitGroup consumers(numConsumers);
+  for (int p = 0; p < numProducers; p++) {
+    marl::schedule([&, p, producers] {
+      for (int i = p; i < numValues; i += numProducers) {
+        channel.send(i);
+      }
+      producers.done();
+    });
+  }
+  for (int c = 0; c < numConsumers; c++) {
+    marl::schedule([&, consumers] {
+      int value = 0;
+      while (channel.recv(value)) {
+        benchmark::DoNotOptimize(value);
+      }
+      consumers.done();
+    });
+  }
+  producers.wait();
+  channel.close();
+  consumers.wait();
+}
+
+}  // anonymous namespace
+
+BENCHMARK_DEFINE_F(Schedule, Channel)(benchmark::State& state) {
+  run(state, [&](int numValues) {
+    for (auto _ : state) {
+      marl::Channel<int> channel(queueCapacity);
+      produceConsume(channel, numValues);
+    }
+  });
+}
+BENCHMARK_REGISTER_F(Schedule, Channel)->Apply(Schedule::args<0x10000>);
+
+BENCHMARK_DEFINE_F(Schedule, ChannelDeque)(benchmark::State& state) {
+  run(state, [&](int numValues) {
+    for (auto _ : state) {
+      DequeChannel channel;
+      produceConsume(channel, numValues);
+    }
+  });
+}
+BENCHMARK_REGISTER_F(Schedule, ChannelDeque)->Apply(Schedule::args<0x10000>);
@@ -0,0 +1,189 @@
+// Copyright 2026 The Marl Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "marl_test.h"
+
+#include "marl/channel.h"
+#include "marl/waitgroup.h"
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+TEST_P(WithBoundScheduler, ChannelSendRecv) {
+  constexpr int count = 1000;
+  marl::Channel<int> channel(4);
+  ASSERT_EQ(channel.capacity(), 4U);
+  marl::schedule([=] {
+    for (int i = 0; i < count; i++) {
+      channel.send(i);
+    }
+    channel.close();
+  });
+  int expected = 0;
+  int value = 0;
+  while (channel.recv(value)) {
+    ASSERT_EQ(value, expected++);
+  }
+  ASSERT_EQ(expected, count);
+}
+
+TEST_P(WithBoundScheduler, ChannelMultiProducerMultiConsumer) {
+  constexpr int numProducers = 4;
+  constexpr int numConsumers = 4;
+  constexpr int count = 1000;
+  marl::Channel<int> channel(16);
+  std::atomic<int64_t> sum = {0};
+  std::atomic<int> received = {0};
+
+  marl::WaitGroup producers(numProducers);
+  for (int p = 0; p < numProducers; p++) {
+    marl::schedule([=] {
+      for (int i = 0; i < count; i++) {
+        channel.send(i);
+      }
+      producers.done();
+    });
+  }
+  marl::WaitGroup consumers(numConsumers);
+  for (int c = 0; c < numConsumers; c++) {
+    marl::schedule([=, &sum, &received] {
+      int value = 0;
+      while (channel.recv(value)) {
+        sum += value;
+        received++;
+      }
+      consumers.done();
+    });
+  }
+  producers.wait();
+  channel.close();
+  consumers.wait();
+
+  ASSERT_EQ(received.load(), numProducers * count);
+  ASSERT_EQ(sum.load(), int64_t(numProducers) * count * (count - 1) / 2);
+}
+
+TEST_P(WithBoundScheduler, ChannelTrySendTryRecv) {
+  marl::Channel<int> channel(3);  // Rounded up to 4.
+  ASSERT_EQ(channel.capacity(), 4U);
+  int value = 0;
+  ASSERT_FALSE(channel.try_recv(value));
+  for (int i = 0; i < 4; i++) {
+    ASSERT_TRUE(channel.try_send(i));
+  }
+  ASSERT_FALSE(channel.try_send(4));
+  for (int i = 0; i < 4; i++) {
+    ASSERT_TRUE(channel.try_recv(value));
+    ASSERT_EQ(value, i);
+  }
+  ASSERT_FALSE(channel.try_recv(value));
+}
+
+TEST_P(WithBoundScheduler, ChannelTimeouts) {
+  marl::Channel<int> channel(1);  // Rounded up to 2.
+  ASSERT_EQ(channel.capacity(), 2U);
+  int value = 0;
+  ASSERT_FALSE(channel.try_recv_for(value, std::chrono::milliseconds(10)));
+  ASSERT_TRUE(channel.try_send_for(1, std::chrono::milliseconds(10)));
+  ASSERT_TRUE(channel.try_send_for(2, std::chrono::milliseconds(10)));
+  ASSERT_FALSE(channel.try_send_for(3, std::chrono::milliseconds(10)));
+  ASSERT_TRUE(channel.try_recv_for(value, std::chrono::milliseconds(10)));
+  ASSERT_EQ(value, 1);
+  ASSERT_TRUE(channel.try_recv_for(value, std::chrono::milliseconds(10)));
+  ASSERT_EQ(value, 2);
+
+  marl::schedule([=] { channel.send(4); });
+  ASSERT_TRUE(channel.try_recv_until(
+      value, std::chrono::system_clock::now() + std::chrono::seconds(10)));
+  ASSERT_EQ(value, 4);
+}
+
+TEST_P(WithBoundScheduler, ChannelClose) {
+  marl::Channel<int> channel(4);
+  ASSERT_TRUE(channel.send(1));
+  ASSERT_TRUE(channel.send(2));
+  channel.close();
+  ASSERT_TRUE(channel.closed());
+  ASSERT_FALSE(channel.send(3));
+  ASSERT_FALSE(channel.try_send(3));
+
+  // Values sent before close() are still received.
+  int value = 0;
+  ASSERT_TRUE(channel.recv(value));
+  ASSERT_EQ(value, 1);
+  ASSERT_TRUE(channel.try_recv(value));
+  ASSERT_EQ(value, 2);
+  ASSERT_FALSE(channel.recv(value));
+}
+
+TEST_P(WithBoundScheduler, ChannelCloseWakesBlocked) {
+  marl::Channel<int> empty(2);
+  marl::Channel<int> full(2);
+  full.send(0);
+  full.send(0);
+  std::atomic<int> failed = {0};
+  marl::WaitGroup wg(2);
+  marl::schedule([=, &failed] {
+    int value = 0;
+    if (!empty.recv(value)) {
+      failed++;
+    }
+    wg.done();
+  });
+  marl::schedule([=, &failed] {
+    if (!full.send(1)) {
+      failed++;
+    }
+    wg.done();
+  });
+  empty.close();
+  full.close();
+  wg.wait();
+  ASSERT_EQ(failed.load(), 2);
+}
+
+TEST_P(WithBoundScheduler, ChannelBatch) {
+  constexpr int count = 1000;
+  std::vector<int> in(count);
+  for (int i = 0; i < count; i++) {
+    in[i] = i;
+  }
+  marl::Channel<int> channel(8);
+  marl::schedule([=, &in] {
+    channel.send_n(in.data(), 300);
+    channel.send_n(in.data() + 300, count - 300);
+    channel.close();
+  });
+  std::vector<int> out(count + 10);
+  size_t received = channel.recv_n(out.data(), 10);
+  received += channel.recv_n(out.data() + received, out.size() - received);
+  ASSERT_EQ(received, size_t(count));
+  for (int i = 0; i < count; i++) {
+    ASSERT_EQ(out[i], i);
+  }
+  ASSERT_EQ(channel.send_n(in.data(), 1), 0U);
+}
+
+TEST_F(WithoutBoundScheduler, ChannelDestructsUnreceived) {
+  auto value = std::make_shared<int>(42);
+  {
+    marl::Channel<std::shared_ptr<int>> channel(4, allocator);
+    channel.try_send(value);
+    channel.try_send(value);
+    ASSERT_EQ(value.use_count(), 3);
+  }
+  ASSERT_EQ(value.use_count(), 1);
+}
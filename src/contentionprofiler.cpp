@@ -0,0 +1,336 @@
+// Copyright 2026 The Marl Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "marl/contentionprofiler.h"
+
+#include "cycleclock.h"
+#include "marl/debug.h"
+
+#include <algorithm>
+#include <array>
+#include <functional>
+#include <thread>
+
+namespace {
+
+const char* const unknown = "<unknown>";
+
+// Key identifies a group of waits in top().
+struct Key {
+  const void* object;
+  const std::type_info* site;
+  bool operator==(const Key& other) const {
+    return object == other.object && site == other.site;
+  }
+};
+
+struct KeyHash {
+  size_t operator()(const Key& key) const {
+    return std::hash<const void*>()(key.object) * 31 +
+           std::hash<const void*>()(key.site);
+  }
+};
+
+// Group holds the sampled waits of a Key, in CycleClock ticks.
+struct Group {
+  const char* kind = nullptr;
+  uint64_t count = 0;
+  uint64_t total = 0;
+  uint64_t max = 0;
+};
+
+}  // anonymous namespace
+
+namespace marl {
+
+////////////////////////////////////////////////////////////////////////////////
+// ContentionProfiler::Table
+////////////////////////////////////////////////////////////////////////////////
+
+// Table is a fixed-capacity, open-addressed hash table of the sampled waits
+// recorded by a single worker. Only the owning worker writes to the table.
+// Each entry is guarded by a sequence lock so that top() can read the entries
+// while the worker is recording, without either side blocking.
+class ContentionProfiler::Table {
+ public:
+  // The number of entries in the table.
+  static constexpr size_t Capacity = 256;
+  // The number of entries probed for a key before evicting one.
+  static constexpr size_t MaxProbes = 8;
+
+  // Entry holds the sampled waits of a single primitive instance and site,
+  // in CycleClock ticks. An entry with a count of 0 is empty.
+  struct Entry {
+    // Odd while the owning worker is writing to the entry.
+    std::atomic<uint32_t> sequence = {0};
+    std::atomic<const void*> object = {nullptr};
+    std::atomic<const std::type_info*> site = {nullptr};
+    std::atomic<const char*> kind = {nullptr};
+    std::atomic<uint64_t> count = {0};
+    std::atomic<uint64_t> total = {0};
+    std::atomic<uint64_t> max = {0};
+  };
+
+  // Snapshot is a consistent copy of an Entry.
+  struct Snapshot {
+    const void* object;
+    const std::type_info* site;
+    const char* kind;
+    uint64_t count;
+    uint64_t total;
+    uint64_t max;
+  };
+
+  // record() adds a wait to the table. Must only be called by the owner.
+  void record(const void* object,
+              const char* kind,
+              const std::type_info* site,
+              uint64_t ticks);
+
+  // clear() empties the table. Must only be called by the owner.
+  void clear();
+
+  // read() returns a consistent copy of the entry at index i. May be called
+  // from any thread.
+  Snapshot read(size_t i) const;
+
+  // The profiler epoch that the entries were recorded in.
+  std::atomic<uint64_t> epoch = {0};
+
+  // True if the table is held by a worker.
+  bool inUse = false;  // guarded by ContentionProfiler::mutex
+
+ private:
+  // beginWrite() and endWrite() bracket the modification of entry.
+  static inline void beginWrite(Entry& entry);
+  static inline void endWrite(Entry& entry);
+
+  std::array<Entry, Capacity> entries;
+};
+
+constexpr size_t ContentionProfiler::Table::Capacity;
+constexpr size_t ContentionProfiler::Table::MaxProbes;
+
+void ContentionProfiler::Table::beginWrite(Entry& entry) {
+  entry.sequence.store(entry.sequence.load(std::memory_order_relaxed) + 1,
+                       std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+}
+
+void ContentionProfiler::Table::endWrite(Entry& entry) {
+  entry.sequence.store(entry.sequence.load(std::memory_order_relaxed) + 1,
+                       std::memory_order_release);
+}
+
+void ContentionProfiler::Table::record(const void* object,
+                                       const char* kind,
+                                       const std::type_info* site,
+                                       uint64_t ticks) {
+  static constexpr auto relaxed = std::memory_order_relaxed;
+  auto hash = KeyHash()(Key{object, site});
+  Entry* empty = nullptr;
+  Entry* victim = nullptr;
+  for (size_t i = 0; i < MaxProbes; i++) {
+    auto& entry = entries[(hash + i) % Capacity];
+    auto count = entry.count.load(relaxed);
+    if (count == 0) {
+      if (empty == nullptr) {
+        empty = &entry;
+      }
+      continue;
+    }
+    if (entry.object.load(relaxed) == object &&
+        entry.site.load(relaxed) == site) {
+      beginWrite(entry);
+      entry.count.store(count + 1, relaxed);
+      entry.total.store(entry.total.load(relaxed) + ticks, relaxed);
+      if (ticks > entry.max.load(relaxed)) {
+        entry.max.store(ticks, relaxed);
+      }
+      endWrite(entry);
+      return;
+    }
+    if (victim == nullptr ||
+        entry.total.load(relaxed) < victim->total.load(relaxed)) {
+      victim = &entry;
+    }
+  }
+
+  // Not found. Use an empty entry, or evict the least contended one.
+  auto& entry = (empty != nullptr) ? *empty : *victim;
+  beginWrite(entry);
+  entry.object.store(object, relaxed);
+  entry.site.store(site, relaxed);
+  entry.kind.store(kind, relaxed);
+  entry.count.store(1, relaxed);
+  entry.total.store(ticks, relaxed);
+  entry.max.store(ticks, relaxed);
+  endWrite(entry);
+}
+
+void ContentionProfiler::Table::clear() {
+  for (auto& entry : entries) {
+    if (entry.count.load(std::memory_order_relaxed) != 0) {
+      beginWrite(entry);
+      entry.count.store(0, std::memory_order_relaxed);
+      endWrite(entry);
+    }
+  }
+}
+
+ContentionProfiler::Table::Snapshot ContentionProfiler::Table::read(
+    size_t i) const {
+  static constexpr auto relaxed = std::memory_order_relaxed;
+  auto& entry = entries[i];
+  while (true) {
+    auto before = entry.sequence.load(std::memory_order_acquire);
+    Snapshot snapshot;
+    snapshot.object = entry.object.load(relaxed);
+    snapshot.site = entry.site.load(relaxed);
+    snapshot.kind = entry.kind.load(relaxed);
+    snapshot.count = entry.count.load(relaxed);
+    snapshot.total = entry.total.load(relaxed);
+    snapshot.max = entry.max.load(relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if ((before & 1) == 0 && entry.sequence.load(relaxed) == before) {
+      return snapshot;
+    }
+    std::this_thread::yield();
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// ContentionProfiler
+////////////////////////////////////////////////////////////////////////////////
+constexpr uint32_t ContentionProfiler::DefaultSampleRate;
+
+ContentionProfiler::ContentionProfiler(
+    uint32_t sampleRate /* = DefaultSampleRate */,
+    Allocator* allocator /* = Allocator::Default */)
+    : sampleRate(sampleRate), allocator(allocator), tables(allocator) {
+  MARL_ASSERT(sampleRate > 0, "sampleRate must be greater than 0");
+}
+
+ContentionProfiler::~ContentionProfiler() {
+  marl::lock lock(mutex);
+  for (auto table : tables) {
+    MARL_ASSERT(!table->inUse, "ContentionProfiler destructed while in use");
+    allocator->destroy(table);
+  }
+}
+
+ContentionProfiler::Table* ContentionProfiler::acquire() {
+  marl::lock lock(mutex);
+  for (auto table : tables) {
+    if (!table->inUse) {
+      table->inUse = true;
+      return table;
+    }
+  }
+  auto table = allocator->create<Table>();
+  table->inUse = true;
+  table->epoch.store(epoch.load(std::memory_order_relaxed),
+                     std::memory_order_relaxed);
+  tables.push_back(table);
+  return table;
+}
+
+void ContentionProfiler::release(Table* table) {
+  marl::lock lock(mutex);
+  table->inUse = false;
+}
+
+void ContentionProfiler::record(Table* table,
+                                const void* object,
+                                const char* kind,
+                                const std::type_info* site,
+                                uint64_t ticks) {
+  auto current = epoch.load(std::memory_order_acquire);
+  if (table->epoch.load(std::memory_order_relaxed) != current) {
+    // reset() was called since the last record(). Discard the stale waits.
+    table->clear();
+    table->epoch.store(current, std::memory_order_release);
+  }
+  table->record(object, kind, site, ticks);
+}
+
+ContentionProfiler::Contentions ContentionProfiler::top(
+    size_t n,
+    GroupBy groupBy /* = GroupBy::ObjectAndSite */) {
+  containers::unordered_map<Key, Group, KeyHash> groups(allocator);
+  {
+    marl::lock lock(mutex);
+    auto current = epoch.load(std::memory_order_acquire);
+    for (auto table : tables) {
+      if (table->epoch.load(std::memory_order_acquire) != current) {
+        continue;  // Recorded before the last reset().
+      }
+      for (size_t i = 0; i < Table::Capacity; i++) {
+        auto entry = table->read(i);
+        if (entry.count == 0) {
+          continue;
+        }
+        Key key{entry.object, entry.site};
+        auto kind = entry.kind;
+        switch (groupBy) {
+          case GroupBy::Object:
+            key.site = nullptr;
+            break;
+          case GroupBy::Site:
+            key.object = nullptr;
+            kind = nullptr;
+            break;
+          case GroupBy::ObjectAndSite:
+            break;
+        }
+        auto& group = groups[key];
+        group.kind = kind;
+        group.count += entry.count;
+        group.total += entry.total;
+        group.max = std::max(group.max, entry.max);
+      }
+    }
+  }
+
+  auto nsPerTick = CycleClock::nanosecondsPerTick();
+  Contentions out(allocator);
+  out.reserve(groups.size());
+  for (auto& it : groups) {
+    Contention contention;
+    contention.object = it.first.object;
+    contention.kind = it.second.kind != nullptr ? it.second.kind : unknown;
+    contention.site = (groupBy != GroupBy::Object && it.first.site != nullptr)
+                          ? it.first.site->name()
+                          : unknown;
+    contention.count = it.second.count;
+    contention.total = CycleClock::toDuration(it.second.total, nsPerTick);
+    contention.max = CycleClock::toDuration(it.second.max, nsPerTick);
+    out.push_back(contention);
+  }
+  std::sort(out.begin(), out.end(), [](const Contention& a,
+                                       const Contention& b) {
+    return a.total > b.total;
+  });
+  if (out.size() > n) {
+    out.resize(n);
+  }
+  return out;
+}
+
+void ContentionProfiler::reset() {
+  // Tables are cleared lazily by their workers on the next record().
+  epoch.fetch_add(1, std::memory_order_acq_rel);
+}
+
+}  // namespace marl
@@ -0,0 +1,154 @@
+// Copyright 2026 The Marl Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "marl/contentionprofiler.h"
+
+#include "marl_test.h"
+
+#include "marl/event.h"
+#include "marl/waitgroup.h"
+
+#include <cstring>
+#include <thread>
+#include <vector>
+
+TEST_F(WithoutBoundScheduler, ContentionProfilerTop) {
+  auto profiler = std::make_shared<marl::ContentionProfiler>(1, allocator);
+  constexpr int numWaiters = 5;
+  {
+    marl::Scheduler::Config config;
+    config.setAllocator(allocator);
+    config.setWorkerThreadCount(2);
+    config.setContentionProfiler(profiler);
+    marl::Scheduler scheduler(config);
+    scheduler.bind();
+
+    marl::WaitGroup done(2 * numWaiters);
+    marl::WaitGroup started(1);
+    marl::Event event(marl::Event::Mode::Manual);
+    for (int i = 0; i < numWaiters; i++) {
+      marl::schedule([=] {
+        event.wait();
+        done.done();
+      });
+      marl::schedule([=] {
+        started.wait();
+        done.done();
+      });
+    }
+    marl::schedule([=] {
+      std::this_thread::sleep_for(std::chrono::milliseconds(5));
+      event.signal();
+      started.done();
+    });
+    done.wait();
+    scheduler.unbind();
+  }
+
+  auto byObject = profiler->top(10, marl::ContentionProfiler::GroupBy::Object);
+  uint64_t eventWaits = 0;
+  uint64_t waitGroupWaits = 0;
+  for (size_t i = 0; i < byObject.size(); i++) {
+    auto& contention = byObject[i];
+    ASSERT_GT(contention.count, 0U);
+    ASSERT_LE(contention.max, contention.total);
+    if (i > 0) {
+      ASSERT_LE(contention.total, byObject[i - 1].total);
+    }
+    if (strcmp(contention.kind, "marl::Event") == 0) {
+      ASSERT_NE(contention.object, nullptr);
+      ASSERT_GE(contention.max, std::chrono::milliseconds(1));
+      eventWaits += contention.count;
+    } else if (strcmp(contention.kind, "marl::WaitGroup") == 0) {
+      ASSERT_NE(contention.object, nullptr);
+      waitGroupWaits += contention.count;
+    }
+  }
+  ASSERT_GE(eventWaits, uint64_t(numWaiters));
+  ASSERT_GE(waitGroupWaits, uint64_t(numWaiters));
+
+  auto bySite = profiler->top(1, marl::ContentionProfiler::GroupBy::Site);
+  ASSERT_EQ(bySite.size(), 1U);
+  ASSERT_EQ(bySite[0].object, nullptr);
+#if MARL_TASK_HAS_RTTI
+  ASSERT_STRNE(bySite[0].site, "<unknown>");
+#endif
+
+  profiler->reset();
+  ASSERT_EQ(profiler->top(10).size(), 0U);
+}
+
+TEST_F(WithoutBoundScheduler, ContentionProfilerSampling) {
+  auto profiler = std::make_shared<marl::ContentionProfiler>(1000, allocator);
+  {
+    marl::Scheduler::Config config;
+    config.setAllocator(allocator);
+    config.setWorkerThreadCount(1);
+    config.setContentionProfiler(profiler);
+    marl::Scheduler scheduler(config);
+    scheduler.bind();
+
+    marl::WaitGroup done(10);
+    marl::Event event(marl::Event::Mode::Manual);
+    for (int i = 0; i < 10; i++) {
+      marl::schedule([=] {
+        event.wait();
+        done.done();
+      });
+    }
+    event.signal();
+    done.wait();
+    scheduler.unbind();
+  }
+
+  // Fewer than sampleRate suspensions are not sampled.
+  ASSERT_EQ(profiler->top(10).size(), 0U);
+}
+
+TEST_F(WithoutBoundScheduler, ContentionProfilerBoundedEntries) {
+  auto profiler = std::make_shared<marl::ContentionProfiler>(1, allocator);
+  constexpr int numEvents = 1000;
+  {
+    marl::Scheduler::Config config;
+    config.setAllocator(allocator);
+    config.setWorkerThreadCount(1);
+    config.setContentionProfiler(profiler);
+    marl::Scheduler scheduler(config);
+    scheduler.bind();
+
+    marl::WaitGroup done(1);
+    marl::schedule([=] {
+      // Keep the events alive so that each wait is on a distinct object.
+      std::vector<marl::Event> events;
+      for (int i = 0; i < numEvents; i++) {
+        events.emplace_back(marl::Event::Mode::Manual);
+        auto event = events.back();
+        marl::schedule([=] { event.signal(); });
+        event.wait();
+      }
+      done.done();
+    });
+    done.wait();
+    scheduler.unbind();
+  }
+
+  // The worker's table holds at most 256 objects. The least contended
+  // objects are evicted once it is full.
+  auto byObject = profiler->top(numEvents);
+  ASSERT_GT(byObject.size(), 0U);
+  ASSERT_LE(byObject.size(), 256U);
+
+  profiler->reset();
+  ASSERT_EQ(profiler->top(numEvents).size(), 0U);
+}
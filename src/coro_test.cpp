@@ -0,0 +1,243 @@
+// Copyright 2026 The Marl Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "marl/coro.h"
+
+#if MARL_CORO_SUPPORTED
+
+#include "marl/channel.h"
+#include "marl/event.h"
+#include "marl/future.h"
+#include "marl/ticket.h"
+#include "marl/waitgroup.h"
+
+#include "marl_test.h"
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace {
+
+marl::coro::Task<int> add(int a, int b) {
+  co_return a + b;
+}
+
+marl::coro::Task<int> sum(int count) {
+  int total = 0;
+  for (int i = 0; i < count; i++) {
+    total = co_await add(total, i);
+  }
+  co_return total;
+}
+
+marl::coro::Task<int> countTo(int count) {
+  int total = 0;
+  for (int i = 0; i < count; i++) {
+    total = co_await add(total, 1);
+  }
+  co_return total;
+}
+
+marl::coro::Task<std::string> waitForEvent(marl::Event event,
+                                           std::string value) {
+  co_await event;
+  co_return value;
+}
+
+marl::coro::Task<> waitForGroup(marl::WaitGroup wg, std::atomic<int>* count) {
+  co_await wg;
+  (*count)++;
+}
+
+marl::coro::Task<> waitForTicket(marl::Ticket ticket,
+                                 int index,
+                                 std::vector<int>* order) {
+  co_await ticket;
+  order->push_back(index);
+  ticket.done();
+}
+
+marl::coro::Task<int> waitForFuture(marl::Future<int> future) {
+  int value = co_await future;
+  co_return value + 1;
+}
+
+marl::coro::Task<> sleep(std::chrono::milliseconds duration) {
+  co_await marl::coro::sleep_for(duration);
+}
+
+marl::coro::Task<int> receiveAll(marl::Channel<int> channel) {
+  int total = 0;
+  for (;;) {
+    int value = 0;
+    bool ok = false;
+    co_await channel.onRecv(value, ok);
+    if (!ok) {
+      co_return total;
+    }
+    total += value;
+  }
+}
+
+}  // anonymous namespace
+
+TEST_P(WithBoundScheduler, CoroTaskReturnsValue) {
+  auto future = marl::coro::schedule(add(1, 2));
+  ASSERT_EQ(future.get(), 3);
+}
+
+TEST_P(WithBoundScheduler, CoroTaskAwaitsTask) {
+  auto future = marl::coro::schedule(sum(100));
+  ASSERT_EQ(future.get(), 4950);
+}
+
+TEST_P(WithBoundScheduler, CoroTaskAwaitsManySynchronousTasks) {
+  // Each awaited task completes synchronously. The stack must not grow with
+  // the number of tasks awaited.
+  auto future = marl::coro::schedule(countTo(100000));
+  ASSERT_EQ(future.get(), 100000);
+}
+
+TEST_P(WithBoundScheduler, CoroFrameUsesSchedulerAllocator) {
+  auto before = allocator->stats().numAllocations();
+  {
+    auto task = add(1, 2);  // Tasks are lazy, so this only allocates a frame.
+    ASSERT_EQ(allocator->stats().numAllocations(), before + 1);
+  }
+  ASSERT_EQ(allocator->stats().numAllocations(), before);
+}
+
+TEST_P(WithBoundScheduler, CoroAwaitEvent) {
+  marl::Event event;
+  auto future = marl::coro::schedule(waitForEvent(event, "hello"));
+  ASSERT_FALSE(future.wait_for(std::chrono::milliseconds(10)));
+  event.signal();
+  ASSERT_EQ(future.get(), "hello");
+}
+
+TEST_P(WithBoundScheduler, CoroAwaitManualEventFromManyCoroutines) {
+  constexpr int numTasks = 256;
+  marl::Event event(marl::Event::Mode::Manual);
+  std::vector<marl::Future<std::string>> futures;
+  for (int i = 0; i < numTasks; i++) {
+    futures.push_back(
+        marl::coro::schedule(waitForEvent(event, std::to_string(i))));
+  }
+  event.signal();
+  for (int i = 0; i < numTasks; i++) {
+    ASSERT_EQ(futures[i].get(), std::to_string(i));
+  }
+}
+
+TEST_P(WithBoundScheduler, CoroAwaitWaitGroup) {
+  constexpr int numTasks = 16;
+  marl::WaitGroup wg(numTasks);
+  std::atomic<int> count = {0};
+  auto future = marl::coro::schedule(waitForGroup(wg, &count));
+  for (int i = 0; i < numTasks; i++) {
+    marl::schedule([=] { wg.done(); });
+  }
+  future.get();
+  ASSERT_EQ(count, 1);
+}
+
+TEST_P(WithBoundScheduler, CoroAwaitTicket) {
+  constexpr int numTasks = 16;
+  marl::Ticket::Queue queue;
+  std::vector<marl::Ticket> tickets;
+  for (int i = 0; i < numTasks; i++) {
+    tickets.push_back(queue.take());
+  }
+  std::vector<int> order;
+  std::vector<marl::Future<void>> futures;
+  for (int i = numTasks - 1; i >= 0; i--) {
+    futures.push_back(
+        marl::coro::schedule(waitForTicket(tickets[i], i, &order)));
+  }
+  for (auto& future : futures) {
+    future.get();
+  }
+  ASSERT_EQ(order.size(), static_cast<size_t>(numTasks));
+  for (int i = 0; i < numTasks; i++) {
+    ASSERT_EQ(order[i], i);
+  }
+}
+
+TEST_P(WithBoundScheduler, CoroAwaitFuture) {
+  marl::Promise<int> promise;
+  auto future = marl::coro::schedule(waitForFuture(promise.get_future()));
+  marl::schedule([=] { promise.set_value(41); });
+  ASSERT_EQ(future.get(), 42);
+}
+
+TEST_P(WithBoundScheduler, CoroSleepFor) {
+  auto start = std::chrono::system_clock::now();
+  std::vector<marl::Future<void>> futures;
+  for (int i = 0; i < 8; i++) {
+    futures.push_back(
+        marl::coro::schedule(sleep(std::chrono::milliseconds(10 + i))));
+  }
+  for (auto& future : futures) {
+    future.get();
+  }
+  ASSERT_GE(std::chrono::system_clock::now() - start,
+            std::chrono::milliseconds(17));
+}
+
+TEST_F(WithoutBoundScheduler, CoroSleepForUnderLoad) {
+  using Clock = std::chrono::system_clock;
+  std::atomic<bool> slept = {false};
+  auto giveUp = Clock::now() + std::chrono::seconds(5);
+  // busy keeps the worker thread running a chain of tasks until the sleep
+  // has completed, so the worker never goes idle.
+  std::function<void()> busy = [&] {
+    if (!slept && Clock::now() < giveUp) {
+      marl::schedule(busy);
+    }
+  };
+
+  marl::Scheduler::Config config;
+  config.setAllocator(allocator);
+  config.setWorkerThreadCount(1);
+  marl::Scheduler scheduler(config);
+  scheduler.bind();
+
+  marl::schedule(busy);
+  auto start = Clock::now();
+  marl::coro::schedule(sleep(std::chrono::milliseconds(10))).get();
+  auto elapsed = Clock::now() - start;
+  slept = true;
+  scheduler.unbind();
+
+  ASSERT_LT(elapsed, std::chrono::seconds(2));
+}
+
+TEST_P(WithBoundScheduler, CoroAwaitChannel) {
+  constexpr int count = 1000;
+  marl::Channel<int> channel(4);
+  auto future = marl::coro::schedule(receiveAll(channel));
+  marl::schedule([=] {
+    for (int i = 0; i < count; i++) {
+      channel.send(i);
+    }
+    channel.close();
+  });
+  ASSERT_EQ(future.get(), count * (count - 1) / 2);
+}
+
+#endif  // MARL_CORO_SUPPORTED
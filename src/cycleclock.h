@@ -0,0 +1,143 @@
+// Copyright 2026 The Marl Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef marl_cycle_clock_h
+#define marl_cycle_clock_h
+
+#include <stdint.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>  // __rdtsc()
+#define MARL_CYCLE_CLOCK_TSC 1
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>  // __rdtsc()
+#define MARL_CYCLE_CLOCK_TSC 1
+#endif
+
+namespace marl {
+
+// CycleClock is a monotonic clock that is considerably cheaper to read than
+// std::chrono::steady_clock. On x86 it reads the time-stamp counter, and on
+// AArch64 the virtual counter. On other platforms it falls back to
+// std::chrono::steady_clock, with ticks measured in nanoseconds.
+class CycleClock {
+ public:
+  // now() returns the current value of the counter in ticks.
+  static inline uint64_t now();
+
+  // calibrate() records the reference point used by toDuration(). Calling
+  // calibrate() early, such as when a Scheduler is constructed, improves the
+  // accuracy of conversions made shortly after.
+  static inline void calibrate();
+
+  // toDuration() converts a number of ticks to a duration.
+  static inline std::chrono::nanoseconds toDuration(uint64_t ticks);
+
+  // toDuration() converts a number of ticks to a duration, using the ratio
+  // returned by an earlier call to nanosecondsPerTick(). Use this form for
+  // conversions that must be consistent with each other, as the ratio may be
+  // refined while the clock is still being calibrated.
+  static inline std::chrono::nanoseconds toDuration(uint64_t ticks,
+                                                    double nsPerTick);
+
+  // nanosecondsPerTick() returns the current estimate of the duration of a
+  // tick in nanoseconds.
+  static inline double nanosecondsPerTick();
+
+ private:
+  using SteadyClock = std::chrono::steady_clock;
+
+  struct Reference {
+    uint64_t ticks;
+    SteadyClock::time_point time;
+  };
+
+  static inline const Reference& reference();
+};
+
+uint64_t CycleClock::now() {
+#if defined(MARL_CYCLE_CLOCK_TSC)
+  return __rdtsc();
+#elif defined(__aarch64__) && !defined(_MSC_VER)
+  uint64_t ticks;
+  asm volatile("mrs %0, cntvct_el0" : "=r"(ticks));
+  return ticks;
+#else
+  return static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          SteadyClock::now().time_since_epoch())
+          .count());
+#endif
+}
+
+void CycleClock::calibrate() {
+  reference();
+}
+
+std::chrono::nanoseconds CycleClock::toDuration(uint64_t ticks) {
+  return toDuration(ticks, nanosecondsPerTick());
+}
+
+std::chrono::nanoseconds CycleClock::toDuration(uint64_t ticks,
+                                                double nsPerTick) {
+  return std::chrono::nanoseconds(
+      static_cast<int64_t>(static_cast<double>(ticks) * nsPerTick));
+}
+
+double CycleClock::nanosecondsPerTick() {
+#if defined(MARL_CYCLE_CLOCK_TSC) || \
+    (defined(__aarch64__) && !defined(_MSC_VER))
+  // The counter frequency is derived from the ticks and time elapsed since
+  // the reference point. Once enough time has elapsed for an accurate ratio,
+  // the ratio is fixed so that conversions are consistent with each other.
+  static std::atomic<double> calibrated = {0};
+  auto nsPerTick = calibrated.load(std::memory_order_relaxed);
+  if (nsPerTick == 0) {
+    const auto minCalibrationTime = std::chrono::milliseconds(1);
+    const auto fixCalibrationTime = std::chrono::milliseconds(100);
+    auto& ref = reference();
+    auto elapsed = SteadyClock::now() - ref.time;
+    if (elapsed < minCalibrationTime) {
+      std::this_thread::sleep_for(minCalibrationTime - elapsed);
+    }
+    auto elapsedTicks = now() - ref.ticks;
+    elapsed = SteadyClock::now() - ref.time;
+    auto elapsedNs =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+    if (elapsedTicks == 0) {
+      return 0;
+    }
+    nsPerTick = static_cast<double>(elapsedNs) / elapsedTicks;
+    if (elapsed >= fixCalibrationTime) {
+      calibrated.store(nsPerTick, std::memory_order_relaxed);
+    }
+  }
+  return nsPerTick;
+#else
+  return 1;
+#endif
+}
+
+const CycleClock::Reference& CycleClock::reference() {
+  static const Reference ref = {now(), SteadyClock::now()};
+  return ref;
+}
+
+}  // namespace marl
+
+#endif  // marl_cycle_clock_h
@@ -0,0 +1,77 @@
+// Copyright 2026 The Marl Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "marl_bench.h"
+
+#include "marl/future.h"
+#include "marl/waitgroup.h"
+
+#include "benchmark/benchmark.h"
+
+#include <vector>
+
+// The FanOut benchmarks schedule numTasks requests that each produce a value,
+// and then sum the values once all the requests have completed. The requests
+// do almost no work, so that the benchmarks measure the cost of passing the
+// values back.
+
+BENCHMARK_DEFINE_F(Schedule, FutureFanOut)(benchmark::State& state) {
+  run(state, [&](int numTasks) {
+    std::vector<marl::Future<uint32_t>> futures;
+    futures.reserve(numTasks);
+    for (auto _ : state) {
+      futures.clear();
+      for (int i = 0; i < numTasks; i++) {
+        marl::Promise<uint32_t> promise;
+        futures.push_back(promise.get_future());
+        marl::schedule([=] { promise.set_value(uint32_t(i) * 3); });
+      }
+      auto sum = marl::when_all(futures.begin(), futures.end()).then([&] {
+        uint32_t total = 0;
+        for (auto& future : futures) {
+          total += future.get();
+        }
+        return total;
+      });
+      benchmark::DoNotOptimize(sum.get());
+    }
+  });
+}
+BENCHMARK_REGISTER_F(Schedule, FutureFanOut)->Apply(Schedule::args<0x4000>);
+
+// FanOutWaitGroup is the hand-written equivalent of the FutureFanOut
+// benchmark: the values are written to a preallocated vector, and a WaitGroup
+// counts the completed requests.
+BENCHMARK_DEFINE_F(Schedule, FanOutWaitGroup)(benchmark::State& state) {
+  run(state, [&](int numTasks) {
+    std::vector<uint32_t> values(numTasks);
+    for (auto _ : state) {
+      marl::WaitGroup wg(numTasks);
+      for (int i = 0; i < numTasks; i++) {
+        marl::schedule([=, &values] {
+          values[i] = uint32_t(i) * 3;
+          wg.done();
+        });
+      }
+      wg.wait();
+      uint32_t total = 0;
+      for (auto value : values) {
+        total += value;
+      }
+      benchmark::DoNotOptimize(total);
+    }
+  });
+}
+BENCHMARK_REGISTER_F(Schedule, FanOutWaitGroup)->Apply(Schedule::args<0x4000>);
@@ -0,0 +1,207 @@
+// Copyright 2026 The Marl Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "marl/future.h"
+#include "marl/event.h"
+#include "marl/select.h"
+#include "marl/waitgroup.h"
+
+#include "marl_test.h"
+
+#include <string>
+#include <vector>
+
+TEST_P(WithBoundScheduler, FutureGet) {
+  marl::Promise<int> promise;
+  auto future = promise.get_future();
+  ASSERT_TRUE(future.valid());
+  ASSERT_FALSE(future.ready());
+  marl::schedule([=] { promise.set_value(42); });
+  ASSERT_EQ(future.get(), 42);
+  ASSERT_TRUE(future.ready());
+  ASSERT_EQ(future.get(), 42);
+}
+
+TEST_P(WithBoundScheduler, FutureWaitFromManyFibers) {
+  constexpr int numWaiters = 32;
+  marl::Promise<std::string> promise;
+  auto future = promise.get_future();
+  marl::WaitGroup wg(numWaiters);
+  std::atomic<int> matched = {0};
+  for (int i = 0; i < numWaiters; i++) {
+    marl::schedule([=, &matched] {
+      if (future.get() == "hello") {
+        matched++;
+      }
+      wg.done();
+    });
+  }
+  promise.set_value("hello");
+  wg.wait();
+  ASSERT_EQ(matched, numWaiters);
+}
+
+TEST_P(WithBoundScheduler, FutureWaitFor) {
+  marl::Promise<int> promise;
+  auto future = promise.get_future();
+  ASSERT_FALSE(future.wait_for(std::chrono::milliseconds(10)));
+  promise.set_value(1);
+  ASSERT_TRUE(future.wait_for(std::chrono::milliseconds(10)));
+}
+
+TEST_P(WithBoundScheduler, FutureVoid) {
+  marl::Promise<void> promise;
+  auto future = promise.get_future();
+  marl::schedule([=] { promise.set_value(); });
+  future.get();
+  ASSERT_TRUE(future.ready());
+}
+
+TEST_P(WithBoundScheduler, FutureThen) {
+  marl::Promise<int> promise;
+  auto future = promise.get_future();
+  auto doubled = future.then([](int value) { return value * 2; });
+  auto str = doubled.then([](int value) { return std::to_string(value); });
+  std::atomic<bool> called = {false};
+  auto done = str.then([&](const std::string&) { called = true; });
+  ASSERT_FALSE(str.ready());
+  promise.set_value(21);
+  done.wait();
+  ASSERT_TRUE(called);
+  ASSERT_EQ(doubled.get(), 42);
+  ASSERT_EQ(str.get(), "42");
+
+  // A continuation of a ready future is scheduled immediately.
+  auto again = future.then([](int value) { return value + 1; });
+  ASSERT_EQ(again.get(), 22);
+  auto fromVoid = done.then([] { return 7; });
+  ASSERT_EQ(fromVoid.get(), 7);
+}
+
+TEST_P(WithBoundScheduler, FutureWhenAll) {
+  constexpr int numFutures = 16;
+  std::vector<marl::Promise<int>> promises(numFutures);
+  std::vector<marl::Future<int>> futures;
+  for (auto& promise : promises) {
+    futures.push_back(promise.get_future());
+  }
+  auto all = marl::when_all(futures.begin(), futures.end());
+  for (int i = 0; i < numFutures; i++) {
+    ASSERT_FALSE(all.ready());
+    auto promise = promises[i];
+    marl::schedule([=] { promise.set_value(i); });
+  }
+  auto sum = all.then([=] {
+    int total = 0;
+    for (auto& future : futures) {
+      total += future.get();
+    }
+    return total;
+  });
+  ASSERT_EQ(sum.get(), numFutures * (numFutures - 1) / 2);
+
+  std::vector<marl::Future<int>> none;
+  ASSERT_TRUE(marl::when_all(none.begin(), none.end()).ready());
+}
+
+TEST_P(WithBoundScheduler, FutureWhenAllMixed) {
+  marl::Promise<int> a;
+  marl::Promise<void> b;
+  marl::Promise<std::string> c;
+  auto all = marl::when_all(a.get_future(), b.get_future(), c.get_future());
+  a.set_value(1);
+  b.set_value();
+  ASSERT_FALSE(all.ready());
+  c.set_value("c");
+  all.wait();
+}
+
+TEST_P(WithBoundScheduler, FutureWhenAny) {
+  marl::Promise<int> a;
+  marl::Promise<std::string> b;
+  auto any = marl::when_any(a.get_future(), b.get_future());
+  ASSERT_FALSE(any.ready());
+  marl::schedule([=] { b.set_value("b"); });
+  ASSERT_EQ(any.get(), 1u);
+  a.set_value(1);
+  ASSERT_EQ(any.get(), 1u);
+
+  std::vector<marl::Promise<int>> promises(4);
+  std::vector<marl::Future<int>> futures;
+  for (auto& promise : promises) {
+    futures.push_back(promise.get_future());
+  }
+  auto first = marl::when_any(futures.begin(), futures.end());
+  promises[2].set_value(2);
+  ASSERT_EQ(first.get(), 2u);
+  for (auto& promise : promises) {
+    if (!promise.get_future().ready()) {
+      promise.set_value(0);
+    }
+  }
+}
+
+TEST_P(WithBoundScheduler, FutureSelect) {
+  marl::Promise<int> promise;
+  auto future = promise.get_future();
+  marl::Event never;
+  marl::schedule([=] { promise.set_value(3); });
+  ASSERT_EQ(marl::select(never.onSignal(), future.onReady()), 1);
+  ASSERT_EQ(future.get(), 3);
+}
+
+TEST_F(WithoutBoundScheduler, FutureSingleAllocation) {
+  {
+    marl::Promise<int> promise(allocator);
+    auto future = promise.get_future();
+    auto copy = future;
+    ASSERT_EQ(allocator->stats().numAllocations(), 1u);
+    promise.set_value(5);
+    ASSERT_EQ(copy.get(), 5);
+  }
+  // The continuation runs on the thread that sets the value, as no scheduler
+  // is bound.
+  marl::Promise<int> promise(allocator);
+  auto plusOne = promise.get_future().then([](int v) { return v + 1; });
+  promise.set_value(1);
+  ASSERT_TRUE(plusOne.ready());
+  ASSERT_EQ(plusOne.get(), 2);
+}
+
+TEST_F(WithoutBoundScheduler, FutureUnfulfilledPromise) {
+  // Continuations of a Promise that is destructed without setting the value
+  // are discarded, freeing the states they reference.
+  {
+    marl::Promise<int> promise(allocator);
+    auto future = promise.get_future();
+    auto chained = future.then([](int v) { return v + 1; })
+                       .then([](int v) { return v * 2; });
+    auto all = marl::when_all(future, chained);
+    auto any = marl::when_any(future, chained);
+    ASSERT_FALSE(all.ready());
+    ASSERT_FALSE(any.ready());
+  }
+  {
+    marl::Future<int> future;
+    {
+      marl::Promise<int> promise(allocator);
+      future = promise.get_future();
+    }
+    // then() on a Future that can no longer become ready.
+    auto chained = future.then([](int v) { return v + 1; });
+    ASSERT_FALSE(chained.ready());
+  }
+  ASSERT_EQ(allocator->stats().numAllocations(), 0u);
+}
@@ -17,7 +17,18 @@
 #include "marl/debug.h"
 #include "marl/sanitizers.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cstring>
+#include <thread>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define MARL_RETURN_ADDRESS() _ReturnAddress()
+#else
+#define MARL_RETURN_ADDRESS() __builtin_return_address(0)
+#endif
 
 #if defined(__linux__) || defined(__FreeBSD__) || defined(__APPLE__) || defined(__EMSCRIPTEN__)
 #include <sys/mman.h>
@@ -247,3 +258,297 @@ size_t pageSize() {
 }
 
 }  // namespace marl
+
+///////////////////////////////////////////////////////////////////////////////
+// TrackedAllocator
+///////////////////////////////////////////////////////////////////////////////
+namespace {
+
+constexpr size_t NumUsages = size_t(marl::Allocation::Usage::Count);
+
+// Number of TrackedAllocator shards cached by each thread.
+constexpr size_t NumCachedShards = 8;
+
+// ShardCache maps the identifiers of the TrackedAllocators recently used by a
+// thread to the thread's shards. Identifiers are never reused, so the entries
+// of destructed allocators are never matched.
+struct ShardCache {
+  uint64_t ids[NumCachedShards];
+  void* shards[NumCachedShards];
+};
+
+thread_local ShardCache shardCache;
+
+std::atomic<uint64_t> nextTrackedAllocatorId = {1};
+
+// CallSiteEntry is an entry in the open-addressed call site table.
+struct CallSiteEntry {
+  std::atomic<uintptr_t> address = {0};
+  std::atomic<uint64_t> samples = {0};
+};
+
+// sizeBucket() returns the histogram bucket for an allocation of size bytes.
+inline size_t sizeBucket(size_t size) {
+  size_t bucket = 0;
+  while (bucket < marl::TrackedAllocator::NumSizeBuckets - 1 &&
+         (size_t(1) << bucket) < size) {
+    bucket++;
+  }
+  return bucket;
+}
+
+// add() adds delta to a counter that is only written by the calling thread,
+// so it does not need an atomic read-modify-write.
+template <typename T>
+inline void add(std::atomic<T>& counter, T delta) {
+  counter.store(counter.load(std::memory_order_relaxed) + delta,
+                std::memory_order_relaxed);
+}
+
+}  // anonymous namespace
+
+namespace marl {
+
+// Shard holds the counters of a single thread. The counters are only written
+// by the owning thread, and are read by stats(). Counters may be negative if
+// memory is freed by a different thread to the one that allocated it.
+// A shard is reused by a later thread with the same identifier.
+struct alignas(64) TrackedAllocator::Shard {
+  inline Shard(std::thread::id owner);
+
+  const std::thread::id owner;
+  Shard* next = nullptr;
+  std::atomic<int64_t> count[NumUsages];
+  std::atomic<int64_t> bytes[NumUsages];
+  std::atomic<uint64_t> histogram[NumSizeBuckets];
+  int64_t unpublished[NumUsages] = {};  // Only accessed by the owner.
+  uint32_t sampleCounter = 0;           // Only accessed by the owner.
+};
+
+TrackedAllocator::Shard::Shard(std::thread::id owner) : owner(owner) {
+  for (size_t u = 0; u < NumUsages; u++) {
+    count[u] = 0;
+    bytes[u] = 0;
+  }
+  for (auto& bucket : histogram) {
+    bucket = 0;
+  }
+}
+
+// Shared holds the state of the allocator that is written by all threads.
+struct alignas(64) TrackedAllocator::Shared {
+  inline Shared();
+
+  std::atomic<int64_t> published[NumUsages];
+  std::atomic<int64_t> peak[NumUsages];
+  // Exact totals, only maintained by debug builds to check each free().
+  std::atomic<int64_t> count[NumUsages];
+  std::atomic<int64_t> bytes[NumUsages];
+  // The call site table, or nullptr if call site sampling is disabled.
+  CallSiteEntry* sites = nullptr;
+};
+
+TrackedAllocator::Shared::Shared() {
+  for (size_t u = 0; u < NumUsages; u++) {
+    published[u] = 0;
+    peak[u] = 0;
+    count[u] = 0;
+    bytes[u] = 0;
+  }
+}
+
+TrackedAllocator::TrackedAllocator(Allocator* allocator_)
+    : TrackedAllocator(allocator_, Config{}) {}
+
+TrackedAllocator::TrackedAllocator(Allocator* allocator_,
+                                   const Config& config_)
+    : allocator(allocator_),
+      config(config_),
+      id(nextTrackedAllocatorId++),
+      shared(allocator->create<Shared>()) {
+  if (config.callSiteSampleRate > 0) {
+    Allocation::Request request;
+    request.size = sizeof(CallSiteEntry) * MaxCallSites;
+    request.alignment = alignof(CallSiteEntry);
+    auto sites = reinterpret_cast<CallSiteEntry*>(
+        allocator->allocate(request).ptr);
+    for (size_t i = 0; i < MaxCallSites; i++) {
+      new (&sites[i]) CallSiteEntry();
+    }
+    shared->sites = sites;
+  }
+}
+
+TrackedAllocator::~TrackedAllocator() {
+  while (shards != nullptr) {
+    auto next = shards->next;
+    allocator->destroy(shards);
+    shards = next;
+  }
+  if (shared->sites != nullptr) {
+    Allocation allocation;
+    allocation.ptr = shared->sites;
+    allocation.request.size = sizeof(CallSiteEntry) * MaxCallSites;
+    allocation.request.alignment = alignof(CallSiteEntry);
+    allocator->free(allocation);
+  }
+  allocator->destroy(shared);
+}
+
+TrackedAllocator::Stats TrackedAllocator::stats() {
+  int64_t count[NumUsages] = {};
+  int64_t bytes[NumUsages] = {};
+  Stats out;
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    for (auto s = shards; s != nullptr; s = s->next) {
+      for (size_t u = 0; u < NumUsages; u++) {
+        count[u] += s->count[u].load(std::memory_order_relaxed);
+        bytes[u] += s->bytes[u].load(std::memory_order_relaxed);
+      }
+      for (size_t b = 0; b < NumSizeBuckets; b++) {
+        out.sizeHistogram[b] += static_cast<size_t>(
+            s->histogram[b].load(std::memory_order_relaxed));
+      }
+    }
+  }
+  for (size_t u = 0; u < NumUsages; u++) {
+    MARL_ASSERT(count[u] >= 0 && bytes[u] >= 0,
+                "TrackedAllocator detected abnormal free()");
+    auto& usageStats = out.byUsage[u];
+    usageStats.count = static_cast<size_t>(count[u]);
+    usageStats.bytes = static_cast<size_t>(bytes[u]);
+    usageStats.peakBytes = std::max(
+        usageStats.bytes,
+        static_cast<size_t>(shared->peak[u].load(std::memory_order_relaxed)));
+  }
+  return out;
+}
+
+size_t TrackedAllocator::callSites(CallSite* out, size_t count) {
+  auto sites = shared->sites;
+  if (sites == nullptr) {
+    return 0;
+  }
+  std::vector<CallSite> all;
+  for (size_t i = 0; i < MaxCallSites; i++) {
+    auto address = sites[i].address.load(std::memory_order_acquire);
+    if (address != 0) {
+      CallSite site;
+      site.address = reinterpret_cast<void*>(address);
+      site.samples = static_cast<size_t>(
+          sites[i].samples.load(std::memory_order_relaxed));
+      all.push_back(site);
+    }
+  }
+  std::sort(all.begin(), all.end(), [](const CallSite& a, const CallSite& b) {
+    return a.samples > b.samples;
+  });
+  count = std::min(count, all.size());
+  std::copy(all.begin(), all.begin() + count, out);
+  return count;
+}
+
+TrackedAllocator::Shard& TrackedAllocator::shard() {
+  auto slot = id % NumCachedShards;
+  if (shardCache.ids[slot] == id) {
+    return *reinterpret_cast<Shard*>(shardCache.shards[slot]);
+  }
+
+  // Find the shard of a previous thread with the same identifier, or
+  // register a new shard.
+  auto self = std::this_thread::get_id();
+  Shard* found = nullptr;
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    for (auto s = shards; s != nullptr; s = s->next) {
+      if (s->owner == self) {
+        found = s;
+        break;
+      }
+    }
+    if (found == nullptr) {
+      found = allocator->create<Shard>(self);
+      found->next = shards;
+      shards = found;
+    }
+  }
+  shardCache.ids[slot] = id;
+  shardCache.shards[slot] = found;
+  return *found;
+}
+
+Allocation TrackedAllocator::allocate(const Allocation::Request& request) {
+  auto& s = shard();
+  auto usage = size_t(request.usage);
+  auto size = static_cast<int64_t>(request.size);
+  add<int64_t>(s.count[usage], 1);
+  add<int64_t>(s.bytes[usage], size);
+  add<uint64_t>(s.histogram[sizeBucket(request.size)], 1);
+#if MARL_DEBUG_ENABLED
+  shared->count[usage].fetch_add(1, std::memory_order_relaxed);
+  shared->bytes[usage].fetch_add(size, std::memory_order_relaxed);
+#endif
+
+  // Publish the bytes allocated by this thread in batches to track the peak.
+  auto& unpublished = s.unpublished[usage];
+  unpublished += size;
+  if (unpublished >= PeakGranularity) {
+    auto current = shared->published[usage].fetch_add(
+                       unpublished, std::memory_order_relaxed) +
+                   unpublished;
+    unpublished = 0;
+    auto& peak = shared->peak[usage];
+    auto highest = peak.load(std::memory_order_relaxed);
+    while (current > highest &&
+           !peak.compare_exchange_weak(highest, current,
+                                       std::memory_order_relaxed)) {
+    }
+  }
+
+  if (auto sites = shared->sites) {
+    if (s.sampleCounter++ % config.callSiteSampleRate == 0) {
+      auto key = reinterpret_cast<uintptr_t>(MARL_RETURN_ADDRESS());
+      auto hash = static_cast<size_t>((key * 0x9e3779b97f4a7c15ULL) >> 32);
+      for (size_t i = 0; i < MaxCallSites; i++) {
+        auto& entry = sites[(hash + i) % MaxCallSites];
+        auto existing = entry.address.load(std::memory_order_acquire);
+        if (existing == 0 &&
+            entry.address.compare_exchange_strong(existing, key,
+                                                  std::memory_order_acq_rel)) {
+          existing = key;
+        }
+        if (existing == key) {
+          entry.samples.fetch_add(1, std::memory_order_relaxed);
+          break;
+        }
+      }
+      // If the table is full, the sample is dropped.
+    }
+  }
+  return allocator->allocate(request);
+}
+
+void TrackedAllocator::free(const Allocation& allocation) {
+  auto& s = shard();
+  auto usage = size_t(allocation.request.usage);
+  auto size = static_cast<int64_t>(allocation.request.size);
+#if MARL_DEBUG_ENABLED
+  auto count = shared->count[usage].fetch_sub(1, std::memory_order_relaxed);
+  auto bytes = shared->bytes[usage].fetch_sub(size, std::memory_order_relaxed);
+  MARL_ASSERT(count > 0, "TrackedAllocator detected abnormal free()");
+  MARL_ASSERT(bytes >= size, "TrackedAllocator detected abnormal free()");
+#endif
+  add<int64_t>(s.count[usage], -1);
+  add<int64_t>(s.bytes[usage], -size);
+
+  auto& unpublished = s.unpublished[usage];
+  unpublished -= size;
+  if (unpublished <= -PeakGranularity) {
+    shared->published[usage].fetch_add(unpublished, std::memory_order_relaxed);
+    unpublished = 0;
+  }
+  return allocator->free(allocation);
+}
+
+}  // namespace marl
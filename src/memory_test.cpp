@@ -16,6 +16,9 @@
 
 #include "marl_test.h"
 
+#include <thread>
+#include <vector>
+
 class AllocatorTest : public testing::Test {
  public:
   marl::Allocator* allocator = marl::Allocator::Default;
@@ -87,3 +90,82 @@ TEST_F(AllocatorTest, Guards) {
   EXPECT_DEATH(ptr[marl::pageSize()] = 1, "");
 }
 #endif
+
+TEST_F(AllocatorTest, TrackedAllocatorStats) {
+  marl::TrackedAllocator tracked(allocator);
+
+  marl::Allocation::Request request;
+  request.size = 100;
+  request.alignment = 8;
+  request.usage = marl::Allocation::Usage::Create;
+
+  std::vector<marl::Allocation> allocations;
+  for (int i = 0; i < 1000; i++) {
+    allocations.push_back(tracked.allocate(request));
+  }
+
+  auto stats = tracked.stats();
+  auto& create = stats.byUsage[size_t(marl::Allocation::Usage::Create)];
+  ASSERT_EQ(stats.numAllocations(), 1000U);
+  ASSERT_EQ(stats.bytesAllocated(), 100000U);
+  ASSERT_EQ(create.count, 1000U);
+  ASSERT_EQ(create.bytes, 100000U);
+  ASSERT_EQ(create.peakBytes, 100000U);
+  ASSERT_EQ(stats.sizeHistogram[7], 1000U);  // (64, 128]
+
+  // Free on another thread.
+  std::thread([&] {
+    for (auto& allocation : allocations) {
+      tracked.free(allocation);
+    }
+  }).join();
+
+  stats = tracked.stats();
+  ASSERT_EQ(stats.numAllocations(), 0U);
+  ASSERT_EQ(stats.bytesAllocated(), 0U);
+  // The peak is published in batches, so may be slightly underestimated.
+  auto peak = stats.byUsage[size_t(marl::Allocation::Usage::Create)].peakBytes;
+  ASSERT_LE(peak, 100000U);
+  ASSERT_GE(peak, 100000U - size_t(marl::TrackedAllocator::PeakGranularity));
+  ASSERT_EQ(stats.sizeHistogram[7], 1000U);
+}
+
+#if GTEST_HAS_DEATH_TEST && MARL_DEBUG_ENABLED
+TEST_F(AllocatorTest, TrackedAllocatorAbnormalFree) {
+  marl::TrackedAllocator tracked(allocator);
+  marl::Allocation::Request request;
+  request.size = 16;
+  request.alignment = 8;
+  auto allocation = tracked.allocate(request);
+  tracked.free(allocation);
+  // Freeing more than was allocated is detected by the free() itself, even
+  // when the free is made on a different thread to the allocation.
+  EXPECT_DEATH(std::thread([&] { tracked.free(allocation); }).join(),
+               "abnormal free");
+}
+#endif
+
+TEST_F(AllocatorTest, TrackedAllocatorCallSites) {
+  marl::TrackedAllocator::Config config;
+  config.callSiteSampleRate = 1;
+  marl::TrackedAllocator tracked(allocator, config);
+
+  for (int i = 0; i < 10; i++) {
+    tracked.destroy(tracked.create<int>());
+  }
+  std::vector<marl::TrackedAllocator::CallSite> sites(
+      marl::TrackedAllocator::MaxCallSites);
+  sites.resize(tracked.callSites(sites.data(), sites.size()));
+  ASSERT_GE(sites.size(), 1U);
+  size_t samples = 0;
+  for (auto& site : sites) {
+    ASSERT_NE(site.address, nullptr);
+    samples += site.samples;
+  }
+  ASSERT_EQ(samples, 10U);
+
+  // Sampling disabled.
+  marl::TrackedAllocator untracked(allocator);
+  untracked.destroy(untracked.create<int>());
+  ASSERT_EQ(untracked.callSites(sites.data(), sites.size()), 0U);
+}
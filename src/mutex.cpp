@@ -0,0 +1,161 @@
+// Copyright 2026 The Marl Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "marl/mutex.h"
+
+#if MARL_MUTEX_STATS_ENABLED
+
+#include "cycleclock.h"
+
+#include <atomic>
+#include <cstring>
+#include <list>
+
+namespace marl {
+
+// mutex::Stats holds the lock statistics of all the mutexes of a single name.
+// The counters are updated by all the threads that use the mutexes.
+struct mutex::Stats {
+  inline Stats(const char* name);
+
+  const char* const name;
+  std::atomic<uint64_t> acquisitions = {0};
+  std::atomic<uint64_t> contended = {0};
+  std::atomic<uint64_t> waitTicks = {0};
+  std::atomic<uint64_t> holdTicks = {0};
+};
+
+mutex::Stats::Stats(const char* name) : name(name) {}
+
+// mutex::Registry holds the statistics of every name of mutex. Stats are never
+// removed, so that mutexes can hold pointers to their Stats.
+struct mutex::Registry {
+  std::mutex guard;
+  std::list<Stats> stats;  // Guarded by guard.
+
+  static inline Registry& get();
+};
+
+mutex::Registry& mutex::Registry::get() {
+  static Registry* registry = new Registry();  // Never destructed.
+  return *registry;
+}
+
+namespace {
+
+const char* const unnamed = "<unnamed>";
+
+inline void add(std::atomic<uint64_t>& counter, uint64_t value) {
+  counter.fetch_add(value, std::memory_order_relaxed);
+}
+
+}  // anonymous namespace
+
+mutex::Stats* mutex::getStats(const char* name) {
+  if (name == nullptr) {
+    name = unnamed;
+  }
+  auto& registry = Registry::get();
+  std::unique_lock<std::mutex> lock(registry.guard);
+  for (auto& stats : registry.stats) {
+    if (stats.name == name || strcmp(stats.name, name) == 0) {
+      return &stats;
+    }
+  }
+  registry.stats.emplace_back(name);
+  return &registry.stats.back();
+}
+
+std::mutex& mutex::acquire() {
+  if (_.try_lock()) {
+    heldSince = CycleClock::now();
+  } else {
+    auto start = CycleClock::now();
+    _.lock();
+    heldSince = CycleClock::now();
+    add(stats->contended, 1);
+    add(stats->waitTicks, heldSince - start);
+  }
+  add(stats->acquisitions, 1);
+  return _;
+}
+
+bool mutex::tryAcquire() {
+  if (!_.try_lock()) {
+    return false;
+  }
+  heldSince = CycleClock::now();
+  add(stats->acquisitions, 1);
+  return true;
+}
+
+void mutex::release() {
+  endHold();
+  _.unlock();
+}
+
+void mutex::beginHold() {
+  heldSince = CycleClock::now();
+}
+
+void mutex::endHold() {
+  add(stats->holdTicks, CycleClock::now() - heldSince);
+}
+
+std::vector<MutexStats> mutexStats() {
+  auto nsPerTick = CycleClock::nanosecondsPerTick();
+  auto& registry = mutex::Registry::get();
+  std::unique_lock<std::mutex> lock(registry.guard);
+  std::vector<MutexStats> out;
+  out.reserve(registry.stats.size());
+  for (auto& stats : registry.stats) {
+    MutexStats s;
+    s.name = stats.name;
+    s.acquisitions = stats.acquisitions.load(std::memory_order_relaxed);
+    s.contended = stats.contended.load(std::memory_order_relaxed);
+    s.waitTime = CycleClock::toDuration(
+        stats.waitTicks.load(std::memory_order_relaxed), nsPerTick);
+    s.holdTime = CycleClock::toDuration(
+        stats.holdTicks.load(std::memory_order_relaxed), nsPerTick);
+    out.push_back(s);
+  }
+  return out;
+}
+
+void resetMutexStats() {
+  auto& registry = mutex::Registry::get();
+  std::unique_lock<std::mutex> lock(registry.guard);
+  for (auto& stats : registry.stats) {
+    stats.acquisitions.store(0, std::memory_order_relaxed);
+    stats.contended.store(0, std::memory_order_relaxed);
+    stats.waitTicks.store(0, std::memory_order_relaxed);
+    stats.holdTicks.store(0, std::memory_order_relaxed);
+  }
+}
+
+}  // namespace marl
+
+#else  // MARL_MUTEX_STATS_ENABLED
+
+namespace marl {
+
+std::vector<MutexStats> mutexStats() {
+  return {};
+}
+
+void resetMutexStats() {}
+
+}  // namespace marl
+
+#endif  // MARL_MUTEX_STATS_ENABLED
@@ -0,0 +1,86 @@
+// Copyright 2026 The Marl Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "marl/mutex.h"
+
+#include "marl_test.h"
+
+#include "marl/waitgroup.h"
+
+#include <cstring>
+#include <thread>
+
+namespace {
+
+// statsOf() returns the statistics of the mutexes with the given name.
+marl::MutexStats statsOf(const char* name) {
+  for (auto& stats : marl::mutexStats()) {
+    if (strcmp(stats.name, name) == 0) {
+      return stats;
+    }
+  }
+  return {};
+}
+
+}  // anonymous namespace
+
+#if MARL_MUTEX_STATS_ENABLED
+
+TEST_F(WithoutBoundScheduler, MutexStats) {
+  marl::mutex a("MutexStatsTest");
+  marl::mutex b("MutexStatsTest");
+  marl::resetMutexStats();
+
+  { marl::lock lock(a); }
+  b.lock();
+  b.unlock();
+  ASSERT_TRUE(a.try_lock());
+  ASSERT_FALSE(a.try_lock());
+  std::thread thread([&] {
+    marl::lock lock(a);  // Contended.
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  a.unlock();
+  thread.join();
+
+  auto stats = statsOf("MutexStatsTest");
+  ASSERT_EQ(stats.acquisitions, 4U);
+  ASSERT_EQ(stats.contended, 1U);
+  ASSERT_GE(stats.waitTime, std::chrono::milliseconds(1));
+  ASSERT_GE(stats.holdTime, std::chrono::milliseconds(4));
+}
+
+TEST_P(WithBoundScheduler, MutexStatsScheduler) {
+  marl::resetMutexStats();
+  marl::WaitGroup wg(10);
+  for (int i = 0; i < 10; i++) {
+    marl::schedule([=] { wg.done(); });
+  }
+  wg.wait();
+  ASSERT_GT(statsOf("marl::WaitGroup").acquisitions, 0U);
+  if (GetParam().numWorkerThreads > 0) {
+    ASSERT_GT(statsOf("marl::Scheduler::Worker::Work").acquisitions, 0U);
+  }
+}
+
+#else  // MARL_MUTEX_STATS_ENABLED
+
+TEST_F(WithoutBoundScheduler, MutexStatsDisabled) {
+  marl::mutex mutex("MutexStatsTest");
+  { marl::lock lock(mutex); }
+  ASSERT_EQ(statsOf("MutexStatsTest").acquisitions, 0U);
+  ASSERT_EQ(marl::mutexStats().size(), 0U);
+}
+
+#endif  // MARL_MUTEX_STATS_ENABLED
@@ -20,9 +20,11 @@
 
 #include "benchmark/benchmark.h"
 
+#include <algorithm>
 #include <mutex>
 #include <queue>
 #include <thread>
+#include <vector>
 
 namespace {
 
@@ -164,4 +166,49 @@ static void MultiQueueTaskExecutor(benchmark::State& state) {
     }
   }
 }
-BENCHMARK(MultiQueueTaskExecutor)->Apply(Schedule::args);
\ No newline at end of file
+BENCHMARK(MultiQueueTaskExecutor)->Apply(Schedule::args);
+
+// A multi-thread loop that applies a cheap transform to each element of an
+// array, statically partitioned into a contiguous chunk per thread.
+// Comparable to the ParallelFor benchmarks in parallelfor_bench.cpp.
+static void StaticChunkedLoop(benchmark::State& state) {
+  auto const numElements = Schedule::numTasks(state);
+  auto const numThreads = Schedule::numThreads(state);
+
+  std::vector<uint32_t> data(numElements);
+  auto loop = [&](int begin, int end) {
+    for (int i = begin; i < end; i++) {
+      data[i] = data[i] * 3 + 1;
+    }
+  };
+
+  for (auto _ : state) {
+    if (numThreads > 0) {
+      state.PauseTiming();
+      Event start;
+
+      // Set up the threads.
+      auto const chunkSize = (numElements + numThreads - 1) / numThreads;
+      std::vector<std::thread> threads;
+      for (int i = 0; i < numThreads; i++) {
+        threads.emplace_back(std::thread([&, i] {
+          start.wait();
+          loop(i * chunkSize, std::min((i + 1) * chunkSize, numElements));
+        }));
+      }
+
+      state.ResumeTiming();
+      start.signal();
+
+      // Wait for all threads to finish.
+      for (auto& thread : threads) {
+        thread.join();
+      }
+    } else {
+      // Single-threaded test - just run the loop.
+      loop(0, numElements);
+    }
+  }
+  benchmark::DoNotOptimize(data.data());
+}
+BENCHMARK(StaticChunkedLoop)->Apply(Schedule::args<0x400000>);
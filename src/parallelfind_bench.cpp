@@ -0,0 +1,38 @@
+// Copyright 2026 The Marl Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "marl_bench.h"
+
+#include "marl/parallelfind.h"
+
+#include "benchmark/benchmark.h"
+
+#include <vector>
+
+// ParallelFindIf searches an array of numTasks elements for the single
+// element that matches, which is a quarter of the way into the array. Compare
+// with the ParallelFor benchmark, which visits every element.
+BENCHMARK_DEFINE_F(Schedule, ParallelFindIf)(benchmark::State& state) {
+  run(state, [&](int numElements) {
+    std::vector<uint32_t> data(numElements);
+    data[numElements / 4] = 1;
+    for (auto _ : state) {
+      benchmark::DoNotOptimize(marl::parallel_find_if(
+          0, numElements, 0x4000, [&](int i) { return data[i] != 0; }));
+    }
+  });
+}
+BENCHMARK_REGISTER_F(Schedule, ParallelFindIf)
+    ->Apply(Schedule::args<0x400000>);
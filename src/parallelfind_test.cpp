@@ -0,0 +1,76 @@
+// Copyright 2026 The Marl Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "marl_test.h"
+
+#include "marl/defer.h"
+#include "marl/parallelfind.h"
+
+TEST_P(WithBoundScheduler, ParallelFindIf) {
+  constexpr int count = 10000;
+  for (size_t grain : {1, 7, 100, 20000}) {
+    for (int match : {0, 1, 4999, 9999}) {
+      // Every index from match upwards matches, so only the lowest is correct.
+      auto found = marl::parallel_find_if(0, count, grain,
+                                          [&](int i) { return i >= match; });
+      ASSERT_EQ(found, match) << "grain: " << grain;
+    }
+    auto found =
+        marl::parallel_find_if(0, count, grain, [](int) { return false; });
+    ASSERT_EQ(found, count) << "grain: " << grain;
+  }
+}
+
+TEST_P(WithBoundScheduler, ParallelFindIfOffsetRange) {
+  auto found = marl::parallel_find_if(
+      -100, 100, 3, [](int i) { return i > 0 && i % 7 == 0; });
+  ASSERT_EQ(found, 7);
+  ASSERT_EQ(marl::parallel_find_if(5, 5, 1, [](int) { return true; }), 5);
+}
+
+TEST_P(WithBoundScheduler, ParallelAnyOf) {
+  constexpr int count = 10000;
+  ASSERT_TRUE(
+      marl::parallel_any_of(0, count, 16, [](int i) { return i == 1234; }));
+  ASSERT_FALSE(
+      marl::parallel_any_of(0, count, 16, [](int i) { return i == count; }));
+  ASSERT_FALSE(marl::parallel_any_of(0, 0, 16, [](int) { return true; }));
+}
+
+TEST_F(WithoutBoundScheduler, ParallelFindIfStopsEarly) {
+  // Without worker threads, the chunks are run in order on the calling thread,
+  // so the number of predicate calls is exact.
+  marl::Scheduler::Config cfg;
+  cfg.setAllocator(allocator);
+  marl::Scheduler scheduler(cfg);
+  scheduler.bind();
+  defer(scheduler.unbind());
+
+  constexpr int count = 1000000;
+  int calls = 0;
+  auto found = marl::parallel_find_if(0, count, 100, [&](int i) {
+    calls++;
+    return i == 10;
+  });
+  ASSERT_EQ(found, 10);
+  ASSERT_EQ(calls, 11);
+
+  calls = 0;
+  ASSERT_TRUE(marl::parallel_any_of(0, count, 100, [&](int i) {
+    calls++;
+    return i == 150;
+  }));
+  ASSERT_EQ(calls, 151);
+}
@@ -0,0 +1,106 @@
+// Copyright 2026 The Marl Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "marl_bench.h"
+
+#include "marl/parallelfor.h"
+#include "marl/waitgroup.h"
+
+#include "benchmark/benchmark.h"
+
+#include <algorithm>
+#include <vector>
+
+// The ParallelFor benchmarks apply a cheap transform to each element of an
+// array of numTasks elements. See also the StaticChunkedLoop benchmark in
+// non_marl_bench.cpp.
+
+BENCHMARK_DEFINE_F(Schedule, ParallelFor)(benchmark::State& state) {
+  run(state, [&](int numElements) {
+    std::vector<uint32_t> data(numElements);
+    for (auto _ : state) {
+      marl::parallel_for(0, numElements, 0x4000,
+                         [&](int i) { data[i] = data[i] * 3 + 1; });
+    }
+    benchmark::DoNotOptimize(data.data());
+  });
+}
+BENCHMARK_REGISTER_F(Schedule, ParallelFor)->Apply(Schedule::args<0x400000>);
+
+// ParallelForManualChunking schedules a task for each of an equal number of
+// chunks per thread, and waits on a WaitGroup.
+BENCHMARK_DEFINE_F(Schedule, ParallelForManualChunking)
+(benchmark::State& state) {
+  run(state, [&](int numElements) {
+    std::vector<uint32_t> data(numElements);
+    const int numChunks = 4 * std::max(numThreads(state), 1);
+    const int chunkSize = (numElements + numChunks - 1) / numChunks;
+    for (auto _ : state) {
+      marl::WaitGroup wg(numChunks);
+      for (int chunk = 0; chunk < numChunks; chunk++) {
+        marl::schedule([&, wg, chunk] {
+          auto begin = chunk * chunkSize;
+          auto end = std::min(begin + chunkSize, numElements);
+          for (int i = begin; i < end; i++) {
+            data[i] = data[i] * 3 + 1;
+          }
+          wg.done();
+        });
+      }
+      wg.wait();
+    }
+    benchmark::DoNotOptimize(data.data());
+  });
+}
+BENCHMARK_REGISTER_F(Schedule, ParallelForManualChunking)
+    ->Apply(Schedule::args<0x400000>);
+
+// The ParallelForIterative benchmarks repeatedly transform an array small
+// enough to stay in the combined caches of the workers, as an iterative solver
+// would. ParallelForAffinity reuses an AffinityPartitioner across the loops,
+// so each worker transforms the same part of the array each time.
+BENCHMARK_DEFINE_F(Schedule, ParallelForIterative)(benchmark::State& state) {
+  run(state, [&](int numElements) {
+    std::vector<uint32_t> data(numElements);
+    for (auto _ : state) {
+      for (int iteration = 0; iteration < 16; iteration++) {
+        marl::parallel_for(0, numElements, 0x400,
+                           [&](int i) { data[i] = data[i] * 3 + 1; });
+      }
+    }
+    benchmark::DoNotOptimize(data.data());
+  });
+}
+BENCHMARK_REGISTER_F(Schedule, ParallelForIterative)
+    ->Apply(Schedule::args<0x40000>);
+
+BENCHMARK_DEFINE_F(Schedule, ParallelForAffinity)(benchmark::State& state) {
+  run(state, [&](int numElements) {
+    std::vector<uint32_t> data(numElements);
+    marl::AffinityPartitioner partitioner;
+    for (auto _ : state) {
+      for (int iteration = 0; iteration < 16; iteration++) {
+        marl::parallel_for(0, numElements, 0x400, partitioner,
+                           [&](int begin, int end) {
+                             for (int i = begin; i < end; i++) {
+                               data[i] = data[i] * 3 + 1;
+                             }
+                           });
+      }
+    }
+    benchmark::DoNotOptimize(data.data());
+  });
+}
+BENCHMARK_REGISTER_F(Schedule, ParallelForAffinity)
+    ->Apply(Schedule::args<0x40000>);
@@ -0,0 +1,83 @@
+// Copyright 2026 The Marl Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "marl_test.h"
+
+#include "marl/parallelfor.h"
+
+#include <atomic>
+#include <vector>
+
+TEST_P(WithBoundScheduler, ParallelFor) {
+  constexpr int count = 10000;
+  std::vector<int> calls(count);
+  for (size_t grain : {1, 7, 100, 20000}) {
+    std::fill(calls.begin(), calls.end(), 0);
+    marl::parallel_for(0, count, grain, [&](int i) { calls[i]++; });
+    for (int i = 0; i < count; i++) {
+      ASSERT_EQ(calls[i], 1) << "grain: " << grain << ", i: " << i;
+    }
+  }
+}
+
+TEST_P(WithBoundScheduler, ParallelForEmptyRange) {
+  int calls = 0;
+  marl::parallel_for(5, 5, 1, [&](int) { calls++; });
+  marl::parallel_for(5, 3, 1, [&](int) { calls++; });
+  ASSERT_EQ(calls, 0);
+}
+
+TEST_P(WithBoundScheduler, ParallelForOffsetRange) {
+  std::atomic<uint64_t> sum = {0};
+  marl::parallel_for(uint64_t(1000), uint64_t(2000), 16,
+                     [&](uint64_t i) { sum += i; });
+  ASSERT_EQ(sum.load(), 1499500U);
+}
+
+TEST_P(WithBoundScheduler, ParallelForNested) {
+  constexpr int count = 100;
+  std::atomic<int> calls = {0};
+  marl::parallel_for(0, count, 1, [&](int) {
+    marl::parallel_for(0, count, 1, [&](int) { calls++; });
+  });
+  ASSERT_EQ(calls.load(), count * count);
+}
+
+TEST_P(WithBoundScheduler, ParallelForAffinityPartitioner) {
+  constexpr int count = 10000;
+  std::vector<int> calls(count);
+  marl::AffinityPartitioner partitioner;
+  for (size_t grain : {1, 1, 7, 7, 100, 20000}) {
+    std::fill(calls.begin(), calls.end(), 0);
+    marl::parallel_for(0, count, grain, partitioner, [&](int begin, int end) {
+      ASSERT_LT(begin, end);
+      for (int i = begin; i < end; i++) {
+        calls[i]++;
+      }
+    });
+    for (int i = 0; i < count; i++) {
+      ASSERT_EQ(calls[i], 1) << "grain: " << grain << ", i: " << i;
+    }
+  }
+}
+
+TEST_P(WithBoundScheduler, ParallelForAffinityPartitionerResize) {
+  marl::AffinityPartitioner partitioner;
+  for (int count : {1000, 10, 0, 5000, 1000}) {
+    std::atomic<int> calls = {0};
+    marl::parallel_for(0, count, 1, partitioner,
+                       [&](int begin, int end) { calls += end - begin; });
+    ASSERT_EQ(calls.load(), count);
+  }
+}
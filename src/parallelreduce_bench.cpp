@@ -0,0 +1,56 @@
+// Copyright 2026 The Marl Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "marl_bench.h"
+
+#include "marl/parallelreduce.h"
+
+#include "benchmark/benchmark.h"
+
+#include <vector>
+
+// The ParallelReduce benchmarks sum an array of numTasks floats.
+
+static void parallelReduce(Schedule& schedule,
+                           benchmark::State& state,
+                           marl::ReduceMode mode) {
+  schedule.run(state, [&](int numElements) {
+    std::vector<float> data(numElements, 1.0f);
+    auto body = [&](int begin, int end, float init) {
+      for (int i = begin; i < end; i++) {
+        init += data[i];
+      }
+      return init;
+    };
+    auto combine = [](float a, float b) { return a + b; };
+    for (auto _ : state) {
+      benchmark::DoNotOptimize(marl::parallel_reduce(0, numElements, 0x4000,
+                                                     0.0f, body, combine, mode));
+    }
+  });
+}
+
+BENCHMARK_DEFINE_F(Schedule, ParallelReduceFast)(benchmark::State& state) {
+  parallelReduce(*this, state, marl::ReduceMode::Fast);
+}
+BENCHMARK_REGISTER_F(Schedule, ParallelReduceFast)
+    ->Apply(Schedule::args<0x400000>);
+
+BENCHMARK_DEFINE_F(Schedule, ParallelReduceDeterministic)
+(benchmark::State& state) {
+  parallelReduce(*this, state, marl::ReduceMode::Deterministic);
+}
+BENCHMARK_REGISTER_F(Schedule, ParallelReduceDeterministic)
+    ->Apply(Schedule::args<0x400000>);
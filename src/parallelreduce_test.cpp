@@ -0,0 +1,108 @@
+// Copyright 2026 The Marl Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "marl_test.h"
+
+#include "marl/defer.h"
+#include "marl/parallelreduce.h"
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+
+int64_t sumRange(int begin, int end, int64_t init) {
+  for (int i = begin; i < end; i++) {
+    init += i;
+  }
+  return init;
+}
+
+int64_t add(int64_t a, int64_t b) {
+  return a + b;
+}
+
+}  // anonymous namespace
+
+TEST_P(WithBoundScheduler, ParallelReduce) {
+  constexpr int count = 10000;
+  for (auto mode : {marl::ReduceMode::Fast, marl::ReduceMode::Deterministic}) {
+    for (size_t grain : {1, 7, 100, 20000}) {
+      auto sum = marl::parallel_reduce(0, count, grain, int64_t(0), sumRange,
+                                       add, mode);
+      ASSERT_EQ(sum, int64_t(count) * (count - 1) / 2) << "grain: " << grain;
+    }
+  }
+}
+
+TEST_P(WithBoundScheduler, ParallelReduceEmptyRange) {
+  for (auto mode : {marl::ReduceMode::Fast, marl::ReduceMode::Deterministic}) {
+    ASSERT_EQ(marl::parallel_reduce(5, 5, 1, int64_t(42), sumRange, add, mode),
+              42);
+  }
+}
+
+TEST_P(WithBoundScheduler, ParallelReduceDeterministicOrder) {
+  // Concatenation is associative but not commutative, so the chunks must be
+  // combined in index order.
+  auto str = marl::parallel_reduce(
+      0, 26, 3, std::string(),
+      [](int begin, int end, std::string init) {
+        for (int i = begin; i < end; i++) {
+          init += static_cast<char>('a' + i);
+        }
+        return init;
+      },
+      [](const std::string& a, const std::string& b) { return a + b; },
+      marl::ReduceMode::Deterministic);
+  ASSERT_EQ(str, "abcdefghijklmnopqrstuvwxyz");
+}
+
+TEST_F(WithoutBoundScheduler, ParallelReduceDeterministicFloat) {
+  // Values of widely varying magnitude, so that the sum depends on the order
+  // of the additions.
+  std::vector<float> values(100000);
+  for (size_t i = 0; i < values.size(); i++) {
+    values[i] = static_cast<float>((i * 7919) % 1000) * (i % 3 ? 1e-3f : 1e3f);
+  }
+  auto body = [&](size_t begin, size_t end, float init) {
+    for (size_t i = begin; i < end; i++) {
+      init += values[i];
+    }
+    return init;
+  };
+  auto combine = [](float a, float b) { return a + b; };
+
+  float expected = 0;
+  for (int numThreads : {0, 1, 2, 8}) {
+    marl::Scheduler::Config cfg;
+    cfg.setAllocator(allocator);
+    cfg.setWorkerThreadCount(numThreads);
+    marl::Scheduler scheduler(cfg);
+    scheduler.bind();
+    defer(scheduler.unbind());
+    for (int i = 0; i < 10; i++) {
+      auto sum = marl::parallel_reduce(size_t(0), values.size(), 64, 0.0f, body,
+                                       combine,
+                                       marl::ReduceMode::Deterministic);
+      if (numThreads == 0 && i == 0) {
+        expected = sum;
+      }
+      ASSERT_EQ(memcmp(&sum, &expected, sizeof(sum)), 0)
+          << "numThreads: " << numThreads << ", sum: " << sum
+          << ", expected: " << expected;
+    }
+  }
+}
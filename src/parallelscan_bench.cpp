@@ -0,0 +1,37 @@
+// Copyright 2026 The Marl Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "marl_bench.h"
+
+#include "marl/parallelscan.h"
+
+#include "benchmark/benchmark.h"
+
+#include <vector>
+
+// ParallelScan computes the inclusive prefix sums of an array of numTasks
+// floats.
+BENCHMARK_DEFINE_F(Schedule, ParallelScan)(benchmark::State& state) {
+  run(state, [&](int numElements) {
+    std::vector<float> in(numElements, 1.0f);
+    std::vector<float> out(numElements);
+    for (auto _ : state) {
+      marl::parallel_scan(in.begin(), in.end(), out.begin(), 0x4000, 0.0f,
+                          [](float a, float b) { return a + b; });
+    }
+    benchmark::DoNotOptimize(out.data());
+  });
+}
+BENCHMARK_REGISTER_F(Schedule, ParallelScan)->Apply(Schedule::args<0x400000>);
@@ -0,0 +1,110 @@
+// Copyright 2026 The Marl Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "marl_test.h"
+
+#include "marl/defer.h"
+#include "marl/parallelscan.h"
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+
+int64_t add(int64_t a, int64_t b) {
+  return a + b;
+}
+
+}  // anonymous namespace
+
+TEST_P(WithBoundScheduler, ParallelScanInclusive) {
+  constexpr int count = 10000;
+  std::vector<int64_t> in(count);
+  for (int i = 0; i < count; i++) {
+    in[i] = i;
+  }
+  for (size_t grain : {1, 7, 100, 20000}) {
+    std::vector<int64_t> out(count);
+    marl::parallel_scan(in.begin(), in.end(), out.begin(), grain, int64_t(0),
+                        add, marl::ScanKind::Inclusive);
+    for (int i = 0; i < count; i++) {
+      ASSERT_EQ(out[i], int64_t(i) * (i + 1) / 2)
+          << "grain: " << grain << ", i: " << i;
+    }
+  }
+}
+
+TEST_P(WithBoundScheduler, ParallelScanExclusiveInPlace) {
+  constexpr int count = 10000;
+  for (size_t grain : {1, 7, 100, 20000}) {
+    std::vector<int64_t> data(count);
+    for (int i = 0; i < count; i++) {
+      data[i] = i;
+    }
+    marl::parallel_scan(data.begin(), data.end(), data.begin(), grain,
+                        int64_t(0), add, marl::ScanKind::Exclusive);
+    for (int i = 0; i < count; i++) {
+      ASSERT_EQ(data[i], int64_t(i) * (i - 1) / 2)
+          << "grain: " << grain << ", i: " << i;
+    }
+  }
+}
+
+TEST_P(WithBoundScheduler, ParallelScanEmpty) {
+  std::vector<int64_t> data;
+  marl::parallel_scan(data.begin(), data.end(), data.begin(), 16, int64_t(0),
+                      add);
+}
+
+TEST_P(WithBoundScheduler, ParallelScanOrder) {
+  // Concatenation is associative but not commutative.
+  std::vector<std::string> data;
+  for (char c = 'a'; c <= 'z'; c++) {
+    data.push_back(std::string(1, c));
+  }
+  std::vector<std::string> out(data.size());
+  marl::parallel_scan(
+      data.begin(), data.end(), out.begin(), 3, std::string(),
+      [](const std::string& a, const std::string& b) { return a + b; });
+  ASSERT_EQ(out.back(), "abcdefghijklmnopqrstuvwxyz");
+  ASSERT_EQ(out[2], "abc");
+}
+
+TEST_F(WithoutBoundScheduler, ParallelScanDeterministicFloat) {
+  std::vector<float> values(100000);
+  for (size_t i = 0; i < values.size(); i++) {
+    values[i] = static_cast<float>((i * 7919) % 1000) * (i % 3 ? 1e-3f : 1e3f);
+  }
+  auto combine = [](float a, float b) { return a + b; };
+
+  std::vector<float> expected;
+  for (int numThreads : {0, 1, 2, 8}) {
+    marl::Scheduler::Config cfg;
+    cfg.setAllocator(allocator);
+    cfg.setWorkerThreadCount(numThreads);
+    marl::Scheduler scheduler(cfg);
+    scheduler.bind();
+    defer(scheduler.unbind());
+    std::vector<float> out(values.size());
+    marl::parallel_scan(values.begin(), values.end(), out.begin(), 64, 0.0f,
+                        combine);
+    if (numThreads == 0) {
+      expected = out;
+    }
+    ASSERT_EQ(memcmp(out.data(), expected.data(), out.size() * sizeof(float)),
+              0)
+        << "numThreads: " << numThreads;
+  }
+}
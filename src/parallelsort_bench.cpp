@@ -0,0 +1,43 @@
+// Copyright 2026 The Marl Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "marl_bench.h"
+
+#include "marl/parallelsort.h"
+
+#include "benchmark/benchmark.h"
+
+#include <random>
+#include <vector>
+
+// ParallelSort sorts an array of numTasks random 64-bit keys. The keys are
+// restored from an unsorted copy before each sort. With no worker threads,
+// parallel_sort() falls back to std::sort().
+BENCHMARK_DEFINE_F(Schedule, ParallelSort)(benchmark::State& state) {
+  run(state, [&](int numElements) {
+    std::mt19937_64 rng(1);
+    std::vector<uint64_t> unsorted(numElements);
+    for (auto& key : unsorted) {
+      key = rng();
+    }
+    std::vector<uint64_t> data(numElements);
+    for (auto _ : state) {
+      std::copy(unsorted.begin(), unsorted.end(), data.begin());
+      marl::parallel_sort(data.begin(), data.end());
+    }
+    benchmark::DoNotOptimize(data.data());
+  });
+}
+BENCHMARK_REGISTER_F(Schedule, ParallelSort)->Apply(Schedule::args<0x400000>);
@@ -0,0 +1,62 @@
+// Copyright 2026 The Marl Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "marl_test.h"
+
+#include "marl/parallelsort.h"
+
+#include <algorithm>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+TEST_P(WithBoundScheduler, ParallelSort) {
+  std::mt19937 rng(1);
+  for (size_t count : {0, 1, 100, 8192, 8193, 100000, 1 << 20}) {
+    std::vector<uint32_t> data(count);
+    for (auto& v : data) {
+      v = rng();
+    }
+    auto expected = data;
+    std::sort(expected.begin(), expected.end());
+    marl::parallel_sort(data.begin(), data.end());
+    ASSERT_EQ(data, expected) << "count: " << count;
+  }
+}
+
+TEST_P(WithBoundScheduler, ParallelSortDuplicates) {
+  std::mt19937 rng(2);
+  std::vector<uint32_t> data(100000);
+  for (auto& v : data) {
+    v = rng() % 16;
+  }
+  auto expected = data;
+  std::sort(expected.begin(), expected.end(), std::greater<uint32_t>());
+  marl::parallel_sort(data.begin(), data.end(), std::greater<uint32_t>());
+  ASSERT_EQ(data, expected);
+}
+
+TEST_P(WithBoundScheduler, ParallelSortStrings) {
+  std::mt19937 rng(3);
+  std::vector<std::string> data(50000);
+  for (auto& v : data) {
+    v = std::to_string(rng()) + " is long enough to be allocated on the heap";
+  }
+  auto expected = data;
+  std::sort(expected.begin(), expected.end());
+  marl::parallel_sort(data.begin(), data.end());
+  ASSERT_EQ(data, expected);
+}
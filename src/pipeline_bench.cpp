@@ -0,0 +1,101 @@
+// Copyright 2026 The Marl Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "marl_bench.h"
+
+#include "marl/pipeline.h"
+#include "marl/ticket.h"
+#include "marl/waitgroup.h"
+
+#include "benchmark/benchmark.h"
+
+#include <vector>
+
+// The Pipeline benchmarks pass numTasks items through a parse stage and a
+// transform stage that may run in parallel, and a write stage that must run
+// serially in order, as an ETL pipeline would. Each item is a block of 256
+// words.
+
+namespace {
+
+struct Block {
+  uint32_t words[256];
+  uint32_t index;
+};
+
+void parse(Block& block) {
+  for (auto& word : block.words) {
+    word = word * 0x9e3779b9 + block.index;
+  }
+}
+
+void transform(Block& block) {
+  for (auto& word : block.words) {
+    word ^= word >> 13;
+  }
+}
+
+}  // anonymous namespace
+
+BENCHMARK_DEFINE_F(Schedule, Pipeline)(benchmark::State& state) {
+  run(state, [&](int numItems) {
+    uint64_t checksum = 0;
+    marl::Pipeline<Block> pipeline(4 * std::max(numThreads(state), 1));
+    pipeline.stage(marl::StageKind::Parallel, parse)
+        .stage(marl::StageKind::Parallel, transform)
+        .stage(marl::StageKind::SerialInOrder,
+               [&](Block& block) { checksum += block.words[0]; });
+    for (auto _ : state) {
+      int next = 0;
+      pipeline.run([&](Block& block) {
+        if (next == numItems) {
+          return false;
+        }
+        block.index = next++;
+        return true;
+      });
+    }
+    benchmark::DoNotOptimize(checksum);
+  });
+}
+BENCHMARK_REGISTER_F(Schedule, Pipeline)->Apply(Schedule::args<0x4000>);
+
+// PipelineTickets is the hand-written equivalent of the Pipeline benchmark:
+// a task per item, serialized for the write stage with a Ticket::Queue.
+BENCHMARK_DEFINE_F(Schedule, PipelineTickets)(benchmark::State& state) {
+  run(state, [&](int numItems) {
+    uint64_t checksum = 0;
+    for (auto _ : state) {
+      marl::Ticket::Queue queue;
+      marl::WaitGroup wg(numItems);
+      for (int i = 0; i < numItems; i++) {
+        auto ticket = queue.take();
+        marl::schedule([&, ticket, wg, i] {
+          Block block;
+          block.index = i;
+          parse(block);
+          transform(block);
+          ticket.wait();
+          checksum += block.words[0];
+          ticket.done();
+          wg.done();
+        });
+      }
+      wg.wait();
+    }
+    benchmark::DoNotOptimize(checksum);
+  });
+}
+BENCHMARK_REGISTER_F(Schedule, PipelineTickets)->Apply(Schedule::args<0x4000>);
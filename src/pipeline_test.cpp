@@ -0,0 +1,138 @@
+// Copyright 2026 The Marl Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "marl_test.h"
+
+#include "marl/pipeline.h"
+
+#include <atomic>
+#include <vector>
+
+namespace {
+
+struct Item {
+  int value = 0;
+  int squared = 0;
+};
+
+}  // anonymous namespace
+
+TEST_P(WithBoundScheduler, PipelineSerialInOrder) {
+  constexpr int count = 1000;
+  std::vector<int> out;
+  marl::Pipeline<Item> pipeline(8);
+  pipeline
+      .stage(marl::StageKind::Parallel,
+             [](Item& item) { item.squared = item.value * item.value; })
+      .stage(marl::StageKind::SerialInOrder,
+             [&](Item& item) { out.push_back(item.squared); });
+  int next = 0;
+  auto produced = pipeline.run([&](Item& item) {
+    if (next == count) {
+      return false;
+    }
+    item.value = next++;
+    return true;
+  });
+  ASSERT_EQ(produced, uint64_t(count));
+  ASSERT_EQ(out.size(), size_t(count));
+  for (int i = 0; i < count; i++) {
+    ASSERT_EQ(out[i], i * i);
+  }
+}
+
+TEST_P(WithBoundScheduler, PipelineSerialOutOfOrder) {
+  constexpr int count = 1000;
+  std::vector<int> seen(count);
+  std::atomic<int> concurrent = {0};
+  std::atomic<int> maxConcurrent = {0};
+  marl::Pipeline<Item> pipeline(8);
+  pipeline.stage(marl::StageKind::SerialOutOfOrder, [&](Item& item) {
+    int c = ++concurrent;
+    int max = maxConcurrent.load();
+    while (c > max && !maxConcurrent.compare_exchange_weak(max, c)) {
+    }
+    seen[item.value]++;
+    concurrent--;
+  });
+  int next = 0;
+  pipeline.run([&](Item& item) {
+    if (next == count) {
+      return false;
+    }
+    item.value = next++;
+    return true;
+  });
+  ASSERT_EQ(maxConcurrent.load(), 1);
+  for (int i = 0; i < count; i++) {
+    ASSERT_EQ(seen[i], 1);
+  }
+}
+
+TEST_P(WithBoundScheduler, PipelineBoundsTokensInFlight) {
+  constexpr int count = 1000;
+  constexpr int maxTokens = 4;
+  std::atomic<int> inFlight = {0};
+  std::atomic<int> maxInFlight = {0};
+  std::atomic<int> finished = {0};
+  marl::Pipeline<Item> pipeline(maxTokens);
+  pipeline
+      .stage(marl::StageKind::Parallel,
+             [&](Item&) {
+               int c = inFlight.load();
+               int max = maxInFlight.load();
+               while (c > max && !maxInFlight.compare_exchange_weak(max, c)) {
+               }
+             })
+      .stage(marl::StageKind::SerialInOrder, [&](Item&) {
+        inFlight--;
+        finished++;
+      });
+  int next = 0;
+  pipeline.run([&](Item& item) {
+    if (next == count) {
+      return false;
+    }
+    item.value = next++;
+    inFlight++;
+    return true;
+  });
+  ASSERT_EQ(finished.load(), count);
+  ASSERT_LE(maxInFlight.load(), maxTokens);
+}
+
+TEST_P(WithBoundScheduler, PipelineEmptyAndReuse) {
+  std::atomic<int> calls = {0};
+  marl::Pipeline<Item> pipeline(4);
+  pipeline.stage(marl::StageKind::SerialInOrder, [&](Item&) { calls++; });
+  ASSERT_EQ(pipeline.run([](Item&) { return false; }), 0U);
+  ASSERT_EQ(calls.load(), 0);
+  for (int run = 1; run <= 3; run++) {
+    int next = 0;
+    ASSERT_EQ(pipeline.run([&](Item&) { return next++ < 100; }), 100U);
+    ASSERT_EQ(calls.load(), run * 100);
+  }
+}
+
+TEST_P(WithBoundScheduler, PipelineStageFromLvalue) {
+  std::atomic<int> calls = {0};
+  marl::Pipeline<Item>::Function count = [&](Item&) { calls++; };
+  marl::Pipeline<Item> pipeline(4);
+  pipeline.stage(marl::StageKind::Parallel, count)
+      .stage(marl::StageKind::SerialInOrder, count);
+  int next = 0;
+  ASSERT_EQ(pipeline.run([&](Item&) { return next++ < 100; }), 100U);
+  ASSERT_EQ(calls.load(), 200);
+}
@@ -0,0 +1,87 @@
+// Copyright 2026 The Marl Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "marl_bench.h"
+
+#include "marl/pool.h"
+#include "marl/waitgroup.h"
+
+#include "benchmark/benchmark.h"
+
+// Number of borrow / return pairs performed by each task.
+static constexpr int borrowsPerTask = 64;
+
+BENCHMARK_DEFINE_F(Schedule, BoundedPool)(benchmark::State& state) {
+  run(state, [&](int numTasks) {
+    marl::BoundedPool<uint32_t, 4096> pool;
+    for (auto _ : state) {
+      marl::WaitGroup wg(numTasks);
+      for (int i = 0; i < numTasks; i++) {
+        marl::schedule([=] {
+          for (int j = 0; j < borrowsPerTask; j++) {
+            auto loan = pool.borrow();
+            *loan = static_cast<uint32_t>(j);
+            benchmark::DoNotOptimize(*loan);
+          }
+          wg.done();
+        });
+      }
+      wg.wait();
+    }
+  });
+}
+BENCHMARK_REGISTER_F(Schedule, BoundedPool)->Apply(Schedule::args<512>);
+
+BENCHMARK_DEFINE_F(Schedule, UnboundedPool)(benchmark::State& state) {
+  run(state, [&](int numTasks) {
+    marl::UnboundedPool<uint32_t> pool;
+    for (auto _ : state) {
+      marl::WaitGroup wg(numTasks);
+      for (int i = 0; i < numTasks; i++) {
+        marl::schedule([=] {
+          for (int j = 0; j < borrowsPerTask; j++) {
+            auto loan = pool.borrow();
+            *loan = static_cast<uint32_t>(j);
+            benchmark::DoNotOptimize(*loan);
+          }
+          wg.done();
+        });
+      }
+      wg.wait();
+    }
+  });
+}
+BENCHMARK_REGISTER_F(Schedule, UnboundedPool)->Apply(Schedule::args<512>);
+
+BENCHMARK_DEFINE_F(Schedule, UnboundedPoolBatch)(benchmark::State& state) {
+  run(state, [&](int numTasks) {
+    marl::UnboundedPool<uint32_t> pool;
+    for (auto _ : state) {
+      marl::WaitGroup wg(numTasks);
+      for (int i = 0; i < numTasks; i++) {
+        marl::schedule([=] {
+          marl::Loan<uint32_t> loans[borrowsPerTask];
+          int j = 0;
+          pool.borrow(borrowsPerTask, [&](marl::Loan<uint32_t>&& loan) {
+            *loan = static_cast<uint32_t>(j);
+            loans[j++] = std::move(loan);
+          });
+          wg.done();
+        });
+      }
+      wg.wait();
+    }
+  });
+}
+BENCHMARK_REGISTER_F(Schedule, UnboundedPoolBatch)->Apply(Schedule::args<512>);
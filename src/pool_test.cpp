@@ -18,6 +18,9 @@
 #include "marl/pool.h"
 #include "marl/waitgroup.h"
 
+#include <thread>
+#include <vector>
+
 TEST_P(WithBoundScheduler, UnboundedPool_ConstructDestruct) {
   marl::UnboundedPool<int> pool;
 }
@@ -204,3 +207,106 @@ TEST_P(WithBoundScheduler, UnboundedPool_AlignedTypes) {
               0U);
   }
 }
+
+TEST_P(WithBoundScheduler, BoundedPool_TryBorrow) {
+  marl::BoundedPool<int, 4> pool;
+  std::vector<marl::BoundedPool<int, 4>::Loan> loans;
+  for (int i = 0; i < 4; i++) {
+    auto res = pool.tryBorrow();
+    ASSERT_TRUE(res.second);
+    loans.emplace_back(std::move(res.first));
+  }
+  ASSERT_FALSE(pool.tryBorrow().second);
+  loans.pop_back();
+  ASSERT_TRUE(pool.tryBorrow().second);
+}
+
+TEST_P(WithBoundScheduler, BoundedPool_ConcurrentBorrowLarge) {
+  marl::BoundedPool<int, 1024> pool;
+  constexpr int iterations = 10000;
+  marl::WaitGroup wg(iterations);
+  for (int i = 0; i < iterations; i++) {
+    marl::schedule([=] {
+      {
+        auto a = pool.borrow();
+        auto b = pool.borrow();
+      }
+      wg.done();
+    });
+  }
+  wg.wait();
+
+  // All items must have been returned, even those cached by worker threads.
+  std::vector<marl::BoundedPool<int, 1024>::Loan> loans;
+  for (int i = 0; i < 1024; i++) {
+    auto res = pool.tryBorrow();
+    ASSERT_TRUE(res.second);
+    loans.emplace_back(std::move(res.first));
+  }
+  ASSERT_FALSE(pool.tryBorrow().second);
+}
+
+TEST_P(WithBoundScheduler, UnboundedPool_LoanOutlivesPool) {
+  CtorDtorCounter::reset();
+  marl::UnboundedPool<CtorDtorCounter, marl::PoolPolicy::Preserve>::Loan loan;
+  {
+    marl::UnboundedPool<CtorDtorCounter, marl::PoolPolicy::Preserve> pool(
+        allocator);
+    loan = pool.borrow();
+  }
+  ASSERT_EQ(CtorDtorCounter::dtor_count, 0);
+  loan.reset();
+  ASSERT_EQ(CtorDtorCounter::ctor_count, CtorDtorCounter::dtor_count);
+}
+
+TEST_P(WithBoundScheduler, BoundedPool_LoanOutlivesPool) {
+  marl::WaitGroup wg(100);
+  {
+    marl::BoundedPool<int, 256> pool(allocator);
+    for (int i = 0; i < 100; i++) {
+      auto loan = pool.borrow();
+      marl::schedule([=] {
+        ASSERT_NE(loan.get(), nullptr);
+        wg.done();
+      });
+    }
+  }
+  wg.wait();
+}
+
+TEST_P(WithBoundScheduler, UnboundedPool_Copy) {
+  marl::UnboundedPool<int> a(allocator);
+  marl::UnboundedPool<int> b = a;
+  auto loan = a.borrow();
+  *loan = 42;
+  {
+    marl::UnboundedPool<int> c(allocator);
+    c = b;
+  }
+  ASSERT_EQ(*loan, 42);
+}
+
+TEST_P(WithBoundScheduler, UnboundedPool_ReturnFromNonWorkerThread) {
+  constexpr int numLoans = 256;
+  std::vector<marl::UnboundedPool<int>::Loan> loans(numLoans);
+  {
+    marl::UnboundedPool<int> pool(allocator);
+    marl::WaitGroup wg(numLoans);
+    for (int i = 0; i < numLoans; i++) {
+      marl::schedule([=, &loans] {
+        loans[i] = pool.borrow();
+        *loans[i] = i;
+        wg.done();
+      });
+    }
+    wg.wait();
+  }
+  // The pool has been destructed, and the loans borrowed by the worker threads
+  // are returned from a thread that is not a worker thread.
+  std::thread([&] {
+    for (int i = 0; i < numLoans; i++) {
+      ASSERT_EQ(*loans[i], i);
+      loans[i].reset();
+    }
+  }).join();
+}
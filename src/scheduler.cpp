@@ -16,24 +16,35 @@
 
 #include "marl/scheduler.h"
 
+#include "cycleclock.h"
 #include "marl/debug.h"
+#include "marl/defer.h"
 #include "marl/thread.h"
 #include "marl/trace.h"
 
+#include <algorithm>
+#include <cstdio>
+
 #if defined(_WIN32)
 #include <intrin.h>  // __nop()
 #endif
 
-// Enable to trace scheduler events.
-#define ENABLE_TRACE_EVENTS 0
+// Enable to record scheduler trace events while tracing is enabled at runtime.
+#define ENABLE_TRACE_EVENTS 1
 
 // Enable to print verbose debug logging.
 #define ENABLE_DEBUG_LOGGING 0
 
 #if ENABLE_TRACE_EVENTS
 #define TRACE(...) MARL_SCOPED_EVENT(__VA_ARGS__)
+#define TRACE_BEGIN_FLOW(name) MARL_BEGIN_FLOW(name)
+#define TRACE_STEP_FLOW(id, name) MARL_STEP_FLOW(id, name)
+#define TRACE_END_FLOW(id, name) MARL_END_FLOW(id, name)
 #else
 #define TRACE(...)
+#define TRACE_BEGIN_FLOW(name) 0
+#define TRACE_STEP_FLOW(id, name)
+#define TRACE_END_FLOW(id, name)
 #endif
 
 #if ENABLE_DEBUG_LOGGING
@@ -67,6 +78,13 @@ inline uint64_t threadID() {
 }
 #endif
 
+// accumulate() adds value to counter. counter must only be written by the
+// calling thread, which allows for a cheaper update than fetch_add().
+inline void accumulate(std::atomic<uint64_t>& counter, uint64_t value) {
+  counter.store(counter.load(std::memory_order_relaxed) + value,
+                std::memory_order_relaxed);
+}
+
 inline void nop() {
 #if defined(_WIN32)
   __nop();
@@ -126,6 +144,10 @@ void Scheduler::unbind() {
     auto it = workers.find(tid);
     MARL_ASSERT(it != workers.end(), "singleThreadedWorker not found");
     MARL_ASSERT(it->second.get() == worker, "worker is not bound?");
+    auto& retired = get()->singleThreadedWorkers.retiredTags;
+    for (size_t tag = 0; tag < Task::NumTags; tag++) {
+      worker->tags[tag].mergeInto(retired[tag]);
+    }
     workers.erase(it);
     if (workers.empty()) {
       get()->singleThreadedWorkers.unbind.notify_one();
@@ -138,6 +160,7 @@ Scheduler::Scheduler(const Config& config)
     : cfg(setConfigDefaults(config)),
       workerThreads{},
       singleThreadedWorkers(config.allocator) {
+  CycleClock::calibrate();
   for (int i = 0; i < cfg.workerThread.count; i++) {
     spinningWorkers[i] = -1;
     workerThreads[i] =
@@ -146,9 +169,20 @@ Scheduler::Scheduler(const Config& config)
   for (int i = 0; i < cfg.workerThread.count; i++) {
     workerThreads[i]->start();
   }
+#if MARL_TRACE_ENABLED
+  if (cfg.counterSampleInterval.count() > 0 && cfg.workerThread.count > 0) {
+    counterSampler = cfg.allocator->create<CounterSampler>(this);
+  }
+#endif
 }
 
 Scheduler::~Scheduler() {
+#if MARL_TRACE_ENABLED
+  if (counterSampler != nullptr) {
+    cfg.allocator->destroy(counterSampler);
+  }
+#endif
+
   {
     // Wait until all the single threaded workers have been unbound.
     marl::lock lock(singleThreadedWorkers.mutex);
@@ -168,7 +202,26 @@ Scheduler::~Scheduler() {
   }
 }
 
+void Scheduler::prepareEnqueue(Task& task) {
+  task.setFlowID(TRACE_BEGIN_FLOW("Enqueue"));
+  if (cfg.taskAccounting) {
+    if (task.tag() == 0) {
+      // Inherit the tag of the task that is enqueuing this task.
+      if (auto worker = Worker::getCurrent()) {
+        if (auto parent = worker->getCurrentFiber()->task) {
+          task.setTag(parent->tag());
+        }
+      }
+    }
+    task.enqueueTicks = CycleClock::now();
+  }
+  if (auto observer = cfg.observer.get()) {
+    observer->onTaskEnqueued(task);
+  }
+}
+
 void Scheduler::enqueue(Task&& task) {
+  prepareEnqueue(task);
   if (task.is(Task::Flags::SameThread)) {
     Worker::getCurrent()->enqueue(std::move(task));
     return;
@@ -201,15 +254,91 @@ void Scheduler::enqueue(Task&& task) {
   }
 }
 
+void Scheduler::enqueue(Task&& task, int workerId) {
+  if (workerId < 0 || workerId >= cfg.workerThread.count ||
+      task.is(Task::Flags::SameThread)) {
+    enqueue(std::move(task));
+    return;
+  }
+  prepareEnqueue(task);
+  workerThreads[workerId]->enqueue(std::move(task));
+}
+
+void Scheduler::enqueue(Task&& task, const TimePoint& deadline) {
+  prepareEnqueue(task);
+  Worker* worker = nullptr;
+  if (cfg.workerThread.count > 0) {
+    // Prefer the calling worker thread. A single-threaded worker may not
+    // process its tasks until its thread blocks, so is never used.
+    auto id = currentWorkerId();
+    if (id < 0 || get() != this) {
+      id = static_cast<int>(nextEnqueueIndex++ % cfg.workerThread.count);
+    }
+    worker = workerThreads[id];
+  } else {
+    worker = Worker::getCurrent();
+    if (worker == nullptr || get() != this) {
+      MARL_FATAL(
+          "singleThreadedWorker not found. Did you forget to call "
+          "marl::Scheduler::bind()?");
+    }
+  }
+  worker->enqueue(std::move(task), deadline);
+}
+
+int Scheduler::currentWorkerId() {
+  // Single-threaded workers are constructed with an identifier of -1.
+  auto worker = Worker::getCurrent();
+  return worker != nullptr ? static_cast<int>(worker->id) : -1;
+}
+
 const Scheduler::Config& Scheduler::config() const {
   return cfg;
 }
 
+Scheduler::TaskStats Scheduler::taskStats(Task::Tag tag) {
+  TagStats merged;
+  for (int i = 0; i < cfg.workerThread.count; i++) {
+    workerThreads[i]->tags[tag].mergeInto(merged);
+  }
+  {
+    marl::lock lock(singleThreadedWorkers.mutex);
+    for (auto& it : singleThreadedWorkers.byTid) {
+      it.second->tags[tag].mergeInto(merged);
+    }
+    singleThreadedWorkers.retiredTags[tag].mergeInto(merged);
+  }
+
+  auto duration = [](const std::atomic<uint64_t>& ticks) {
+    return CycleClock::toDuration(ticks.load(std::memory_order_relaxed));
+  };
+  TaskStats stats;
+  stats.tasks = merged.tasks.load(std::memory_order_relaxed);
+  stats.cpuTime = duration(merged.cpuTicks);
+  stats.queueTime = duration(merged.queueTicks);
+  stats.blockedTime = duration(merged.blockedTicks);
+  return stats;
+}
+
+std::chrono::nanoseconds Scheduler::cpuTime(Task::Tag tag) {
+  return taskStats(tag).cpuTime;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Scheduler::TagStats
+////////////////////////////////////////////////////////////////////////////////
+void Scheduler::TagStats::mergeInto(TagStats& other) const {
+  accumulate(other.tasks, tasks.load(std::memory_order_relaxed));
+  accumulate(other.cpuTicks, cpuTicks.load(std::memory_order_relaxed));
+  accumulate(other.queueTicks, queueTicks.load(std::memory_order_relaxed));
+  accumulate(other.blockedTicks, blockedTicks.load(std::memory_order_relaxed));
+}
+
 bool Scheduler::stealWork(Worker* thief, uint64_t from, Task& out) {
   if (cfg.workerThread.count > 0) {
     auto thread = workerThreads[from % cfg.workerThread.count];
     if (thread != thief) {
-      if (thread->steal(out)) {
+      if (thread->steal(thief, out)) {
         return true;
       }
     }
@@ -229,6 +358,103 @@ Scheduler::Config Scheduler::Config::allCores() {
   return Config().setWorkerThreadCount(Thread::numLogicalCPUs());
 }
 
+#if MARL_TRACE_ENABLED
+////////////////////////////////////////////////////////////////////////////////
+// Scheduler::CounterSampler
+////////////////////////////////////////////////////////////////////////////////
+
+// CounterSampler periodically records the load of each of the scheduler's
+// worker threads as trace counter events, while tracing is enabled.
+class Scheduler::CounterSampler {
+ public:
+  CounterSampler(Scheduler* scheduler);
+  ~CounterSampler();
+
+ private:
+  // The names of the counters of a single worker.
+  struct WorkerNames {
+    Trace::Name tasks;
+    Trace::Name blockedFibers;
+    Trace::Name idleFibers;
+    Trace::Name spinning;
+  };
+
+  // sample() records the counters of all the workers.
+  void sample(Trace* trace);
+
+  Scheduler* const scheduler;
+  containers::vector<WorkerNames, 16> names;
+  Trace::Name spinningWorkers;
+  Trace::Name parkedWorkers;
+
+  marl::mutex mutex;
+  std::condition_variable cv;
+  GUARDED_BY(mutex) bool stop = false;
+  std::thread thread;
+};
+
+Scheduler::CounterSampler::CounterSampler(Scheduler* scheduler)
+    : scheduler(scheduler), names(scheduler->cfg.allocator) {
+  auto name = [](int id, const char* counter) {
+    char buf[64];
+    snprintf(buf, sizeof(buf), "Worker<%.2d> %s", id, counter);
+    return Trace::intern(buf);
+  };
+  for (int i = 0; i < scheduler->cfg.workerThread.count; i++) {
+    WorkerNames n;
+    n.tasks = name(i, "tasks");
+    n.blockedFibers = name(i, "blocked fibers");
+    n.idleFibers = name(i, "idle fibers");
+    n.spinning = name(i, "spinning");
+    names.push_back(n);
+  }
+  spinningWorkers = Trace::intern("Spinning workers");
+  parkedWorkers = Trace::intern("Parked workers");
+
+  auto interval = scheduler->cfg.counterSampleInterval;
+  thread = std::thread([this, interval] {
+    Thread::setName("Counter sampler");
+    marl::lock lock(mutex);
+    while (!lock.wait_until(cv, std::chrono::system_clock::now() + interval,
+                            [this]() REQUIRES(mutex) { return stop; })) {
+      if (auto trace = Trace::get()) {
+        sample(trace);
+      }
+    }
+  });
+}
+
+Scheduler::CounterSampler::~CounterSampler() {
+  {
+    marl::lock lock(mutex);
+    stop = true;
+  }
+  cv.notify_all();
+  thread.join();
+}
+
+void Scheduler::CounterSampler::sample(Trace* trace) {
+  int spinning = 0;
+  int parked = 0;
+  for (size_t i = 0; i < names.size(); i++) {
+    auto worker = scheduler->workerThreads[i];
+    auto& counters = worker->counters;
+    auto isSpinning = counters.spinning.load(std::memory_order_relaxed);
+    auto isParked = counters.parked.load(std::memory_order_relaxed);
+    trace->counterEvent(names[i].tasks, static_cast<int64_t>(worker->work.num));
+    trace->counterEvent(names[i].blockedFibers,
+                        counters.blockedFibers.load(std::memory_order_relaxed));
+    trace->counterEvent(names[i].idleFibers,
+                        counters.idleFibers.load(std::memory_order_relaxed));
+    trace->counterEvent(names[i].spinning, isSpinning ? 1 : 0);
+    spinning += isSpinning ? 1 : 0;
+    parked += isParked ? 1 : 0;
+  }
+  trace->counterEvent(spinningWorkers, spinning);
+  trace->counterEvent(parkedWorkers, parked);
+}
+#endif  // MARL_TRACE_ENABLED
+
 ////////////////////////////////////////////////////////////////////////////////
 // Scheduler::Fiber
 ////////////////////////////////////////////////////////////////////////////////
@@ -246,6 +472,10 @@ void Scheduler::Fiber::notify() {
   worker->enqueue(this);
 }
 
+std::chrono::nanoseconds Scheduler::Fiber::cpuTime() const {
+  return CycleClock::toDuration(cpuTicks.load(std::memory_order_relaxed));
+}
+
 void Scheduler::Fiber::wait(marl::lock& lock, const Predicate& pred) {
   MARL_ASSERT(worker == Worker::getCurrent(),
               "Scheduler::Fiber::wait() must only be called on the currently "
@@ -294,6 +524,90 @@ const char* Scheduler::Fiber::toString(State state) {
   return "<unknown>";
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// Scheduler::VirtualTimes
+////////////////////////////////////////////////////////////////////////////////
+Scheduler::VirtualTimes::VirtualTimes(Allocator* allocator,
+                                      const std::vector<uint32_t>& weights)
+    : times(allocator), costs(allocator) {
+  for (auto weight : weights) {
+    MARL_ASSERT(weight > 0, "fair-share weights must be greater than 0");
+    times.push_back(0);
+    costs.push_back(1.0 / weight);
+  }
+  if (times.size() == 0) {
+    times.push_back(0);
+    costs.push_back(1.0);
+  }
+}
+
+void Scheduler::VirtualTimes::charge(size_t cls, uint64_t ticks) {
+  times[cls] += static_cast<double>(ticks) * costs[cls];
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Scheduler::TaskQueue
+////////////////////////////////////////////////////////////////////////////////
+Scheduler::TaskQueue::TaskQueue(Allocator* allocator, size_t numClasses)
+    : classes(allocator) {
+  classes.reserve(numClasses);
+  for (size_t i = 0; i < numClasses; i++) {
+    classes.emplace_back(containers::deque<Task>(allocator));
+  }
+}
+
+size_t Scheduler::TaskQueue::classOf(const Task& task) const {
+  return task.tag() < classes.size() ? task.tag() : 0;
+}
+
+bool Scheduler::TaskQueue::empty() const {
+  return count == 0;
+}
+
+size_t Scheduler::TaskQueue::size() const {
+  return count;
+}
+
+void Scheduler::TaskQueue::push(Task&& task) {
+  classes[classOf(task)].push_back(std::move(task));
+  count++;
+}
+
+bool Scheduler::TaskQueue::take(Task& out, VirtualTimes* times, bool stealing) {
+  if (count == 0) {
+    return false;
+  }
+  size_t cls = 0;
+  if (classes.size() > 1) {
+    // Pick the class with the lowest virtual time. A class that was idle is
+    // brought forward to the current virtual time, so it cannot bank the
+    // time it did not use.
+    bool found = false;
+    for (size_t i = 0; i < classes.size(); i++) {
+      auto& queue = classes[i];
+      if (queue.empty() ||
+          (stealing && queue.front().is(Task::Flags::SameThread))) {
+        continue;
+      }
+      auto& time = times->times[i];
+      time = std::max(time, times->now);
+      if (!found || time < times->times[cls]) {
+        cls = i;
+        found = true;
+      }
+    }
+    if (!found) {
+      return false;
+    }
+    times->now = times->times[cls];
+  } else if (stealing && classes[0].front().is(Task::Flags::SameThread)) {
+    return false;
+  }
+  out = containers::take(classes[cls]);
+  count--;
+  return true;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // Scheduler::WaitingFibers
 ////////////////////////////////////////////////////////////////////////////////
@@ -355,6 +669,39 @@ bool Scheduler::WaitingFibers::Timeout::operator<(const Timeout& o) const {
   return fiber < o.fiber;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// Scheduler::DelayedTasks
+////////////////////////////////////////////////////////////////////////////////
+Scheduler::DelayedTasks::DelayedTasks(Allocator* allocator) : heap(allocator) {}
+
+Scheduler::DelayedTasks::operator bool() const {
+  return heap.size() > 0;
+}
+
+bool Scheduler::DelayedTasks::take(const TimePoint& now, Task& out) {
+  if (!*this || now < heap[0].deadline) {
+    return false;
+  }
+  std::pop_heap(heap.begin(), heap.end(), later);
+  out = std::move(heap.back().task);
+  heap.pop_back();
+  return true;
+}
+
+Scheduler::TimePoint Scheduler::DelayedTasks::next() const {
+  MARL_ASSERT(*this, "DelayedTasks::next() called when there are no tasks");
+  return heap[0].deadline;
+}
+
+void Scheduler::DelayedTasks::add(const TimePoint& deadline, Task&& task) {
+  heap.emplace_back(Delayed{deadline, std::move(task)});
+  std::push_heap(heap.begin(), heap.end(), later);
+}
+
+bool Scheduler::DelayedTasks::later(const Delayed& a, const Delayed& b) {
+  return a.deadline > b.deadline;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // Scheduler::Worker
 ////////////////////////////////////////////////////////////////////////////////
@@ -366,7 +713,14 @@ Scheduler::Worker::Worker(Scheduler* scheduler, Mode mode, uint32_t id)
     : id(id),
       mode(mode),
       scheduler(scheduler),
-      work(scheduler->cfg.allocator),
+      observer(scheduler->cfg.observer.get()),
+      accounting(scheduler->cfg.taskAccounting ||
+                 !scheduler->cfg.fairShareWeights.empty()),
+      virtualTimes(scheduler->cfg.allocator, scheduler->cfg.fairShareWeights),
+      fairShare(virtualTimes.times.size() > 1 ? &virtualTimes : nullptr),
+      contention(scheduler->cfg.contentionProfiler.get()),
+      contentionTable(contention != nullptr ? contention->acquire() : nullptr),
+      work(scheduler->cfg.allocator, virtualTimes.times.size()),
       idleFibers(scheduler->cfg.allocator) {}
 
 void Scheduler::Worker::start() {
@@ -386,6 +740,7 @@ void Scheduler::Worker::start() {
         Worker::current = this;
         mainFiber = Fiber::createFromCurrentThread(scheduler->cfg.allocator, 0);
         currentFiber = mainFiber.get();
+        lastAccounted = CycleClock::now();
         {
           marl::lock lock(work.mutex);
           run();
@@ -399,6 +754,7 @@ void Scheduler::Worker::start() {
       Worker::current = this;
       mainFiber = Fiber::createFromCurrentThread(scheduler->cfg.allocator, 0);
       currentFiber = mainFiber.get();
+      lastAccounted = CycleClock::now();
       break;
     }
     default:
@@ -423,6 +779,9 @@ void Scheduler::Worker::stop() {
     default:
       MARL_ASSERT(false, "Unknown mode: %d", int(mode));
   }
+  if (contentionTable != nullptr) {
+    contention->release(contentionTable);
+  }
 }
 
 bool Scheduler::Worker::wait(const TimePoint* timeout) {
@@ -470,6 +829,19 @@ bool Scheduler::Worker::wait(lock& waitLock,
 
 void Scheduler::Worker::suspend(
     const std::chrono::system_clock::time_point* timeout) {
+  TRACE("Suspended");
+  if (observer != nullptr) {
+    observer->onFiberSuspend(currentFiber);
+  }
+  if (accounting) {
+    currentFiber->suspendedTicks = CycleClock::now();
+  }
+  uint64_t contentionStart = 0;
+  if (contention != nullptr && ++contentionSamples >= contention->sampleRate) {
+    contentionSamples = 0;
+    contentionStart = CycleClock::now();
+  }
+
   // Current fiber is yielding as it is blocked.
   if (timeout != nullptr) {
     changeFiberState(currentFiber, Fiber::State::Running,
@@ -484,6 +856,8 @@ void Scheduler::Worker::suspend(
   waitForWork();
 
   work.numBlockedFibers++;
+  counters.blockedFibers.store(static_cast<uint32_t>(work.numBlockedFibers),
+                               std::memory_order_relaxed);
 
   if (!work.fibers.empty()) {
     // There's another fiber that has become unblocked, resume that.
@@ -494,6 +868,8 @@ void Scheduler::Worker::suspend(
   } else if (!idleFibers.empty()) {
     // There's an old fiber we can reuse, resume that.
     auto to = containers::take(idleFibers);
+    counters.idleFibers.store(static_cast<uint32_t>(idleFibers.size()),
+                              std::memory_order_relaxed);
     ASSERT_FIBER_STATE(to, Fiber::State::Idle);
     switchToFiber(to);
   } else {
@@ -503,8 +879,30 @@ void Scheduler::Worker::suspend(
   }
 
   work.numBlockedFibers--;
+  counters.blockedFibers.store(static_cast<uint32_t>(work.numBlockedFibers),
+                               std::memory_order_relaxed);
 
   setFiberState(currentFiber, Fiber::State::Running);
+
+  TRACE_END_FLOW(currentFiber->flow, "Resume");
+  currentFiber->flow = 0;
+  if (contentionStart != 0) {
+    auto task = currentFiber->task;
+    contention->record(contentionTable, currentFiber->blocker,
+                       currentFiber->blockerKind,
+                       task != nullptr ? task->site() : nullptr,
+                       CycleClock::now() - contentionStart);
+  }
+  if (accounting) {
+    if (auto task = currentFiber->task) {
+      // lastAccounted was updated by the switch back to this fiber.
+      accumulate(tags[task->tag()].blockedTicks,
+                 lastAccounted - currentFiber->suspendedTicks);
+    }
+  }
+  if (observer != nullptr) {
+    observer->onFiberResume(currentFiber);
+  }
 }
 
 bool Scheduler::Worker::tryLock() {
@@ -529,6 +927,7 @@ void Scheduler::Worker::enqueue(Fiber* fiber) {
         break;
     }
     notify = work.notifyAdded;
+    fiber->flow = TRACE_BEGIN_FLOW("Notify");
     work.fibers.push_back(fiber);
     MARL_ASSERT(!work.waiting.contains(fiber),
                 "fiber is unexpectedly in the waiting list");
@@ -546,9 +945,23 @@ void Scheduler::Worker::enqueue(Task&& task) {
   enqueueAndUnlock(std::move(task));
 }
 
+void Scheduler::Worker::enqueue(Task&& task, const TimePoint& deadline) {
+  bool notify = false;
+  {
+    marl::lock lock(work.mutex);
+    // Wake the worker if it is waiting for a later deadline.
+    notify = work.notifyAdded &&
+             (!work.delayed || deadline < work.delayed.next());
+    work.delayed.add(deadline, std::move(task));
+  }
+  if (notify) {
+    work.added.notify_one();
+  }
+}
+
 void Scheduler::Worker::enqueueAndUnlock(Task&& task) {
   auto notify = work.notifyAdded;
-  work.tasks.push_back(std::move(task));
+  work.tasks.push(std::move(task));
   work.num++;
   work.mutex.unlock();
   if (notify) {
@@ -556,19 +969,18 @@ void Scheduler::Worker::enqueueAndUnlock(Task&& task) {
   }
 }
 
-bool Scheduler::Worker::steal(Task& out) {
+bool Scheduler::Worker::steal(Worker* thief, Task& out) {
   if (work.num.load() == 0) {
     return false;
   }
   if (!work.mutex.try_lock()) {
     return false;
   }
-  if (work.tasks.empty() || work.tasks.front().is(Task::Flags::SameThread)) {
+  if (!work.tasks.take(out, thief->fairShare, true)) {
     work.mutex.unlock();
     return false;
   }
   work.num--;
-  out = containers::take(work.tasks);
   work.mutex.unlock();
   return true;
 }
@@ -580,7 +992,7 @@ void Scheduler::Worker::run() {
     // Start with a regular condition-variable wait for work. This avoids
     // starting the thread with a spinForWorkAndLock().
     work.wait([this]() REQUIRES(work.mutex) {
-      return work.num > 0 || work.waiting || shutdown;
+      return work.num > 0 || work.waiting || work.delayed || shutdown;
     });
   }
   ASSERT_FIBER_STATE(currentFiber, Fiber::State::Running);
@@ -589,7 +1001,8 @@ void Scheduler::Worker::run() {
 }
 
 void Scheduler::Worker::runUntilShutdown() {
-  while (!shutdown || work.num > 0 || work.numBlockedFibers > 0U) {
+  while (!shutdown || work.num > 0 || work.numBlockedFibers > 0U ||
+         work.delayed) {
     waitForWork();
     runUntilIdle();
   }
@@ -608,12 +1021,29 @@ void Scheduler::Worker::waitForWork() {
     spinForWorkAndLock();
   }
 
-  work.wait([this]() REQUIRES(work.mutex) {
-    return work.num > 0 || (shutdown && work.numBlockedFibers == 0U);
-  });
+  auto hasWork = [this]() REQUIRES(work.mutex) {
+    return work.num > 0 ||
+           (shutdown && work.numBlockedFibers == 0U && !work.delayed);
+  };
+  if (!hasWork()) {
+    account();
+    counters.parked.store(true, std::memory_order_relaxed);
+    if (observer != nullptr) {
+      observer->onWorkerPark(id);
+    }
+    work.wait(hasWork);
+    if (observer != nullptr) {
+      observer->onWorkerUnpark(id);
+    }
+    counters.parked.store(false, std::memory_order_relaxed);
+    lastAccounted = CycleClock::now();  // Parked time is not charged.
+  }
   if (work.waiting) {
     enqueueFiberTimeouts();
   }
+  if (work.delayed) {
+    enqueueDelayedTasks();
+  }
 }
 
 void Scheduler::Worker::enqueueFiberTimeouts() {
@@ -626,6 +1056,18 @@ void Scheduler::Worker::enqueueFiberTimeouts() {
   }
 }
 
+void Scheduler::Worker::enqueueDelayedTasks() {
+  auto now = std::chrono::system_clock::now();
+  Task task;
+  while (work.delayed.take(now, task)) {
+    if (accounting) {
+      task.enqueueTicks = CycleClock::now();  // Queued from the deadline.
+    }
+    work.tasks.push(std::move(task));
+    work.num++;
+  }
+}
+
 void Scheduler::Worker::changeFiberState(Fiber* fiber,
                                          Fiber::State from,
                                          Fiber::State to) const {
@@ -644,6 +1086,8 @@ void Scheduler::Worker::setFiberState(Fiber* fiber, Fiber::State to) const {
 
 void Scheduler::Worker::spinForWorkAndLock() {
   TRACE("SPIN");
+  counters.spinning.store(true, std::memory_order_relaxed);
+  defer(counters.spinning.store(false, std::memory_order_relaxed));
   Task stolen;
 
   constexpr auto duration = std::chrono::milliseconds(1);
@@ -671,12 +1115,20 @@ void Scheduler::Worker::spinForWorkAndLock() {
     }
 
     if (scheduler->stealWork(this, rng(), stolen)) {
+      TRACE_STEP_FLOW(stolen.flowID(), "Steal");
+      if (observer != nullptr) {
+        observer->onStealSucceeded(id, stolen);
+      }
       work.mutex.lock();
-      work.tasks.emplace_back(std::move(stolen));
+      work.tasks.push(std::move(stolen));
       work.num++;
       return;
     }
 
+    if (observer != nullptr) {
+      observer->onStealFailed(id);
+    }
+
     std::this_thread::yield();
   }
   work.mutex.lock();
@@ -691,6 +1143,12 @@ void Scheduler::Worker::runUntilIdle() {
     // or task at a time, as the Fiber may yield and these items may get
     // held on suspended fiber stack.
 
+    // Release the delayed tasks that are due, so they are not held back
+    // until the worker goes idle.
+    if (work.delayed) {
+      enqueueDelayedTasks();
+    }
+
     while (!work.fibers.empty()) {
       work.num--;
       auto fiber = containers::take(work.fibers);
@@ -701,6 +1159,8 @@ void Scheduler::Worker::runUntilIdle() {
 
       changeFiberState(currentFiber, Fiber::State::Running, Fiber::State::Idle);
       auto added = idleFibers.emplace(currentFiber).second;
+      counters.idleFibers.store(static_cast<uint32_t>(idleFibers.size()),
+                                std::memory_order_relaxed);
       (void)added;
       MARL_ASSERT(added, "fiber already idle");
 
@@ -710,11 +1170,24 @@ void Scheduler::Worker::runUntilIdle() {
 
     if (!work.tasks.empty()) {
       work.num--;
-      auto task = containers::take(work.tasks);
+      Task task;
+      work.tasks.take(task, fairShare, false);
       work.mutex.unlock();
 
       // Run the task.
-      task();
+      {
+        TRACE("Task");
+        TRACE_END_FLOW(task.flowID(), "Run");
+        beginTask(task);
+        if (observer != nullptr) {
+          observer->onTaskBegin(currentFiber, task);
+          task();
+          observer->onTaskEnd(currentFiber, task);
+        } else {
+          task();
+        }
+        endTask();
+      }
 
       // std::function<> can carry arguments with complex destructors.
       // Ensure these are destructed outside of the lock.
@@ -733,6 +1206,9 @@ Scheduler::Fiber* Scheduler::Worker::createWorkerFiber() {
                              [&]() REQUIRES(work.mutex) { run(); });
   auto ptr = fiber.get();
   workerFibers.emplace_back(std::move(fiber));
+  if (observer != nullptr) {
+    observer->onFiberCreated(id, ptr);
+  }
   return ptr;
 }
 
@@ -740,24 +1216,75 @@ void Scheduler::Worker::switchToFiber(Fiber* to) {
   DBG_LOG("%d: SWITCH(%d -> %d)", (int)id, (int)currentFiber->id, (int)to->id);
   MARL_ASSERT(to == mainFiber.get() || idleFibers.count(to) == 0,
               "switching to idle fiber");
+  account();
   auto from = currentFiber;
+  if (observer != nullptr) {
+    observer->onFiberSwitch(from, to);
+  }
   currentFiber = to;
   from->switchTo(to);
 }
 
+void Scheduler::Worker::account() {
+  if (!accounting) {
+    return;
+  }
+  auto now = CycleClock::now();
+  auto elapsed = now - lastAccounted;
+  lastAccounted = now;
+  accumulate(currentFiber->cpuTicks, elapsed);
+  if (auto task = currentFiber->task) {
+    accumulate(tags[task->tag()].cpuTicks, elapsed);
+    if (fairShare != nullptr) {
+      fairShare->charge(work.tasks.classOf(*task), elapsed);
+    }
+  }
+}
+
+void Scheduler::Worker::beginTask(const Task& task) {
+  if (accounting) {
+    account();
+    // Guard against small skews between the counters of different cores.
+    if (task.enqueueTicks != 0 && lastAccounted > task.enqueueTicks) {
+      accumulate(tags[task.tag()].queueTicks,
+                 lastAccounted - task.enqueueTicks);
+    }
+  }
+  currentFiber->task = &task;
+}
+
+void Scheduler::Worker::endTask() {
+  if (accounting) {
+    account();
+    accumulate(tags[currentFiber->task->tag()].tasks, 1);
+  }
+  currentFiber->task = nullptr;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // Scheduler::Worker::Work
 ////////////////////////////////////////////////////////////////////////////////
-Scheduler::Worker::Work::Work(Allocator* allocator)
-    : tasks(allocator), fibers(allocator), waiting(allocator) {}
+Scheduler::Worker::Work::Work(Allocator* allocator, size_t numClasses)
+    : tasks(allocator, numClasses),
+      fibers(allocator),
+      waiting(allocator),
+      delayed(allocator) {}
 
 template <typename F>
 void Scheduler::Worker::Work::wait(F&& f) {
   notifyAdded = true;
-  if (waiting) {
-    mutex.wait_until_locked(added, waiting.next(), f);
+  if (waiting || delayed) {
+    auto timeout = waiting ? waiting.next() : delayed.next();
+    if (delayed && delayed.next() < timeout) {
+      timeout = delayed.next();
+    }
+    // Also return if a task with an earlier deadline is delayed, so the
+    // caller can wait again with the new timeout.
+    mutex.wait_until_locked(added, timeout, [&]() REQUIRES(mutex) {
+      return f() || (delayed && delayed.next() < timeout);
+    });
   } else {
-    mutex.wait_locked(added, f);
+    mutex.wait_locked(added, [&]() REQUIRES(mutex) { return f() || delayed; });
   }
   notifyAdded = false;
 }
@@ -18,6 +18,8 @@
 
 #include "benchmark/benchmark.h"
 
+#include <atomic>
+
 BENCHMARK_DEFINE_F(Schedule, Empty)(benchmark::State& state) {
   run(state, [&](int numTasks) {
     for (auto _ : state) {
@@ -99,3 +101,40 @@ BENCHMARK_DEFINE_F(Schedule, SomeWorkWorkerAffinityOneOf)
 }
 BENCHMARK_REGISTER_F(Schedule, SomeWorkWorkerAffinityOneOf)
     ->Apply(Schedule::args);
+
+// Schedule/FairShare floods the scheduler with an equal number of tasks of
+// two classes weighted 1:3, and reports the share of the first half of the
+// tasks to complete that were of the second class, which should track 0.75.
+BENCHMARK_DEFINE_F(Schedule, FairShare)(benchmark::State& state) {
+  marl::Scheduler::Config cfg;
+  cfg.setFairShareWeights({1, 3});
+  run(state, cfg, [&](int numTasks) {
+    double share = 0;
+    for (auto _ : state) {
+      std::atomic<int> completed = {0};
+      std::atomic<int> completedClass1 = {0};
+      std::atomic<int> class1AtHalf = {0};
+      marl::WaitGroup wg(numTasks);
+      marl::schedule([&, wg] {
+        for (int i = 0; i < numTasks; i++) {
+          marl::Task task([&, wg, i] {
+            uint32_t value = doSomeWork(i);
+            benchmark::DoNotOptimize(value);
+            auto class1 = (i & 1) ? ++completedClass1 : completedClass1.load();
+            if (++completed == numTasks / 2) {
+              class1AtHalf = class1;
+            }
+            wg.done();
+          });
+          task.setTag(static_cast<marl::Task::Tag>(i & 1));
+          marl::schedule(std::move(task));
+        }
+      });
+      wg.wait();
+      share += static_cast<double>(class1AtHalf) / (numTasks / 2);
+    }
+    state.counters["class1_share"] =
+        share / static_cast<double>(state.iterations());
+  });
+}
+BENCHMARK_REGISTER_F(Schedule, FairShare)->Apply(Schedule::args<4096>);
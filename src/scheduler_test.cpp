@@ -20,6 +20,8 @@
 #include "marl/waitgroup.h"
 
 #include <atomic>
+#include <chrono>
+#include <thread>
 
 TEST_F(WithoutBoundScheduler, SchedulerConstructAndDestruct) {
   auto scheduler = std::unique_ptr<marl::Scheduler>(
@@ -94,6 +96,69 @@ TEST_P(WithBoundScheduler, DestructWithPendingFibers) {
   (new marl::Scheduler(marl::Scheduler::Config()))->bind();
 }
 
+TEST_P(WithBoundScheduler, DestructWithDelayedTasks) {
+  std::atomic<int> counter = {0};
+  auto deadline =
+      std::chrono::system_clock::now() + std::chrono::milliseconds(10);
+  auto scheduler = marl::Scheduler::get();
+  for (int i = 0; i < 100; i++) {
+    scheduler->enqueue(marl::Task([&] { counter++; }), deadline);
+  }
+
+  scheduler->unbind();
+  delete scheduler;
+
+  // All delayed tasks should be completed before the scheduler is destructed.
+  ASSERT_EQ(counter.load(), 100);
+  ASSERT_GE(std::chrono::system_clock::now(), deadline);
+
+  // Rebind a new scheduler so WithBoundScheduler::TearDown() is happy.
+  (new marl::Scheduler(marl::Scheduler::Config()))->bind();
+}
+
+TEST_P(WithBoundScheduler, EnqueueWithDeadline) {
+  auto start = std::chrono::system_clock::now();
+  std::atomic<int> early = {0};
+  marl::WaitGroup wg;
+  // Enqueue the latest deadlines first, so each new task is the earliest.
+  for (int i = 10; i > 0; i--) {
+    auto deadline = start + std::chrono::milliseconds(i * 2);
+    wg.add(1);
+    marl::Task task([&early, deadline, wg] {
+      if (std::chrono::system_clock::now() < deadline) {
+        early++;
+      }
+      wg.done();
+    });
+    marl::Scheduler::get()->enqueue(std::move(task), deadline);
+  }
+  wg.wait();
+  ASSERT_EQ(early.load(), 0);
+}
+
+TEST_F(WithoutBoundScheduler, EnqueueWithDeadlineFromNonWorker) {
+  marl::Scheduler::Config cfg;
+  cfg.setAllocator(allocator);
+  cfg.setWorkerThreadCount(1);
+  marl::Scheduler scheduler(cfg);
+  scheduler.bind();
+
+  // The bound thread never blocks in marl, so the task must be held by the
+  // worker thread to run.
+  std::atomic<bool> ran = {false};
+  auto start = std::chrono::system_clock::now();
+  scheduler.enqueue(marl::Task([&] { ran = true; }),
+                    start + std::chrono::milliseconds(10));
+  while (!ran &&
+         std::chrono::system_clock::now() - start < std::chrono::seconds(2)) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  auto result = ran.load();
+  scheduler.unbind();
+
+  ASSERT_TRUE(result);
+}
+
 TEST_P(WithBoundScheduler, ScheduleWithArgs) {
   std::string got;
   marl::WaitGroup wg(1);
@@ -181,6 +246,34 @@ TEST_F(WithoutBoundScheduler, TasksOnlyScheduledOnWorkerThreads) {
   ASSERT_EQ(threads.count(std::this_thread::get_id()), 0U);
 }
 
+TEST_F(WithoutBoundScheduler, EnqueueOnWorker) {
+  marl::Scheduler::Config cfg;
+  cfg.setWorkerThreadCount(4);
+
+  auto scheduler = std::unique_ptr<marl::Scheduler>(new marl::Scheduler(cfg));
+  scheduler->bind();
+  defer(scheduler->unbind());
+
+  ASSERT_EQ(marl::Scheduler::currentWorkerId(), -1);
+
+  std::atomic<int> badIds = {0};
+  marl::WaitGroup wg;
+  for (int i = 0; i < 1000; i++) {
+    wg.add(1);
+    scheduler->enqueue(marl::Task([&badIds, wg] {
+                         auto id = marl::Scheduler::currentWorkerId();
+                         if (id < 0 || id >= 4) {
+                           badIds++;
+                         }
+                         wg.done();
+                       }),
+                       i % 6 - 1);  // Includes out-of-range workers.
+  }
+  wg.wait();
+
+  ASSERT_EQ(badIds.load(), 0);
+}
+
 // Test that a marl::Scheduler *with dedicated worker threads* can be used
 // without first binding to the scheduling thread.
 TEST_F(WithoutBoundScheduler, ScheduleMTWWithNoBind) {
@@ -225,3 +318,236 @@ TEST_F(WithoutBoundScheduler, ScheduleSTWWithNoBind) {
   scheduler->enqueue(marl::Task([] { FAIL() << "Should not be called"; }));
 #endif
 }
+
+namespace {
+
+// CountingObserver counts the scheduler events it is notified of.
+class CountingObserver : public marl::Scheduler::Observer {
+ public:
+  void onTaskEnqueued(const marl::Task&) override { enqueued++; }
+  void onTaskBegin(const marl::Scheduler::Fiber*, const marl::Task&) override {
+    begun++;
+  }
+  void onTaskEnd(const marl::Scheduler::Fiber*, const marl::Task&) override {
+    ended++;
+  }
+  void onFiberCreated(uint32_t, const marl::Scheduler::Fiber*) override {
+    created++;
+  }
+  void onFiberSwitch(const marl::Scheduler::Fiber*,
+                     const marl::Scheduler::Fiber*) override {
+    switches++;
+  }
+  void onFiberSuspend(const marl::Scheduler::Fiber*) override { suspended++; }
+  void onFiberResume(const marl::Scheduler::Fiber*) override { resumed++; }
+
+  std::atomic<int> enqueued = {0};
+  std::atomic<int> begun = {0};
+  std::atomic<int> ended = {0};
+  std::atomic<int> created = {0};
+  std::atomic<int> suspended = {0};
+  std::atomic<int> resumed = {0};
+  std::atomic<int> switches = {0};
+};
+
+}  // anonymous namespace
+
+TEST_F(WithoutBoundScheduler, SchedulerObserver) {
+  for (int numThreads : {0, 1, 4}) {
+    auto observer = std::make_shared<CountingObserver>();
+    {
+      marl::Scheduler::Config config;
+      config.setAllocator(allocator);
+      config.setWorkerThreadCount(numThreads);
+      config.setObserver(observer);
+      marl::Scheduler scheduler(config);
+      scheduler.bind();
+
+      constexpr int numTasks = 10;
+      marl::WaitGroup wg(numTasks);
+      marl::Event event(marl::Event::Mode::Manual);
+      for (int i = 0; i < numTasks; i++) {
+        marl::schedule([=] {
+          event.wait();
+          wg.done();
+        });
+      }
+      marl::schedule([=] { event.signal(); });
+      wg.wait();
+      scheduler.unbind();
+    }
+
+    // Workers also run internal tasks that are not enqueued on the scheduler.
+    ASSERT_EQ(observer->enqueued, 11);
+    ASSERT_EQ(observer->begun, observer->ended);
+    ASSERT_GE(observer->ended, observer->enqueued);
+    if (numThreads == 0) {
+      ASSERT_GT(observer->created, 0);
+      ASSERT_GT(observer->switches, 0);
+    }
+    ASSERT_EQ(observer->suspended, observer->resumed);
+  }
+}
+
+namespace {
+
+// spinFor() busy-waits for the given duration.
+void spinFor(std::chrono::microseconds duration) {
+  auto end = std::chrono::steady_clock::now() + duration;
+  while (std::chrono::steady_clock::now() < end) {
+  }
+}
+
+// suspendFor() suspends the current fiber for the given duration.
+void suspendFor(std::chrono::milliseconds duration) {
+  marl::Event event;
+  event.wait_for(duration);
+}
+
+}  // anonymous namespace
+
+TEST_F(WithoutBoundScheduler, FiberCPUTime) {
+  for (int numThreads : {0, 2}) {
+    marl::Scheduler::Config config;
+    config.setAllocator(allocator);
+    config.setWorkerThreadCount(numThreads);
+    config.setTaskAccounting(true);
+    marl::Scheduler scheduler(config);
+    scheduler.bind();
+
+    marl::Scheduler::Fiber* fiber = nullptr;
+    marl::WaitGroup wg(1);
+    marl::schedule([&, wg] {
+      fiber = marl::Scheduler::Fiber::current();
+      spinFor(std::chrono::milliseconds(5));
+      suspendFor(std::chrono::milliseconds(1));  // Accounts the time spun.
+      wg.done();
+    });
+    wg.wait();
+    ASSERT_GE(fiber->cpuTime(), std::chrono::milliseconds(4));
+
+    scheduler.unbind();
+  }
+}
+
+TEST_F(WithoutBoundScheduler, SchedulerCPUTimeByTag) {
+  for (int numThreads : {0, 2}) {
+    marl::Scheduler::Config config;
+    config.setAllocator(allocator);
+    config.setWorkerThreadCount(numThreads);
+    config.setTaskAccounting(true);
+    marl::Scheduler scheduler(config);
+    scheduler.bind();
+
+    marl::WaitGroup wg(3);
+    marl::Task spin([=] {
+      spinFor(std::chrono::milliseconds(5));
+      suspendFor(std::chrono::milliseconds(1));  // Accounts the time spun.
+      wg.done();
+    });
+    spin.setTag(1);
+    marl::Task idle([=] { wg.done(); });
+    idle.setTag(2);
+    marl::Task block([=] {
+      suspendFor(std::chrono::milliseconds(20));
+      wg.done();
+    });
+    block.setTag(3);
+    scheduler.enqueue(std::move(spin));
+    scheduler.enqueue(std::move(idle));
+    scheduler.enqueue(std::move(block));
+    wg.wait();
+
+    auto spun = scheduler.cpuTime(1);
+    ASSERT_GE(spun, std::chrono::milliseconds(4));
+    ASSERT_LT(scheduler.cpuTime(2), spun);
+    // Time blocked in a wait is not charged to the task.
+    ASSERT_LT(scheduler.cpuTime(3), std::chrono::milliseconds(10));
+
+    // The statistics of unbound threads are retained.
+    scheduler.unbind();
+    ASSERT_GE(scheduler.cpuTime(1), std::chrono::milliseconds(4));
+  }
+}
+
+TEST_F(WithoutBoundScheduler, SchedulerTaskStats) {
+  for (int numThreads : {0, 2}) {
+    marl::Scheduler::Config config;
+    config.setAllocator(allocator);
+    config.setWorkerThreadCount(numThreads);
+    config.setTaskAccounting(true);
+    marl::Scheduler scheduler(config);
+    scheduler.bind();
+
+    constexpr int numChildren = 4;
+    marl::WaitGroup wg(1 + numChildren);
+    marl::Task parent([=] {
+      // Children inherit the tag of the parent.
+      for (int i = 0; i < numChildren; i++) {
+        marl::schedule([=] {
+          spinFor(std::chrono::milliseconds(1));
+          wg.done();
+        });
+      }
+      suspendFor(std::chrono::milliseconds(10));
+      wg.done();
+    });
+    parent.setTag(7);
+    scheduler.enqueue(std::move(parent));
+    wg.wait();
+
+    // Tasks are counted after they return, which may be after wg.done().
+    auto stats = scheduler.taskStats(7);
+    while (stats.tasks < uint64_t(1 + numChildren)) {
+      std::this_thread::yield();
+      stats = scheduler.taskStats(7);
+    }
+    ASSERT_EQ(stats.tasks, uint64_t(1 + numChildren));
+    ASSERT_GE(stats.cpuTime, std::chrono::milliseconds(numChildren - 1));
+    ASSERT_GE(stats.blockedTime, std::chrono::milliseconds(5));
+    ASSERT_GT(stats.queueTime, std::chrono::nanoseconds(0));
+    ASSERT_EQ(scheduler.taskStats(0).tasks, 0U);
+
+    scheduler.unbind();
+  }
+}
+
+TEST_F(WithoutBoundScheduler, SchedulerFairShareWeights) {
+  marl::Scheduler::Config config;
+  config.setAllocator(allocator);
+  config.setWorkerThreadCount(1);
+  config.setFairShareWeights({1, 3});
+  marl::Scheduler scheduler(config);
+  scheduler.bind();
+
+  constexpr int numTasksPerClass = 100;
+  std::atomic<int> completed = {0};
+  std::atomic<int> completedClass1 = {0};
+  std::atomic<int> class1AtHalf = {0};
+  marl::WaitGroup wg(2 * numTasksPerClass);
+  // Enqueue all the tasks from the single worker, so that both classes are
+  // queued before any of the tasks start.
+  marl::schedule([&, wg] {
+    for (int i = 0; i < numTasksPerClass; i++) {
+      for (marl::Task::Tag tag : {0, 1}) {
+        marl::Task task([&, wg, tag] {
+          spinFor(std::chrono::microseconds(200));
+          auto class1 = tag == 1 ? ++completedClass1 : completedClass1.load();
+          if (++completed == numTasksPerClass) {
+            class1AtHalf = class1;
+          }
+          wg.done();
+        });
+        task.setTag(tag);
+        marl::schedule(std::move(task));
+      }
+    }
+  });
+  wg.wait();
+
+  // Class 1 has 3/4 of the share, so should have run ~75 of the first 100.
+  ASSERT_GE(class1AtHalf.load(), 60);
+  ASSERT_LE(class1AtHalf.load(), 90);
+
+  scheduler.unbind();
+}
@@ -0,0 +1,249 @@
+// Copyright 2026 The Marl Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "marl/select.h"
+#include "marl/channel.h"
+#include "marl/defer.h"
+#include "marl/event.h"
+#include "marl/waitgroup.h"
+
+#include "marl_test.h"
+
+#include <deque>
+#include <numeric>
+
+namespace {
+
+// Queue is a mutex-guarded queue that implements Selectable, to test select()
+// with objects other than the marl primitives.
+class Queue {
+ public:
+  class PopCase : public marl::Selectable {
+   public:
+    PopCase(Queue* queue, int& out) : queue(queue), out(out) {}
+
+    bool tryComplete() override {
+      marl::lock lock(queue->mutex);
+      if (queue->items.empty()) {
+        return false;
+      }
+      out = queue->items.front();
+      queue->items.pop_front();
+      return true;
+    }
+
+    void add(marl::WaitList::Node& node, marl::Waiter& waiter) override {
+      marl::lock lock(queue->mutex);
+      queue->waiters.add(node, waiter);
+    }
+
+    bool remove(marl::WaitList::Node& node) override {
+      marl::lock lock(queue->mutex);
+      return queue->waiters.remove(node);
+    }
+
+    void notifyNext() override {
+      marl::lock lock(queue->mutex);
+      if (!queue->items.empty()) {
+        queue->waiters.notify(1);
+      }
+    }
+
+   private:
+    Queue* const queue;
+    int& out;
+  };
+
+  void push(int value) {
+    marl::lock lock(mutex);
+    items.push_back(value);
+    waiters.notify(1);
+  }
+
+  PopCase onPop(int& out) { return PopCase(this, out); }
+
+ private:
+  marl::mutex mutex;
+  std::deque<int> items;
+  marl::WaitList waiters;
+};
+
+}  // anonymous namespace
+
+TEST_P(WithBoundScheduler, SelectReady) {
+  marl::Channel<int> channel(4);
+  marl::Event event(marl::Event::Mode::Auto);
+  marl::WaitGroup wg(1);
+  int value = 0;
+  bool ok = false;
+
+  event.signal();
+  channel.send(10);
+  // The lowest ready case is completed.
+  ASSERT_EQ(marl::select(wg.onDone(), channel.onRecv(value, ok),
+                         event.onSignal()),
+            1);
+  ASSERT_TRUE(ok);
+  ASSERT_EQ(value, 10);
+  ASSERT_EQ(marl::select(channel.onRecv(value, ok), event.onSignal()), 1);
+  ASSERT_FALSE(event.isSignalled());
+  wg.done();
+  ASSERT_EQ(marl::select(channel.onRecv(value, ok), wg.onDone()), 1);
+}
+
+TEST_P(WithBoundScheduler, SelectTimeout) {
+  marl::Channel<int> channel(4);
+  marl::Event event;
+  int value = 0;
+  bool ok = false;
+  auto start = std::chrono::system_clock::now();
+  ASSERT_EQ(marl::select_for(std::chrono::milliseconds(10),
+                             channel.onRecv(value, ok), event.onSignal()),
+            -1);
+  ASSERT_GE(std::chrono::system_clock::now() - start,
+            std::chrono::milliseconds(10));
+
+  marl::schedule([=] {
+    int v = 20;
+    channel.send(v);
+  });
+  ASSERT_EQ(marl::select_for(std::chrono::seconds(10), event.onSignal(),
+                             channel.onRecv(value, ok)),
+            1);
+  ASSERT_TRUE(ok);
+  ASSERT_EQ(value, 20);
+}
+
+TEST_P(WithBoundScheduler, SelectChannels) {
+  constexpr int numValues = 1000;
+  marl::Channel<int> a(4);
+  marl::Channel<int> b(4);
+  marl::WaitGroup senders(2);
+  for (auto channel : {a, b}) {
+    marl::schedule([=] {
+      defer(senders.done());
+      for (int i = 0; i < numValues; i++) {
+        channel.send(i);
+      }
+      channel.close();
+    });
+  }
+
+  int value = 0;
+  bool ok = false;
+  int64_t sums[2] = {0, 0};
+  bool open[2] = {true, true};
+  while (open[0] || open[1]) {
+    // A closed channel's receive case always completes, so only select on
+    // the channels that are still open.
+    int index = open[0] && open[1]
+                    ? marl::select(a.onRecv(value, ok), b.onRecv(value, ok))
+                    : open[0] ? marl::select(a.onRecv(value, ok))
+                              : 1 + marl::select(b.onRecv(value, ok));
+    if (ok) {
+      sums[index] += value;
+    } else {
+      open[index] = false;
+    }
+  }
+  senders.wait();
+  int64_t expected = int64_t(numValues) * (numValues - 1) / 2;
+  ASSERT_EQ(sums[0], expected);
+  ASSERT_EQ(sums[1], expected);
+}
+
+TEST_P(WithBoundScheduler, SelectSend) {
+  marl::Channel<int> full(2);
+  marl::Channel<int> empty(2);
+  full.send(1);
+  full.send(2);
+  int value = 3;
+  bool ok = false;
+  ASSERT_EQ(marl::select(full.onSend(value, ok), empty.onSend(value, ok)), 1);
+  ASSERT_TRUE(ok);
+
+  marl::schedule([=] {
+    int v;
+    full.recv(v);
+  });
+  value = 4;
+  ASSERT_EQ(marl::select(full.onSend(value, ok)), 0);
+  ASSERT_TRUE(ok);
+
+  full.close();
+  ASSERT_EQ(marl::select(full.onSend(value, ok)), 0);
+  ASSERT_FALSE(ok);
+}
+
+TEST_P(WithBoundScheduler, SelectAutoEventWakesOne) {
+  constexpr int numSelectors = 16;
+  marl::Event event(marl::Event::Mode::Auto);
+  marl::Channel<int> never(2);
+  marl::Channel<int> woken(numSelectors);
+  for (int i = 0; i < numSelectors; i++) {
+    marl::schedule([=] {
+      int value;
+      bool ok;
+      ASSERT_EQ(marl::select(never.onRecv(value, ok), event.onSignal()), 1);
+      woken.send(i);
+    });
+  }
+  // Each signal completes the select of exactly one selector.
+  for (int i = 0; i < numSelectors; i++) {
+    event.signal();
+    int selector;
+    ASSERT_TRUE(woken.recv(selector));
+    ASSERT_FALSE(event.isSignalled());
+  }
+}
+
+TEST_P(WithBoundScheduler, SelectCustomSelectable) {
+  Queue queue;
+  marl::Event stop;
+  marl::WaitGroup wg(1);
+  int sum = 0;
+  marl::schedule([&, wg] {
+    // Popping takes priority, so the queue is drained before stopping.
+    int value = 0;
+    while (marl::select(queue.onPop(value), stop.onSignal()) == 0) {
+      sum += value;
+    }
+    wg.done();
+  });
+  for (int i = 1; i <= 100; i++) {
+    queue.push(i);
+  }
+  stop.signal();
+  wg.wait();
+  ASSERT_EQ(sum, 5050);
+}
+
+TEST_F(WithoutBoundScheduler, SelectDoesNotAllocate) {
+  marl::Channel<int> channel(4, allocator);
+  marl::Event event(marl::Event::Mode::Auto, false, allocator);
+  auto allocations = [&] {
+    auto histogram = allocator->stats().sizeHistogram;
+    return std::accumulate(histogram.begin(), histogram.end(), size_t(0));
+  };
+  auto before = allocations();
+  int value = 0;
+  bool ok = false;
+  ASSERT_EQ(marl::select_for(std::chrono::milliseconds(1),
+                             channel.onRecv(value, ok), event.onSignal()),
+            -1);
+  event.signal();
+  ASSERT_EQ(marl::select(channel.onRecv(value, ok), event.onSignal()), 1);
+  ASSERT_EQ(allocations(), before);
+}
@@ -0,0 +1,129 @@
+// Copyright 2026 The Marl Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "marl_test.h"
+
+#include "marl/event.h"
+#include "marl/sequencer.h"
+#include "marl/waitgroup.h"
+
+#include <chrono>
+
+TEST_P(WithBoundScheduler, Sequencer) {
+  marl::Sequencer sequencer(marl::Sequencer::DefaultCapacity, allocator);
+
+  constexpr int count = 1000;
+  std::atomic<int> next = {0};
+  int result[count] = {};
+
+  for (int i = 0; i < count; i++) {
+    auto ticket = sequencer.take();
+    marl::schedule([ticket, i, &result, &next] {
+      ticket.wait();
+      result[next++] = i;
+      ticket.done();
+    });
+  }
+
+  sequencer.take().wait();
+
+  for (int i = 0; i < count; i++) {
+    ASSERT_EQ(result[i], i);
+  }
+}
+
+TEST_P(WithBoundScheduler, SequencerTakeBatch) {
+  marl::Sequencer sequencer(16, allocator);
+
+  constexpr int count = 1000;
+  std::atomic<int> next = {0};
+  int result[count] = {};
+
+  int i = 0;
+  sequencer.take(count, [&](marl::Sequencer::Ticket&& ticket) {
+    marl::schedule([ticket, i, &result, &next] {
+      ticket.wait();
+      result[next++] = i;
+    });
+    i++;
+  });
+
+  sequencer.take().wait();
+
+  for (int i = 0; i < count; i++) {
+    ASSERT_EQ(result[i], i);
+  }
+}
+
+TEST_P(WithBoundScheduler, SequencerDoneOutOfOrder) {
+  marl::Sequencer sequencer(4, allocator);
+  auto a = sequencer.take();
+  auto b = sequencer.take();
+  auto c = sequencer.take();
+  c.done();
+  b.done();
+  auto d = sequencer.take();
+  a.done();
+  d.wait();
+  d.done();
+}
+
+TEST_P(WithBoundScheduler, SequencerOnCall) {
+  marl::Sequencer sequencer(8, allocator);
+
+  constexpr int count = 100;
+  marl::WaitGroup wg(count);
+  std::atomic<int> next = {0};
+  int result[count] = {};
+
+  for (int i = 0; i < count; i++) {
+    auto ticket = sequencer.take();
+    ticket.onCall([ticket, i, wg, &result, &next] {
+      result[next++] = i;
+      ticket.done();
+      wg.done();
+    });
+  }
+
+  wg.wait();
+
+  for (int i = 0; i < count; i++) {
+    ASSERT_EQ(result[i], i);
+  }
+}
+
+// Finishes each ticket as soon as it is called, racing with the dispatch of
+// the callbacks registered with onCall(). No callback must be dropped.
+TEST_P(WithBoundScheduler, SequencerOnCallDoneRace) {
+  marl::Sequencer sequencer(8, allocator);
+
+  constexpr int count = 10000;
+  std::atomic<int> numCalled = {0};
+  marl::Event allCalled;
+
+  for (int i = 0; i < count; i++) {
+    auto ticket = sequencer.take();
+    ticket.onCall([&numCalled, allCalled] {
+      if (++numCalled == count) {
+        allCalled.signal();
+      }
+    });
+    marl::schedule([ticket] {
+      ticket.wait();
+      ticket.done();
+    });
+  }
+
+  ASSERT_TRUE(allCalled.wait_for(std::chrono::seconds(10)));
+}
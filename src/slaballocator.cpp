@@ -0,0 +1,406 @@
+// Copyright 2026 The Marl Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "marl/slaballocator.h"
+
+#include "marl/debug.h"
+#include "marl/thread.h"
+
+#include <algorithm>
+#include <functional>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#ifdef MARL_USE_PTHREAD_THREAD_LOCAL
+#include <pthread.h>
+#endif
+
+namespace {
+
+// The block sizes of each of the size classes.
+// Each block is aligned to the largest power of two that divides its size, up
+// to SlabAllocator::MaxBlockSize.
+constexpr uint16_t kClassSizes[] = {
+    16,  32,  48,  64,   80,   96,   112,  128,  160,  192,
+    224, 256, 320, 384,  448,  512,  640,  768,  896,  1024,
+    1280, 1536, 1792, 2048, 2560, 3072, 3584, 4096,
+};
+
+// Granularity of the size to class lookup table.
+constexpr size_t kLookupGranularity = 16;
+
+// SizeToClass is a lookup table from an allocation size (divided by
+// kLookupGranularity, rounded up) to the smallest size class that can hold it.
+struct SizeToClass {
+  static constexpr size_t NumEntries =
+      marl::SlabAllocator::MaxBlockSize / kLookupGranularity + 1;
+
+  SizeToClass() {
+    uint8_t cls = 0;
+    for (size_t i = 0; i < NumEntries; i++) {
+      while (kClassSizes[cls] < i * kLookupGranularity) {
+        cls++;
+      }
+      table[i] = cls;
+    }
+  }
+
+  uint8_t table[NumEntries];
+};
+
+const SizeToClass sizeToClass;
+
+std::atomic<uint64_t> nextSlabAllocatorId = {1};
+
+// The address of threadExited is assigned to SlabAllocator::current once the
+// thread has released its caches on exit. Allocations made by the thread after
+// that bypass the caches.
+char threadExited;
+
+// Registry holds the live SlabAllocators, so that an exiting thread only
+// releases the caches of allocators that have not been destructed.
+struct Registry {
+  // get() returns the registry. It is never destructed, as threads may exit
+  // after static destruction.
+  static Registry& get() {
+    static Registry* registry = new Registry();
+    return *registry;
+  }
+
+  marl::mutex mutex;
+  GUARDED_BY(mutex)
+  std::unordered_map<uint64_t, marl::SlabAllocator*> allocators;
+};
+
+}  // anonymous namespace
+
+namespace marl {
+
+MARL_INSTANTIATE_THREAD_LOCAL(SlabAllocator::Cache*,
+                              SlabAllocator::current,
+                              nullptr);
+
+struct SlabAllocator::ThreadCaches {
+  // Claim is a cache claimed by the thread, and the identifier of its
+  // allocator. Identifiers are never reused, so the claims of destructed
+  // allocators are never matched.
+  struct Claim {
+    uint64_t allocator;
+    Cache* cache;
+  };
+
+  ~ThreadCaches();
+
+  // get() returns the ThreadCaches of the calling thread.
+  static ThreadCaches& get();
+
+  // add() records that the calling thread has claimed the cache c of
+  // allocator, dropping the claims of destructed allocators.
+  void add(SlabAllocator* allocator, Cache* c);
+
+  std::vector<Claim> claims;
+};
+
+SlabAllocator::ThreadCaches::~ThreadCaches() {
+  current = reinterpret_cast<Cache*>(&threadExited);
+  auto& registry = Registry::get();
+  marl::lock lock(registry.mutex);
+  for (auto& claim : claims) {
+    auto it = registry.allocators.find(claim.allocator);
+    if (it != registry.allocators.end()) {
+      it->second->releaseCache(claim.cache);
+    }
+  }
+}
+
+SlabAllocator::ThreadCaches& SlabAllocator::ThreadCaches::get() {
+#ifdef MARL_USE_PTHREAD_THREAD_LOCAL
+  static pthread_key_t key = [] {
+    pthread_key_t k;
+    pthread_key_create(&k, [](void* caches) {
+      delete static_cast<ThreadCaches*>(caches);
+    });
+    return k;
+  }();
+  auto caches = static_cast<ThreadCaches*>(pthread_getspecific(key));
+  if (caches == nullptr) {
+    caches = new ThreadCaches();
+    pthread_setspecific(key, caches);
+  }
+  return *caches;
+#else
+  static thread_local ThreadCaches caches;
+  return caches;
+#endif
+}
+
+void SlabAllocator::ThreadCaches::add(SlabAllocator* allocator, Cache* c) {
+  auto& registry = Registry::get();
+  marl::lock lock(registry.mutex);
+  claims.erase(std::remove_if(claims.begin(), claims.end(),
+                              [&](const Claim& claim) {
+                                return registry.allocators.count(
+                                           claim.allocator) == 0;
+                              }),
+               claims.end());
+  claims.push_back(Claim{allocator->id, c});
+}
+
+SlabAllocator::SlabAllocator(Allocator* parent /* = Allocator::Default */)
+    : SlabAllocator(Config{}, parent) {}
+
+SlabAllocator::SlabAllocator(const Config& config_,
+                             Allocator* parent_ /* = Allocator::Default */)
+    : config(config_),
+      parent(parent_),
+      id(nextSlabAllocatorId++),
+      slabs(parent_) {
+  static_assert(sizeof(kClassSizes) / sizeof(kClassSizes[0]) == NumClasses,
+                "NumClasses does not match the size class table");
+  MARL_ASSERT(config.slabSize >= MaxBlockSize,
+              "SlabAllocator slabSize (%d) must be at least %d bytes",
+              int(config.slabSize), int(MaxBlockSize));
+
+  numCaches = config.numCaches;
+  if (numCaches == 0) {
+    numCaches = std::max<size_t>(64, 4 * Thread::numLogicalCPUs());
+  }
+
+  Allocation::Request request;
+  request.size = sizeof(Cache) * numCaches;
+  request.alignment = alignof(Cache);
+  request.usage = Allocation::Usage::Create;
+  caches = reinterpret_cast<Cache*>(parent->allocate(request).ptr);
+  for (size_t i = 0; i < numCaches; i++) {
+    new (&caches[i]) Cache();
+  }
+
+  auto& registry = Registry::get();
+  marl::lock lock(registry.mutex);
+  registry.allocators.emplace(id, this);
+}
+
+SlabAllocator::~SlabAllocator() {
+  {
+    // Once unregistered, exiting threads no longer touch the caches.
+    auto& registry = Registry::get();
+    marl::lock lock(registry.mutex);
+    registry.allocators.erase(id);
+  }
+
+  for (size_t i = 0; i < numCaches; i++) {
+    caches[i].~Cache();
+  }
+  Allocation allocation;
+  allocation.ptr = caches;
+  allocation.request.size = sizeof(Cache) * numCaches;
+  allocation.request.alignment = alignof(Cache);
+  allocation.request.usage = Allocation::Usage::Create;
+  parent->free(allocation);
+
+  marl::lock lock(slabsMutex);
+  for (auto& slab : slabs) {
+    parent->free(slab);
+  }
+}
+
+size_t SlabAllocator::bytesReserved() const {
+  return reserved.load(std::memory_order_relaxed);
+}
+
+int SlabAllocator::classOf(const Allocation::Request& request) const {
+  if (request.useGuards || request.size > MaxBlockSize ||
+      request.alignment > MaxBlockSize) {
+    return -1;
+  }
+  auto size = std::max<size_t>(request.size, 1);
+  auto alignment = std::max<size_t>(request.alignment, 1);
+  int cls = sizeToClass.table[(size + kLookupGranularity - 1) /
+                              kLookupGranularity];
+  while (cls < int(NumClasses) && (kClassSizes[cls] & (alignment - 1)) != 0) {
+    cls++;
+  }
+  return cls < int(NumClasses) ? cls : -1;
+}
+
+SlabAllocator::Cache* SlabAllocator::cache() {
+  auto self = std::this_thread::get_id();
+
+  // current may point into the caches of another SlabAllocator, or one that
+  // has been destructed, so only dereference it once it is known to be one of
+  // ours. Caches are only released by their owning thread as it exits, so a
+  // cache owned by this thread remains owned by this thread.
+  Cache* c = current;
+  if (c == reinterpret_cast<Cache*>(&threadExited)) {
+    return nullptr;
+  }
+  auto addr = reinterpret_cast<uintptr_t>(c);
+  auto begin = reinterpret_cast<uintptr_t>(caches);
+  auto end = reinterpret_cast<uintptr_t>(caches + numCaches);
+  if (addr >= begin && addr < end &&
+      c->owner.load(std::memory_order_relaxed) == self) {
+    return c;
+  }
+
+  // Find the cache owned by this thread, or claim a new one, probing from the
+  // thread's hash.
+  auto start = std::hash<std::thread::id>()(self) % numCaches;
+  for (size_t i = 0; i < numCaches; i++) {
+    c = &caches[(start + i) % numCaches];
+    auto owner = c->owner.load(std::memory_order_relaxed);
+    if (owner == std::thread::id() &&
+        c->owner.compare_exchange_strong(owner, self)) {
+      ThreadCaches::get().add(this, c);
+      owner = self;
+    }
+    if (owner == self) {
+      current = c;
+      return c;
+    }
+  }
+  return nullptr;
+}
+
+Allocation SlabAllocator::allocate(const Allocation::Request& request) {
+  auto cls = classOf(request);
+  if (cls < 0) {
+    return parent->allocate(request);
+  }
+
+  Allocation allocation;
+  allocation.request = request;
+
+  auto c = cache();
+  if (c == nullptr) {
+    BlockList list;
+    refill(cls, 1, list);
+    allocation.ptr = list.head;
+    return allocation;
+  }
+
+  auto& list = c->lists[cls];
+  if (list.head == nullptr) {
+    // Cache miss. Take a batch of blocks from the size class.
+    refill(cls, std::max<size_t>(config.cacheCapacity / 2, 1), list);
+  }
+  auto block = list.head;
+  list.head = block->next;
+  list.count--;
+  allocation.ptr = block;
+  return allocation;
+}
+
+void SlabAllocator::free(const Allocation& allocation) {
+  auto cls = classOf(allocation.request);
+  if (cls < 0) {
+    return parent->free(allocation);
+  }
+
+  auto block = reinterpret_cast<Block*>(allocation.ptr);
+  auto c = cache();
+  if (c == nullptr) {
+    BlockList list;
+    block->next = nullptr;
+    list.head = block;
+    list.count = 1;
+    release(cls, list);
+    return;
+  }
+
+  auto& list = c->lists[cls];
+  block->next = list.head;
+  list.head = block;
+  list.count++;
+  if (list.count > config.cacheCapacity) {
+    // Cache is full. Move half of the blocks back to the size class.
+    BlockList spill;
+    auto keep = config.cacheCapacity / 2;
+    while (list.count > keep) {
+      auto b = list.head;
+      list.head = b->next;
+      list.count--;
+      b->next = spill.head;
+      spill.head = b;
+      spill.count++;
+    }
+    release(cls, spill);
+  }
+}
+
+void SlabAllocator::releaseCache(Cache* c) {
+  for (size_t cls = 0; cls < NumClasses; cls++) {
+    if (c->lists[cls].head != nullptr) {
+      release(static_cast<int>(cls), c->lists[cls]);
+    }
+  }
+  c->owner.store(std::thread::id(), std::memory_order_release);
+}
+
+void SlabAllocator::refill(int cls, size_t count, BlockList& out) {
+  auto& sc = classes[cls];
+  const size_t blockSize = kClassSizes[cls];
+
+  marl::lock lock(sc.mutex);
+  while (out.count < count && sc.free.head != nullptr) {
+    auto block = sc.free.head;
+    sc.free.head = block->next;
+    sc.free.count--;
+    block->next = out.head;
+    out.head = block;
+    out.count++;
+  }
+
+  while (out.count < count) {
+    if (static_cast<size_t>(sc.end - sc.next) < blockSize) {
+      if (out.count > 0) {
+        break;
+      }
+      // Slab exhausted. Allocate another from the parent.
+      Allocation::Request request;
+      request.size = config.slabSize;
+      request.alignment = MaxBlockSize;
+      request.usage = Allocation::Usage::Undefined;
+      auto slab = parent->allocate(request);
+      {
+        marl::lock slabsLock(slabsMutex);
+        slabs.push_back(slab);
+      }
+      reserved.fetch_add(config.slabSize, std::memory_order_relaxed);
+      sc.next = reinterpret_cast<uint8_t*>(slab.ptr);
+      sc.end = sc.next + config.slabSize;
+    }
+    auto block = reinterpret_cast<Block*>(sc.next);
+    sc.next += blockSize;
+    block->next = out.head;
+    out.head = block;
+    out.count++;
+  }
+}
+
+void SlabAllocator::release(int cls, BlockList& list) {
+  auto tail = list.head;
+  while (tail->next != nullptr) {
+    tail = tail->next;
+  }
+
+  auto& sc = classes[cls];
+  marl::lock lock(sc.mutex);
+  tail->next = sc.free.head;
+  sc.free.head = list.head;
+  sc.free.count += list.count;
+  list = BlockList{};
+}
+
+}  // namespace marl
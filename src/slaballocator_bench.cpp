@@ -0,0 +1,121 @@
+// Copyright 2026 The Marl Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "marl_bench.h"
+
+#include "marl/containers.h"
+#include "marl/slaballocator.h"
+#include "marl/waitgroup.h"
+
+#include "benchmark/benchmark.h"
+
+namespace {
+
+// Number of allocations made by each task.
+constexpr int allocationsPerTask = 64;
+
+// allocateAndFree() allocates a number of blocks of varying size from
+// allocator, then frees them all.
+void allocateAndFree(marl::Allocator* allocator) {
+  marl::Allocation allocations[allocationsPerTask];
+  for (int i = 0; i < allocationsPerTask; i++) {
+    marl::Allocation::Request request;
+    request.size = 16 + (i * 37) % 500;
+    request.alignment = 8;
+    request.usage = marl::Allocation::Usage::Create;
+    allocations[i] = allocator->allocate(request);
+    benchmark::DoNotOptimize(allocations[i].ptr);
+  }
+  for (int i = 0; i < allocationsPerTask; i++) {
+    allocator->free(allocations[i]);
+  }
+}
+
+// allocateTasks() schedules numTasks tasks that each call allocateAndFree()
+// with allocator, and waits for them to complete.
+void allocateTasks(marl::Allocator* allocator, int numTasks) {
+  marl::WaitGroup wg(numTasks);
+  for (int i = 0; i < numTasks; i++) {
+    marl::schedule([=] {
+      allocateAndFree(allocator);
+      wg.done();
+    });
+  }
+  wg.wait();
+}
+
+// scheduleTasks() schedules numTasks tasks that each fill a small container,
+// and waits for them to complete. This exercises the scheduler's internal
+// allocations as well as the containers.
+void scheduleTasks(int numTasks) {
+  marl::WaitGroup wg(numTasks);
+  for (int i = 0; i < numTasks; i++) {
+    marl::schedule([=] {
+      marl::containers::list<int> list(marl::Scheduler::get()
+                                           ->config()
+                                           .allocator);
+      for (int j = 0; j < allocationsPerTask; j++) {
+        list.emplace_front(j);
+      }
+      wg.done();
+    });
+  }
+  wg.wait();
+}
+
+}  // anonymous namespace
+
+BENCHMARK_DEFINE_F(Schedule, DefaultAllocator)(benchmark::State& state) {
+  run(state, [&](int numTasks) {
+    for (auto _ : state) {
+      allocateTasks(marl::Allocator::Default, numTasks);
+    }
+  });
+}
+BENCHMARK_REGISTER_F(Schedule, DefaultAllocator)->Apply(Schedule::args<512>);
+
+BENCHMARK_DEFINE_F(Schedule, SlabAllocator)(benchmark::State& state) {
+  marl::SlabAllocator slab;
+  run(state, [&](int numTasks) {
+    for (auto _ : state) {
+      allocateTasks(&slab, numTasks);
+    }
+  });
+}
+BENCHMARK_REGISTER_F(Schedule, SlabAllocator)->Apply(Schedule::args<512>);
+
+BENCHMARK_DEFINE_F(Schedule, DefaultAllocatorScheduler)
+(benchmark::State& state) {
+  run(state, [&](int numTasks) {
+    for (auto _ : state) {
+      scheduleTasks(numTasks);
+    }
+  });
+}
+BENCHMARK_REGISTER_F(Schedule, DefaultAllocatorScheduler)
+    ->Apply(Schedule::args<512>);
+
+BENCHMARK_DEFINE_F(Schedule, SlabAllocatorScheduler)
+(benchmark::State& state) {
+  marl::SlabAllocator slab;
+  marl::Scheduler::Config cfg;
+  cfg.setAllocator(&slab);
+  run(state, cfg, [&](int numTasks) {
+    for (auto _ : state) {
+      scheduleTasks(numTasks);
+    }
+  });
+}
+BENCHMARK_REGISTER_F(Schedule, SlabAllocatorScheduler)
+    ->Apply(Schedule::args<512>);
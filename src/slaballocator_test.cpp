@@ -0,0 +1,169 @@
+// Copyright 2026 The Marl Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "marl/slaballocator.h"
+
+#include "marl_test.h"
+
+#include "marl/defer.h"
+#include "marl/waitgroup.h"
+
+#include <cstring>
+#include <thread>
+#include <vector>
+
+TEST_F(WithoutBoundScheduler, SlabAllocatorAlignedAllocate) {
+  marl::SlabAllocator slab(allocator);
+  for (auto useGuards : {false, true}) {
+    for (auto alignment : {1, 2, 4, 8, 16, 32, 64, 128, 1024, 4096, 8192}) {
+      for (auto size : {1,   2,   3,   4,   5,    7,    8,    14,   16,
+                        17,  31,  34,  50,  63,   64,   65,   100,  127,
+                        128, 129, 200, 255, 256,  257,  500,  511,  512,
+                        513, 999, 1024, 3000, 4095, 4096, 4097, 10000}) {
+        if (useGuards && alignment >= 1024) {
+          continue;  // Guarded allocations must be aligned below a page.
+        }
+        marl::Allocation::Request request;
+        request.alignment = alignment;
+        request.size = size;
+        request.useGuards = useGuards;
+
+        auto allocation = slab.allocate(request);
+        auto ptr = allocation.ptr;
+        ASSERT_EQ(allocation.request.size, request.size);
+        ASSERT_EQ(allocation.request.alignment, request.alignment);
+        ASSERT_EQ(allocation.request.useGuards, request.useGuards);
+        ASSERT_EQ(allocation.request.usage, request.usage);
+        ASSERT_EQ(reinterpret_cast<uintptr_t>(ptr) & (alignment - 1), 0U);
+        memset(ptr, 0, size);  // Check the memory was actually allocated.
+        slab.free(allocation);
+      }
+    }
+  }
+}
+
+TEST_F(WithoutBoundScheduler, SlabAllocatorReuse) {
+  marl::SlabAllocator slab(allocator);
+
+  marl::Allocation::Request request;
+  request.size = 40;
+  request.alignment = 8;
+
+  // Blocks are served from the calling thread's cache, and freed blocks are
+  // reused.
+  auto a = slab.allocate(request);
+  slab.free(a);
+  auto b = slab.allocate(request);
+  ASSERT_EQ(a.ptr, b.ptr);
+  slab.free(b);
+
+  // Live allocations never overlap.
+  std::vector<marl::Allocation> allocations;
+  for (int i = 0; i < 1000; i++) {
+    auto allocation = slab.allocate(request);
+    memset(allocation.ptr, i & 0xff, request.size);
+    allocations.push_back(allocation);
+  }
+  for (int i = 0; i < 1000; i++) {
+    auto ptr = reinterpret_cast<uint8_t*>(allocations[i].ptr);
+    for (size_t j = 0; j < request.size; j++) {
+      ASSERT_EQ(ptr[j], i & 0xff);
+    }
+    slab.free(allocations[i]);
+  }
+}
+
+TEST_F(WithoutBoundScheduler, SlabAllocatorCrossThreadFree) {
+  marl::SlabAllocator::Config config;
+  config.cacheCapacity = 8;
+  marl::SlabAllocator slab(config, allocator);
+
+  marl::Allocation::Request request;
+  request.size = 64;
+  request.alignment = 64;
+
+  // Repeatedly allocate on one thread and free on another. Freed blocks must
+  // flow back to the allocating thread, so the reserved memory stays bounded.
+  constexpr int count = 256;
+  for (int iteration = 0; iteration < 20; iteration++) {
+    std::vector<marl::Allocation> allocations;
+    for (int i = 0; i < count; i++) {
+      allocations.push_back(slab.allocate(request));
+    }
+    std::thread([&] {
+      for (auto& allocation : allocations) {
+        slab.free(allocation);
+      }
+    }).join();
+  }
+  ASSERT_LE(slab.bytesReserved(), 2 * config.slabSize);
+}
+
+TEST_F(WithoutBoundScheduler, SlabAllocatorReleaseOnThreadExit) {
+  marl::SlabAllocator::Config config;
+  config.cacheCapacity = 2;
+  config.numCaches = 1;
+  marl::SlabAllocator slab(config, allocator);
+
+  marl::Allocation::Request request;
+  request.size = 64;
+  request.alignment = 64;
+
+  // Each thread claims the only cache, and frees its block into it. The
+  // cache must be flushed and released as the thread exits, so the next
+  // thread can claim it and reuse the block. Each thread is started before
+  // the previous one exits, so that no two threads share an identifier.
+  constexpr int count = 100;
+  void* ptrs[count] = {};
+  std::thread previous;
+  for (int i = 0; i < count; i++) {
+    previous = std::thread([&, i](std::thread previous) {
+      if (previous.joinable()) {
+        previous.join();
+      }
+      auto allocation = slab.allocate(request);
+      ptrs[i] = allocation.ptr;
+      slab.free(allocation);
+    }, std::move(previous));
+  }
+  previous.join();
+
+  for (int i = 1; i < count; i++) {
+    ASSERT_EQ(ptrs[i], ptrs[0]);
+  }
+}
+
+TEST_F(WithoutBoundScheduler, SlabAllocatorScheduler) {
+  marl::SlabAllocator slab(allocator);
+
+  marl::Scheduler::Config cfg;
+  cfg.setAllocator(&slab);
+  cfg.setWorkerThreadCount(4);
+  cfg.setFiberStackSize(0x10000);
+
+  marl::Scheduler scheduler(cfg);
+  scheduler.bind();
+  defer(scheduler.unbind());
+
+  constexpr int count = 1000;
+  marl::WaitGroup wg(count);
+  for (int i = 0; i < count; i++) {
+    marl::schedule([&slab, wg] {
+      auto ptr = slab.make_unique<std::array<int, 20>>();
+      ptr->fill(1);
+      wg.done();
+    });
+  }
+  wg.wait();
+}
@@ -0,0 +1,91 @@
+// Copyright 2026 The Marl Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "marl/taskprofiler.h"
+
+#include <algorithm>
+
+namespace marl {
+
+TaskProfiler::TaskProfiler(Allocator* allocator /* = Allocator::Default */)
+    : allocator(allocator), timings(allocator), running(allocator) {}
+
+TaskProfiler::Sites TaskProfiler::sites() {
+  Sites out(allocator);
+  {
+    marl::lock lock(mutex);
+    out.reserve(timings.size());
+    for (auto& it : timings) {
+      out.push_back(it.second);
+    }
+  }
+  std::sort(out.begin(), out.end(),
+            [](const Site& a, const Site& b) { return a.total > b.total; });
+  return out;
+}
+
+void TaskProfiler::reset() {
+  marl::lock lock(mutex);
+  timings.clear();
+}
+
+void TaskProfiler::onTaskBegin(const Scheduler::Fiber* fiber, const Task&) {
+  auto now = Clock::now();
+  marl::lock lock(mutex);
+  auto& task = running[fiber];
+  task.start = now;
+  task.blocked = Duration(0);
+}
+
+void TaskProfiler::onTaskEnd(const Scheduler::Fiber* fiber, const Task& task) {
+  auto now = Clock::now();
+  marl::lock lock(mutex);
+  auto it = running.find(fiber);
+  if (it == running.end()) {
+    return;
+  }
+  auto elapsed = std::chrono::duration_cast<Duration>(now - it->second.start);
+  auto blocked = it->second.blocked;
+  running.erase(it);
+
+  auto& site = timings[task.site()];
+  if (site.name == nullptr) {
+    site.name = task.site() != nullptr ? task.site()->name() : "<unknown>";
+  }
+  site.count++;
+  site.total += elapsed;
+  site.blocked += blocked;
+  site.max = std::max(site.max, elapsed);
+}
+
+void TaskProfiler::onFiberSuspend(const Scheduler::Fiber* fiber) {
+  auto now = Clock::now();
+  marl::lock lock(mutex);
+  auto it = running.find(fiber);
+  if (it != running.end()) {
+    it->second.suspended = now;
+  }
+}
+
+void TaskProfiler::onFiberResume(const Scheduler::Fiber* fiber) {
+  auto now = Clock::now();
+  marl::lock lock(mutex);
+  auto it = running.find(fiber);
+  if (it != running.end()) {
+    it->second.blocked +=
+        std::chrono::duration_cast<Duration>(now - it->second.suspended);
+  }
+}
+
+}  // namespace marl
@@ -0,0 +1,77 @@
+// Copyright 2026 The Marl Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "marl/taskprofiler.h"
+
+#include "marl_test.h"
+
+#include "marl/event.h"
+#include "marl/waitgroup.h"
+
+#include <thread>
+
+TEST_F(WithoutBoundScheduler, TaskProfilerSites) {
+  auto profiler = std::make_shared<marl::TaskProfiler>(allocator);
+  {
+    marl::Scheduler::Config config;
+    config.setAllocator(allocator);
+    config.setWorkerThreadCount(2);
+    config.setObserver(profiler);
+    marl::Scheduler scheduler(config);
+    scheduler.bind();
+
+    marl::WaitGroup wg(10);
+    marl::Event event(marl::Event::Mode::Manual);
+    for (int i = 0; i < 5; i++) {
+      marl::schedule([=] {
+        event.wait();
+        wg.done();
+      });
+    }
+    for (int i = 0; i < 5; i++) {
+      marl::schedule([=] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        wg.done();
+      });
+    }
+    marl::schedule([=] {
+      std::this_thread::sleep_for(std::chrono::milliseconds(5));
+      event.signal();
+    });
+    wg.wait();
+    scheduler.unbind();
+  }
+
+  auto sites = profiler->sites();
+  uint64_t count = 0;
+  for (size_t i = 0; i < sites.size(); i++) {
+    auto& site = sites[i];
+    ASSERT_NE(site.name, nullptr);
+    ASSERT_GT(site.count, 0U);
+    ASSERT_LE(site.blocked, site.total);
+    ASSERT_LE(site.max, site.total);
+    if (i > 0) {
+      ASSERT_LE(site.total, sites[i - 1].total);
+    }
+    count += site.count;
+  }
+  ASSERT_GE(count, 11U);
+#if MARL_TASK_HAS_RTTI
+  // Each lambda is a distinct site, plus the workers' shutdown tasks.
+  ASSERT_GE(sites.size(), 3U);
+#endif
+
+  profiler->reset();
+  ASSERT_EQ(profiler->sites().size(), 0U);
+}
@@ -16,6 +16,7 @@
 
 #include "marl/defer.h"
 #include "marl/scheduler.h"
+#include "marl/sequencer.h"
 #include "marl/thread.h"
 #include "marl/ticket.h"
 
@@ -37,3 +38,52 @@ BENCHMARK_DEFINE_F(Schedule, Ticket)(benchmark::State& state) {
   });
 }
 BENCHMARK_REGISTER_F(Schedule, Ticket)->Apply(Schedule::args<512>);
+
+BENCHMARK_DEFINE_F(Schedule, TicketTakeBatch)(benchmark::State& state) {
+  run(state, [&](int numTasks) {
+    for (auto _ : state) {
+      marl::Ticket::Queue queue;
+      queue.take(numTasks, [&](marl::Ticket&& ticket) {
+        marl::schedule([ticket] {
+          ticket.wait();
+          ticket.done();
+        });
+      });
+      queue.take().wait();
+    }
+  });
+}
+BENCHMARK_REGISTER_F(Schedule, TicketTakeBatch)->Apply(Schedule::args<512>);
+
+BENCHMARK_DEFINE_F(Schedule, Sequencer)(benchmark::State& state) {
+  run(state, [&](int numTasks) {
+    for (auto _ : state) {
+      marl::Sequencer sequencer;
+      for (int i = 0; i < numTasks; i++) {
+        auto ticket = sequencer.take();
+        marl::schedule([ticket] {
+          ticket.wait();
+          ticket.done();
+        });
+      }
+      sequencer.take().wait();
+    }
+  });
+}
+BENCHMARK_REGISTER_F(Schedule, Sequencer)->Apply(Schedule::args<512>);
+
+BENCHMARK_DEFINE_F(Schedule, SequencerTakeBatch)(benchmark::State& state) {
+  run(state, [&](int numTasks) {
+    for (auto _ : state) {
+      marl::Sequencer sequencer;
+      sequencer.take(numTasks, [&](marl::Sequencer::Ticket&& ticket) {
+        marl::schedule([ticket] {
+          ticket.wait();
+          ticket.done();
+        });
+      });
+      sequencer.take().wait();
+    }
+  });
+}
+BENCHMARK_REGISTER_F(Schedule, SequencerTakeBatch)->Apply(Schedule::args<512>);
@@ -20,227 +20,1100 @@
 
 #include "marl/trace.h"
 
-#include "marl/defer.h"
 #include "marl/scheduler.h"
 #include "marl/thread.h"
 
 #if MARL_TRACE_ENABLED
 
-#include <atomic>
-#include <fstream>
+#include <algorithm>
+#include <condition_variable>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+
+#if defined(_WIN32)
+#include <io.h>
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+#ifdef MARL_USE_PTHREAD_THREAD_LOCAL
+#include <pthread.h>
+#endif
 
 namespace {
 
 // Chrome traces can choke or error on very large trace files.
-// Limit the number of events created to this number.
+// Limit the number of events written to this number.
 static constexpr int MaxEvents = 100000;
 
+// The maximum length of a formatted thread name.
+static constexpr int MaxThreadNameLength = 64;
+static constexpr int MaxEventNameLength = 256;
+
+// The maximum number of distinct formatted event names. Once reached, events
+// with new formatted names are recorded with their unformatted format string
+// instead, so that dynamic names do not grow the name table without bound.
+static constexpr size_t MaxFormattedNames = 4096;
+
 uint64_t threadFiberID(uint32_t threadID, uint32_t fiberID) {
   return static_cast<uint64_t>(threadID) * 31 + static_cast<uint64_t>(fiberID);
 }
 
-}  // anonymous namespace
+// now() returns the current time in nanoseconds.
+uint64_t now() {
+  auto t = std::chrono::steady_clock::now().time_since_epoch();
+  return static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(t).count());
+}
 
-namespace marl {
+// openFile() opens the file at path for writing, returning the file
+// descriptor, or -1 on error.
+int openFile(const char* path) {
+#if defined(_WIN32)
+  return _open(path, _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY,
+               _S_IREAD | _S_IWRITE);
+#else
+  return open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+#endif
+}
 
-Trace* Trace::get() {
-  static Trace trace;
-  return &trace;
+// writeFile() writes up to size bytes to the file descriptor, returning the
+// number of bytes written, or a negative value on error.
+int64_t writeFile(int fd, const char* data, size_t size) {
+#if defined(_WIN32)
+  return _write(fd, data, static_cast<unsigned int>(size));
+#else
+  return write(fd, data, size);
+#endif
+}
+
+void closeFile(int fd) {
+#if defined(_WIN32)
+  _close(fd);
+#else
+  close(fd);
+#endif
+}
+
+uint64_t processID() {
+#if defined(_WIN32)
+  return static_cast<uint64_t>(_getpid());
+#else
+  return static_cast<uint64_t>(getpid());
+#endif
 }
 
-Trace::Trace() {
-  nameThread("main");
-  thread = std::thread([&] {
-    Thread::setName("Trace worker");
+size_t nextPowerOfTwo(size_t n) {
+  size_t p = 1;
+  while (p < n) {
+    p <<= 1;
+  }
+  return p;
+}
+
+// Output writes the trace to a file or file descriptor, buffering at most
+// OutputBufferSize bytes in memory.
+class Output {
+ public:
+  static constexpr size_t OutputBufferSize = 64 * 1024;
+
+  Output(const marl::Trace::Config& config) {
+    if (config.fd >= 0) {
+      fd = config.fd;
+    } else {
+      fd = openFile(config.path.c_str());
+      owned = true;
+    }
+    buffer.reserve(OutputBufferSize);
+  }
+
+  ~Output() {
+    flush();
+    if (owned && fd >= 0) {
+      closeFile(fd);
+    }
+  }
+
+  void write(const void* data, size_t size) {
+    if (buffer.size() + size > OutputBufferSize) {
+      flush();
+    }
+    auto bytes = reinterpret_cast<const char*>(data);
+    buffer.insert(buffer.end(), bytes, bytes + size);
+  }
+
+  void write(const std::string& str) { write(str.data(), str.size()); }
+
+ private:
+  void flush() {
+    size_t offset = 0;
+    while (fd >= 0 && offset < buffer.size()) {
+      auto n = writeFile(fd, buffer.data() + offset, buffer.size() - offset);
+      if (n <= 0) {
+        break;
+      }
+      offset += static_cast<size_t>(n);
+    }
+    buffer.clear();
+  }
+
+  int fd = -1;
+  bool owned = false;
+  std::vector<char> buffer;
+};
 
-    auto out = std::fstream("chrome.trace", std::ios_base::out);
+// TraceWriter is the interface to a trace file format.
+class TraceWriter {
+ public:
+  virtual ~TraceWriter() = default;
+
+  // track() is called before the first event of the given thread and fiber is
+  // written, and again if the thread or fiber is renamed. name may be
+  // nullptr.
+  virtual void track(uint32_t threadID,
+                     uint32_t fiberID,
+                     const char* name) = 0;
+
+  // write() writes the event emitted by the given thread.
+  virtual void write(uint32_t threadID,
+                     const marl::Trace::Event& event,
+                     const char* name) = 0;
+};
+
+// JSONWriter writes events in the Chrome JSON trace event format, one event
+// per line.
+class JSONWriter : public TraceWriter {
+ public:
+  JSONWriter(const marl::Trace::Config& config, uint64_t start)
+      : out(config), start(start) {
+    out.write("[");
+  }
 
-    out << "[" << std::endl;
-    defer(out << std::endl << "]" << std::endl);
+  ~JSONWriter() { out.write("\n]\n"); }
 
-    auto first = true;
-    for (int i = 0; i < MaxEvents; i++) {
-      auto event = take();
-      if (event->type() == Event::Type::Shutdown) {
+  void track(uint32_t threadID, uint32_t fiberID, const char* name) override {
+    if (name == nullptr) {
+      return;
+    }
+    line.clear();
+    separator();
+    line += "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 0, \"tid\": ";
+    line += std::to_string(threadFiberID(threadID, fiberID));
+    line += ", \"args\": {\"name\": \"";
+    line += name;
+    line += "\"}}";
+    out.write(line);
+  }
+
+  void write(uint32_t threadID,
+             const marl::Trace::Event& event,
+             const char* name) override {
+    using Type = marl::Trace::Event::Type;
+    if (count >= MaxEvents) {
+      return;
+    }
+    count++;
+
+    auto ts = event.timestamp > start ? event.timestamp - start : 0;
+    char timestamp[32];
+    snprintf(timestamp, sizeof(timestamp), "%llu.%03llu",
+             static_cast<unsigned long long>(ts / 1000),
+             static_cast<unsigned long long>(ts % 1000));
+
+    line.clear();
+    separator();
+    line += "{\"name\": \"";
+    line += name;
+    line += "\", \"ph\": \"";
+    line += static_cast<char>(event.type);
+    line += "\", \"pid\": 0, \"tid\": ";
+    line += std::to_string(threadFiberID(threadID, event.fiberID));
+    line += ", \"ts\": ";
+    line += timestamp;
+    switch (event.type) {
+      case Type::AsyncStart:
+      case Type::AsyncInstant:
+      case Type::AsyncEnd:
+        line += ", \"cat\": \"async\", \"id\": \"";
+        line += std::to_string(event.value);
+        line += "\"";
+        break;
+      case Type::FlowStart:
+      case Type::FlowStep:
+      case Type::FlowEnd:
+        line += ", \"cat\": \"flow\", \"id\": \"";
+        line += std::to_string(event.value);
+        line += event.type == Type::FlowEnd ? "\", \"bp\": \"e\"" : "\"";
+        break;
+      case Type::Counter:
+        line += ", \"args\": {\"";
+        line += name;
+        line += "\": ";
+        line += std::to_string(static_cast<int64_t>(event.value));
+        line += "}";
+        break;
+      case Type::Instant:
+        line += ", \"s\": \"t\"";
+        break;
+      default:
+        if (event.fiberID != 0) {
+          line += ", \"args\": {\"fiber\": ";
+          line += std::to_string(event.fiberID);
+          line += "}";
+        }
+        break;
+    }
+    line += "}";
+    out.write(line);
+  }
+
+ private:
+  void separator() {
+    line += first ? "\n" : ",\n";
+    first = false;
+  }
+
+  Output out;
+  const uint64_t start;
+  std::string line;
+  bool first = true;
+  int count = 0;
+};
+
+// Proto is a minimal protobuf message encoder.
+class Proto {
+ public:
+  inline void clear() { data.clear(); }
+  inline bool empty() const { return data.empty(); }
+  inline const std::string& bytes() const { return data; }
+
+  inline void varint(uint32_t field, uint64_t value) {
+    tag(field, 0);
+    raw(value);
+  }
+
+  inline void fixed64(uint32_t field, uint64_t value) {
+    tag(field, 1);
+    for (int i = 0; i < 8; i++) {
+      data += static_cast<char>((value >> (i * 8)) & 0xff);
+    }
+  }
+
+  inline void string(uint32_t field, const char* str) {
+    tag(field, 2);
+    auto len = strlen(str);
+    raw(len);
+    data.append(str, len);
+  }
+
+  inline void message(uint32_t field, const Proto& msg) {
+    tag(field, 2);
+    raw(msg.data.size());
+    data += msg.data;
+  }
+
+ private:
+  inline void tag(uint32_t field, uint32_t wireType) {
+    raw((static_cast<uint64_t>(field) << 3) | wireType);
+  }
+
+  inline void raw(uint64_t value) {
+    while (value >= 0x80) {
+      data += static_cast<char>((value & 0x7f) | 0x80);
+      value >>= 7;
+    }
+    data += static_cast<char>(value);
+  }
+
+  std::string data;
+};
+
+// PerfettoWriter writes events in the Perfetto protobuf trace format.
+// See https://perfetto.dev/docs/reference/trace-packet-proto
+//
+// Each thread has a track, and each fiber has a track nested under its
+// thread's track. Counters and async events each have a track per name (and
+// id) nested under the process track.
+class PerfettoWriter : public TraceWriter {
+ public:
+  PerfettoWriter(const marl::Trace::Config& config, uint64_t start)
+      : out(config), start(start) {
+    // The first packet clears the incremental (interned) state and describes
+    // the process track.
+    descriptor.clear();
+    descriptor.varint(kTrackUUID, kProcessUUID);
+    nested.clear();
+    nested.varint(kProcessPID, processID());
+    nested.string(kProcessName, "marl");
+    descriptor.message(kTrackProcess, nested);
+
+    packet.clear();
+    packet.varint(kPacketSequenceID, kSequenceID);
+    packet.varint(kPacketSequenceFlags, kSequenceIncrementalStateCleared);
+    packet.message(kPacketTrackDescriptor, descriptor);
+    emit();
+  }
+
+  void track(uint32_t threadID, uint32_t fiberID, const char* name) override {
+    char fallback[32];
+    descriptor.clear();
+    descriptor.varint(kTrackUUID, trackUUID(threadID, fiberID));
+    if (fiberID == 0) {
+      if (name == nullptr) {
+        snprintf(fallback, sizeof(fallback), "Thread<%u>", threadID);
+        name = fallback;
+      }
+      descriptor.varint(kTrackParentUUID, kProcessUUID);
+      nested.clear();
+      nested.varint(kThreadPID, processID());
+      nested.varint(kThreadTID, threadID);
+      nested.string(kThreadName, name);
+      descriptor.message(kTrackThread, nested);
+    } else {
+      if (name == nullptr) {
+        snprintf(fallback, sizeof(fallback), "Fiber<%u>", fiberID);
+        name = fallback;
+      }
+      descriptor.varint(kTrackParentUUID, trackUUID(threadID, 0));
+      descriptor.string(kTrackName, name);
+    }
+    packet.clear();
+    packet.varint(kPacketSequenceID, kSequenceID);
+    packet.message(kPacketTrackDescriptor, descriptor);
+    emit();
+  }
+
+  void write(uint32_t threadID,
+             const marl::Trace::Event& event,
+             const char* name) override {
+    using Type = marl::Trace::Event::Type;
+
+    uint64_t uuid = trackUUID(threadID, event.fiberID);
+    trackEvent.clear();
+    switch (event.type) {
+      case Type::Begin:
+        trackEvent.varint(kEventType, kSliceBegin);
+        break;
+      case Type::End:
+        trackEvent.varint(kEventType, kSliceEnd);
+        break;
+      case Type::Instant:
+        trackEvent.varint(kEventType, kInstant);
+        break;
+      case Type::Counter:
+        uuid = counterTrack(event.name, name);
+        trackEvent.varint(kEventType, kCounter);
+        trackEvent.varint(kEventCounterValue, event.value);
+        break;
+      case Type::AsyncStart:
+        uuid = asyncTrack(event.name, event.value, name);
+        trackEvent.varint(kEventType, kSliceBegin);
+        break;
+      case Type::AsyncEnd:
+        uuid = asyncTrack(event.name, event.value, name);
+        trackEvent.varint(kEventType, kSliceEnd);
+        break;
+      case Type::FlowStart:
+      case Type::FlowStep:
+        trackEvent.varint(kEventType, kInstant);
+        trackEvent.fixed64(kEventFlowIDs, event.value);
+        break;
+      case Type::FlowEnd:
+        trackEvent.varint(kEventType, kInstant);
+        trackEvent.fixed64(kEventTerminatingFlowIDs, event.value);
+        break;
+      default:
+        return;  // Not supported by this writer.
+    }
+    trackEvent.varint(kEventTrackUUID, uuid);
+
+    packet.clear();
+    if (event.type != Type::End && event.type != Type::AsyncEnd &&
+        event.type != Type::Counter) {
+      trackEvent.varint(kEventNameIID, event.name);
+      intern(event.name, name);
+    }
+    auto ts = event.timestamp > start ? event.timestamp - start : 0;
+    packet.varint(kPacketTimestamp, ts);
+    packet.varint(kPacketSequenceID, kSequenceID);
+    packet.varint(kPacketSequenceFlags, kSequenceNeedsIncrementalState);
+    packet.message(kPacketTrackEvent, trackEvent);
+    emit();
+  }
+
+ private:
+  // Field numbers of the perfetto.protos messages used.
+  enum : uint32_t {
+    kTracePacket = 1,                 // Trace.packet
+    kPacketTimestamp = 8,             // TracePacket.timestamp
+    kPacketSequenceID = 10,           // TracePacket.trusted_packet_sequence_id
+    kPacketTrackEvent = 11,           // TracePacket.track_event
+    kPacketInternedData = 12,         // TracePacket.interned_data
+    kPacketSequenceFlags = 13,        // TracePacket.sequence_flags
+    kPacketTrackDescriptor = 60,      // TracePacket.track_descriptor
+    kTrackUUID = 1,                   // TrackDescriptor.uuid
+    kTrackName = 2,                   // TrackDescriptor.name
+    kTrackProcess = 3,                // TrackDescriptor.process
+    kTrackThread = 4,                 // TrackDescriptor.thread
+    kTrackParentUUID = 5,             // TrackDescriptor.parent_uuid
+    kTrackCounter = 8,                // TrackDescriptor.counter
+    kProcessPID = 1,                  // ProcessDescriptor.pid
+    kProcessName = 6,                 // ProcessDescriptor.process_name
+    kThreadPID = 1,                   // ThreadDescriptor.pid
+    kThreadTID = 2,                   // ThreadDescriptor.tid
+    kThreadName = 5,                  // ThreadDescriptor.thread_name
+    kEventType = 9,                   // TrackEvent.type
+    kEventNameIID = 10,               // TrackEvent.name_iid
+    kEventTrackUUID = 11,             // TrackEvent.track_uuid
+    kEventCounterValue = 30,          // TrackEvent.counter_value
+    kEventFlowIDs = 47,               // TrackEvent.flow_ids
+    kEventTerminatingFlowIDs = 48,    // TrackEvent.terminating_flow_ids
+    kInternedEventNames = 2,          // InternedData.event_names
+    kEventNameIIDField = 1,           // EventName.iid
+    kEventNameName = 2,               // EventName.name
+  };
+
+  // TrackEvent.Type values.
+  enum : uint64_t {
+    kSliceBegin = 1,
+    kSliceEnd = 2,
+    kInstant = 3,
+    kCounter = 4,
+  };
+
+  // TracePacket.SequenceFlags values.
+  enum : uint64_t {
+    kSequenceIncrementalStateCleared = 1,
+    kSequenceNeedsIncrementalState = 2,
+  };
+
+  static constexpr uint32_t kSequenceID = 1;
+  static constexpr uint64_t kProcessUUID = 1;
+  static constexpr uint64_t kCounterTrackBit = 1ULL << 63;
+  static constexpr uint64_t kAsyncTrackBit = 1ULL << 62;
+
+  // trackUUID() returns the track identifier of the thread and fiber.
+  static uint64_t trackUUID(uint32_t threadID, uint32_t fiberID) {
+    return (static_cast<uint64_t>(threadID) << 32) | fiberID;
+  }
+
+  // counterTrack() returns the track of the named counter, describing it
+  // if it is new.
+  uint64_t counterTrack(marl::Trace::Name id, const char* name) {
+    auto uuid = kCounterTrackBit | id;
+    if (tracks.emplace(uuid).second) {
+      descriptor.clear();
+      descriptor.varint(kTrackUUID, uuid);
+      descriptor.varint(kTrackParentUUID, kProcessUUID);
+      descriptor.string(kTrackName, name);
+      nested.clear();
+      descriptor.message(kTrackCounter, nested);
+      packet.clear();
+      packet.varint(kPacketSequenceID, kSequenceID);
+      packet.message(kPacketTrackDescriptor, descriptor);
+      emit();
+    }
+    return uuid;
+  }
+
+  // asyncTrack() returns the track of the async event with the given name
+  // and id, describing it if it is new.
+  uint64_t asyncTrack(marl::Trace::Name id, uint64_t value, const char* name) {
+    auto hash = (static_cast<uint64_t>(id) << 40) ^ value;
+    auto uuid = kAsyncTrackBit | (hash & (kAsyncTrackBit - 1));
+    if (tracks.emplace(uuid).second) {
+      descriptor.clear();
+      descriptor.varint(kTrackUUID, uuid);
+      descriptor.varint(kTrackParentUUID, kProcessUUID);
+      descriptor.string(kTrackName, name);
+      packet.clear();
+      packet.varint(kPacketSequenceID, kSequenceID);
+      packet.message(kPacketTrackDescriptor, descriptor);
+      emit();
+    }
+    return uuid;
+  }
+
+  // intern() adds the event name to the packet's interned data if it has not
+  // been emitted before. Must be called before the packet's other fields are
+  // written.
+  void intern(marl::Trace::Name id, const char* name) {
+    if (id < interned.size() && interned[id]) {
+      return;
+    }
+    if (id >= interned.size()) {
+      interned.resize(id + 1);
+    }
+    interned[id] = true;
+    nested.clear();
+    nested.varint(kEventNameIIDField, id);
+    nested.string(kEventNameName, name);
+    internedData.clear();
+    internedData.message(kInternedEventNames, nested);
+    packet.message(kPacketInternedData, internedData);
+  }
+
+  // emit() writes the packet to the output.
+  void emit() {
+    header.clear();
+    header.message(kTracePacket, packet);
+    out.write(header.bytes());
+  }
+
+  Output out;
+  const uint64_t start;
+  std::unordered_set<uint64_t> tracks;
+  std::vector<bool> interned;
+
+  // Scratch messages, reused to avoid allocations.
+  Proto packet;
+  Proto trackEvent;
+  Proto descriptor;
+  Proto internedData;
+  Proto nested;
+  Proto header;
+};
+
+}  // anonymous namespace
+
+namespace marl {
+
+////////////////////////////////////////////////////////////////////////////////
+// Trace::Buffer
+////////////////////////////////////////////////////////////////////////////////
+
+// Buffer is a single-producer, single-consumer ring buffer of events.
+// Events are pushed by the thread that owns the buffer, and are drained by the
+// trace writer thread. If the buffer is full, events are dropped.
+class Trace::Buffer {
+ public:
+  Buffer(size_t capacity)
+      : mask(nextPowerOfTwo(capacity) - 1), events(new Event[mask + 1]) {}
+
+  // push() appends the event to the buffer. Must only be called by the
+  // owning thread.
+  inline void push(const Event& event) {
+    auto h = head.load(std::memory_order_relaxed);
+    if (h - cachedTail > mask) {
+      // Only read the consumer's tail when the buffer appears full, to avoid
+      // bouncing its cache line between threads.
+      cachedTail = tail.load(std::memory_order_acquire);
+      if (h - cachedTail > mask) {
+        dropped.fetch_add(1, std::memory_order_relaxed);
         return;
       }
-      if (!first) {
-        out << "," << std::endl;
-      };
-      first = false;
-      out << "{" << std::endl;
-      event->write(out);
-      out << "}";
     }
+    events[h & mask] = event;
+    head.store(h + 1, std::memory_order_release);
+  }
+
+  // drain() calls f with each of the events pushed to the buffer since the
+  // last call to drain() or discard(). Must only be called by the consumer.
+  template <typename F>
+  inline void drain(F&& f) {
+    auto t = tail.load(std::memory_order_relaxed);
+    auto h = head.load(std::memory_order_acquire);
+    for (; t != h; t++) {
+      f(events[t & mask]);
+    }
+    tail.store(t, std::memory_order_release);
+  }
+
+  // discard() drops all the events in the buffer. Must only be called by the
+  // consumer.
+  inline void discard() {
+    tail.store(head.load(std::memory_order_acquire),
+               std::memory_order_release);
+  }
+
+  // reset() drops all the events in the buffer, and prepares it for a new
+  // owning thread.
+  inline void reset() {
+    discard();
+    cachedTail = tail.load(std::memory_order_relaxed);
+    orphaned.store(false, std::memory_order_relaxed);
+    dropped.store(0, std::memory_order_relaxed);
+    sampleCounter = 0;
+    flowCounter = 0;
+  }
+
+  // The owning thread, and the sequential identifier used for its track.
+  std::thread::id owner;
+  uint32_t threadID = 0;
 
-    stopped = true;
+  // Set when the owning thread exits.
+  std::atomic<bool> orphaned = {false};
 
-    while (take()->type() != Event::Type::Shutdown) {
+  // The number of events dropped because the buffer was full.
+  std::atomic<uint64_t> dropped = {0};
+
+  // Counter used to sample scoped events. Only used by the owning thread.
+  uint32_t sampleCounter = 0;
+
+  // Counter used to allocate flow identifiers. Only used by the owning
+  // thread.
+  uint64_t flowCounter = 0;
+
+ private:
+  const uint64_t mask;
+  const std::unique_ptr<Event[]> events;
+  std::atomic<uint64_t> head = {0};  // Written by the owning thread.
+  std::atomic<uint64_t> tail = {0};  // Written by the trace writer thread.
+  uint64_t cachedTail = 0;           // Last tail seen by the owning thread.
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Trace::Impl
+////////////////////////////////////////////////////////////////////////////////
+class Trace::Impl {
+ public:
+  Impl();
+  ~Impl();
+
+  void enable(const Config& config);
+  void disable();
+  Name intern(const char* name);
+
+  // internFormatted() returns the Name for name, formatted from fmt. If the
+  // table of formatted names is full, the Name for fmt is returned instead.
+  Name internFormatted(const char* name, const char* fmt);
+
+  void nameThread(const char* name);
+
+  // buffer() returns the calling thread's event buffer.
+  inline Buffer* buffer();
+
+  // The sample rate of scoped events, copied from the config.
+  std::atomic<uint32_t> sampleRate = {1};
+
+ private:
+  // acquire() returns a new or recycled buffer for the calling thread.
+  Buffer* acquire();
+
+  // run() is the body of the trace writer thread.
+  void run(Config config, uint64_t start);
+
+  // drain() writes all the buffered events with the writer. The lock on
+  // mutex is released while the events are written.
+  void drain(TraceWriter* writer, std::unique_lock<std::mutex>& lock);
+
+  // internLocked() returns the Name for name, registering it if it has not
+  // been seen before. Must be called with namesMutex locked.
+  Name internLocked(const char* name, bool formatted);
+
+  // nameOf() returns the string of the interned name. Must only be called by
+  // the writer thread.
+  const char* nameOf(Name name);
+
+  // stopWriter() stops and joins the trace writer thread, if running.
+  void stopWriter();
+
+  // Serializes calls to enable() and disable().
+  std::mutex controlMutex;
+
+  std::mutex mutex;
+  std::condition_variable cv;
+  bool stop = false;
+  bool namesChanged = false;
+  std::map<std::pair<std::thread::id, uint32_t>, Name> threadNames;
+
+  // The interned names, guarded by namesMutex. Strings in the deque are
+  // never moved, so the writer can hold on to their c_str() pointers.
+  std::mutex namesMutex;
+  std::deque<std::string> names;
+  std::unordered_map<std::string, Name> nameIDs;
+  size_t numFormattedNames = 0;
+  std::vector<std::unique_ptr<Buffer>> buffers;
+  std::vector<Buffer*> active;
+  std::vector<Buffer*> freeBuffers;
+  size_t bufferSize = Config().bufferSize;
+  uint32_t nextThreadID = 1;
+
+  // The writer thread, and the tracks it has described.
+  std::thread thread;
+  std::unordered_set<uint64_t> describedTracks;
+  // The strings of the names seen by the writer, indexed by Name.
+  std::vector<const char*> writerNames;
+
+#ifdef MARL_USE_PTHREAD_THREAD_LOCAL
+  pthread_key_t key;
+#else
+  // ThreadBuffer holds the calling thread's buffer, and releases it when the
+  // thread exits.
+  struct ThreadBuffer {
+    ~ThreadBuffer() {
+      if (buffer != nullptr) {
+        buffer->orphaned.store(true, std::memory_order_release);
+      }
     }
+    Buffer* buffer = nullptr;
+  };
+  static thread_local ThreadBuffer threadBuffer;
+#endif
+};
+
+#ifndef MARL_USE_PTHREAD_THREAD_LOCAL
+thread_local Trace::Impl::ThreadBuffer Trace::Impl::threadBuffer;
+#endif
+
+Trace::Impl::Impl() {
+  names.emplace_back("");  // Name 0 is reserved.
+#ifdef MARL_USE_PTHREAD_THREAD_LOCAL
+  pthread_key_create(&key, [](void* buffer) {
+    static_cast<Buffer*>(buffer)->orphaned.store(true,
+                                                 std::memory_order_release);
   });
+#endif
 }
 
-Trace::~Trace() {
-  put(new Shutdown());
-  thread.join();
+Trace::Impl::~Impl() {
+  disable();
+#ifdef MARL_USE_PTHREAD_THREAD_LOCAL
+  pthread_key_delete(key);
+#endif
 }
 
-void Trace::nameThread(const char* fmt, ...) {
-  if (stopped) {
-    return;
+Trace::Buffer* Trace::Impl::buffer() {
+#ifdef MARL_USE_PTHREAD_THREAD_LOCAL
+  auto buffer = static_cast<Buffer*>(pthread_getspecific(key));
+  if (buffer == nullptr) {
+    buffer = acquire();
+    pthread_setspecific(key, buffer);
+  }
+  return buffer;
+#else
+  auto& tb = threadBuffer;
+  if (tb.buffer == nullptr) {
+    tb.buffer = acquire();
+  }
+  return tb.buffer;
+#endif
+}
+
+Trace::Buffer* Trace::Impl::acquire() {
+  std::unique_lock<std::mutex> lock(mutex);
+  Buffer* buffer = nullptr;
+  if (!freeBuffers.empty()) {
+    buffer = freeBuffers.back();
+    freeBuffers.pop_back();
+    buffer->reset();
+  } else {
+    buffers.emplace_back(new Buffer(bufferSize));
+    buffer = buffers.back().get();
   }
-  auto event = new NameThreadEvent();
+  buffer->owner = std::this_thread::get_id();
+  buffer->threadID = nextThreadID++;
+  active.push_back(buffer);
+  return buffer;
+}
 
-  va_list vararg;
-  va_start(vararg, fmt);
-  vsnprintf(event->name, Trace::MaxEventNameLength, fmt, vararg);
-  va_end(vararg);
+void Trace::Impl::enable(const Config& config) {
+  std::unique_lock<std::mutex> control(controlMutex);
+  stopWriter();
 
-  put(event);
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    // Discard any events recorded since the last disable(), and recycle the
+    // buffers of threads that have since exited.
+    for (auto it = active.begin(); it != active.end();) {
+      auto buffer = *it;
+      buffer->discard();
+      if (buffer->orphaned.load(std::memory_order_acquire)) {
+        freeBuffers.push_back(buffer);
+        it = active.erase(it);
+      } else {
+        ++it;
+      }
+    }
+    if (bufferSize != config.bufferSize) {
+      // Release the recycled buffers of the old size.
+      for (auto buffer : freeBuffers) {
+        for (auto it = buffers.begin(); it != buffers.end(); ++it) {
+          if (it->get() == buffer) {
+            buffers.erase(it);
+            break;
+          }
+        }
+      }
+      freeBuffers.clear();
+      bufferSize = config.bufferSize;
+    }
+    describedTracks.clear();
+    stop = false;
+  }
+
+  sampleRate = std::max<uint32_t>(config.sampleRate, 1);
+  auto start = now();
+  thread = std::thread([this, config, start] { run(config, start); });
+  Trace::enabled.store(true, std::memory_order_release);
 }
 
-void Trace::beginEvent(const char* fmt, ...) {
-  if (stopped) {
+void Trace::Impl::disable() {
+  std::unique_lock<std::mutex> control(controlMutex);
+  stopWriter();
+}
+
+void Trace::Impl::stopWriter() {
+  if (!thread.joinable()) {
     return;
   }
-  auto event = new BeginEvent();
+  Trace::enabled.store(false, std::memory_order_release);
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    stop = true;
+  }
+  cv.notify_all();
+  thread.join();
+}
 
-  va_list vararg;
-  va_start(vararg, fmt);
-  vsnprintf(event->name, Trace::MaxEventNameLength, fmt, vararg);
-  va_end(vararg);
+Trace::Name Trace::Impl::intern(const char* name) {
+  std::unique_lock<std::mutex> lock(namesMutex);
+  return internLocked(name, false);
+}
 
-  event->timestamp = timestamp();
-  put(event);
+Trace::Name Trace::Impl::internFormatted(const char* name, const char* fmt) {
+  std::unique_lock<std::mutex> lock(namesMutex);
+  if (numFormattedNames >= MaxFormattedNames) {
+    auto it = nameIDs.find(name);
+    return it != nameIDs.end() ? it->second : internLocked(fmt, false);
+  }
+  return internLocked(name, true);
 }
 
-void Trace::endEvent() {
-  if (stopped) {
-    return;
+Trace::Name Trace::Impl::internLocked(const char* name, bool formatted) {
+  auto it = nameIDs.find(name);
+  if (it != nameIDs.end()) {
+    return it->second;
+  }
+  auto id = static_cast<Name>(names.size());
+  names.emplace_back(name);
+  nameIDs.emplace(names.back(), id);
+  if (formatted) {
+    numFormattedNames++;
   }
-  auto event = new EndEvent();
-  event->timestamp = timestamp();
-  put(event);
+  return id;
 }
 
-void Trace::beginAsyncEvent(uint32_t id, const char* fmt, ...) {
-  if (stopped) {
-    return;
+const char* Trace::Impl::nameOf(Name name) {
+  if (name >= writerNames.size()) {
+    std::unique_lock<std::mutex> lock(namesMutex);
+    for (size_t i = writerNames.size(); i < names.size(); i++) {
+      writerNames.push_back(names[i].c_str());
+    }
   }
-  auto event = new AsyncStartEvent();
+  return writerNames[name];
+}
 
-  va_list vararg;
-  va_start(vararg, fmt);
-  vsnprintf(event->name, Trace::MaxEventNameLength, fmt, vararg);
-  va_end(vararg);
+void Trace::Impl::nameThread(const char* name) {
+  uint32_t fiberID = 0;
+  if (auto fiber = Scheduler::Fiber::current()) {
+    fiberID = fiber->id;
+  }
+  auto id = intern(name);
+  std::unique_lock<std::mutex> lock(mutex);
+  threadNames[std::make_pair(std::this_thread::get_id(), fiberID)] = id;
+  namesChanged = true;
+}
+
+void Trace::Impl::run(Config config, uint64_t start) {
+  Thread::setName("Trace worker");
+
+  std::unique_ptr<TraceWriter> writer;
+  switch (config.format) {
+    case Config::Format::JSON:
+      writer.reset(new JSONWriter(config, start));
+      break;
+    case Config::Format::Perfetto:
+      writer.reset(new PerfettoWriter(config, start));
+      break;
+  }
 
-  event->timestamp = timestamp();
-  event->id = id;
-  put(event);
+  std::unique_lock<std::mutex> lock(mutex);
+  while (true) {
+    cv.wait_for(lock, config.flushInterval, [this] { return stop; });
+    drain(writer.get(), lock);
+    if (stop) {
+      return;
+    }
+  }
 }
 
-void Trace::endAsyncEvent(uint32_t id, const char* fmt, ...) {
-  if (stopped) {
-    return;
+void Trace::Impl::drain(TraceWriter* writer,
+                        std::unique_lock<std::mutex>& lock) {
+  if (namesChanged) {
+    // Re-describe the tracks as they are next seen.
+    namesChanged = false;
+    describedTracks.clear();
+  }
+  // Buffers are only destructed by enable() while the writer is stopped, and
+  // only this thread consumes their events, so they can be drained without
+  // the lock. The orphaned flags are read first, so that an orphaned buffer
+  // is known to hold all of its owner's events once drained.
+  std::vector<std::pair<Buffer*, bool>> toDrain;
+  toDrain.reserve(active.size());
+  for (auto buffer : active) {
+    toDrain.emplace_back(buffer,
+                         buffer->orphaned.load(std::memory_order_acquire));
   }
-  auto event = new AsyncEndEvent();
 
+  std::vector<Buffer*> drained;
+  for (auto& it : toDrain) {
+    auto buffer = it.first;
+    auto describe = [&](uint32_t fiberID) {
+      auto track = (static_cast<uint64_t>(buffer->threadID) << 32) | fiberID;
+      if (describedTracks.emplace(track).second) {
+        lock.lock();
+        auto name = threadNames.find(std::make_pair(buffer->owner, fiberID));
+        auto id = name != threadNames.end() ? name->second : Name(0);
+        lock.unlock();
+        writer->track(buffer->threadID, fiberID,
+                      id != 0 ? nameOf(id) : nullptr);
+      }
+    };
+    lock.unlock();
+    buffer->drain([&](const Event& event) {
+      if (event.fiberID != 0) {
+        describe(0);  // Fiber tracks are nested under the thread's track.
+      }
+      describe(event.fiberID);
+      writer->write(buffer->threadID, event, nameOf(event.name));
+    });
+    lock.lock();
+    if (it.second) {
+      // The owning thread has exited, and all its events have been written.
+      drained.push_back(buffer);
+    }
+  }
+
+  for (auto buffer : drained) {
+    active.erase(std::find(active.begin(), active.end(), buffer));
+    freeBuffers.push_back(buffer);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Trace
+////////////////////////////////////////////////////////////////////////////////
+std::atomic<bool> Trace::enabled = {false};
+
+Trace* Trace::singleton() {
+  static Trace trace;
+  return &trace;
+}
+
+Trace::Trace() : impl(new Impl()) {}
+
+Trace::~Trace() {
+  delete impl;
+}
+
+void Trace::enable() {
+  enable(Config{});
+}
+
+void Trace::enable(const Config& config) {
+  singleton()->impl->enable(config);
+}
+
+void Trace::disable() {
+  singleton()->impl->disable();
+}
+
+Trace::Name Trace::intern(const char* name) {
+  return singleton()->impl->intern(name);
+}
+
+Trace::Name Trace::internFormatted(const char* fmt, ...) {
+  char name[MaxEventNameLength];
   va_list vararg;
   va_start(vararg, fmt);
-  vsnprintf(event->name, Trace::MaxEventNameLength, fmt, vararg);
+  vsnprintf(name, sizeof(name), fmt, vararg);
   va_end(vararg);
+  return singleton()->impl->internFormatted(name, fmt);
+}
 
-  event->timestamp = timestamp();
-  event->id = id;
-  put(event);
+void Trace::nameThread(const char* fmt, ...) {
+  char name[MaxThreadNameLength];
+  va_list vararg;
+  va_start(vararg, fmt);
+  vsnprintf(name, sizeof(name), fmt, vararg);
+  va_end(vararg);
+  singleton()->impl->nameThread(name);
 }
 
-uint64_t Trace::timestamp() {
-  auto now = std::chrono::high_resolution_clock::now();
-  auto diff =
-      std::chrono::duration_cast<std::chrono::microseconds>(now - createdAt);
-  return static_cast<uint64_t>(diff.count());
+void Trace::record(Event::Type type, Name name, uint64_t value) {
+  Event event;
+  event.timestamp = now();
+  event.value = value;
+  event.name = name;
+  event.fiberID = 0;
+  event.type = type;
+  if (auto fiber = Scheduler::Fiber::current()) {
+    event.fiberID = fiber->id;
+  }
+  impl->buffer()->push(event);
 }
 
-void Trace::put(Event* event) {
-  auto idx = eventQueueWriteIdx++ % eventQueues.size();
-  auto& queue = eventQueues[idx];
-  std::unique_lock<std::mutex> lock(queue.mutex);
-  auto notify = queue.data.size() == 0;
-  queue.data.push(std::unique_ptr<Event>(event));
-  lock.unlock();
-  if (notify) {
-    queue.condition.notify_one();
+bool Trace::beginEvent(Name name) {
+  auto rate = impl->sampleRate.load(std::memory_order_relaxed);
+  if (rate > 1 && (impl->buffer()->sampleCounter++ % rate) != 0) {
+    return false;
   }
+  record(Event::Type::Begin, name, 0);
+  return true;
 }
 
-std::unique_ptr<Trace::Event> Trace::take() {
-  auto idx = eventQueueReadIdx++ % eventQueues.size();
-  auto& queue = eventQueues[idx];
-  std::unique_lock<std::mutex> lock(queue.mutex);
-  queue.condition.wait(lock, [&queue] { return queue.data.size() > 0; });
-  auto event = std::move(queue.data.front());
-  queue.data.pop();
-  return event;
+void Trace::endEvent(Name name) {
+  record(Event::Type::End, name, 0);
 }
 
-#define QUOTE(x) "\"" << x << "\""
-#define INDENT "  "
+void Trace::beginAsyncEvent(uint64_t id, Name name) {
+  record(Event::Type::AsyncStart, name, id);
+}
 
-Trace::Event::Event()
-    : threadID(std::hash<std::thread::id>()(std::this_thread::get_id())) {
-  if (auto fiber = Scheduler::Fiber::current()) {
-    fiberID = fiber->id;
-  }
+void Trace::endAsyncEvent(uint64_t id, Name name) {
+  record(Event::Type::AsyncEnd, name, id);
 }
 
-void Trace::Event::write(std::ostream& out) const {
-  out << INDENT << QUOTE("name") << ": " << QUOTE(name) << "," << std::endl;
-  if (categories != nullptr) {
-    out << INDENT << QUOTE("cat") << ": "
-        << "\"";
-    auto first = true;
-    for (auto category = *categories; category != nullptr; category++) {
-      if (!first) {
-        out << ",";
-      }
-      out << category;
-    }
-    out << "\"," << std::endl;
-  }
-  if (fiberID != 0) {
-    out << INDENT << QUOTE("args") << ": "
-        << "{" << std::endl
-        << INDENT << INDENT << QUOTE("fiber") << ": " << fiberID << std::endl
-        << INDENT << "}," << std::endl;
-  }
-  if (threadID != 0) {
-    out << INDENT << QUOTE("tid") << ": " << threadFiberID(threadID, fiberID)
-        << "," << std::endl;
-  }
-  out << INDENT << QUOTE("ph") << ": " << QUOTE(static_cast<char>(type()))
-      << "," << std::endl
-      << INDENT << QUOTE("pid") << ": " << processID << "," << std::endl
-      << INDENT << QUOTE("ts") << ": " << timestamp << std::endl;
+void Trace::instantEvent(Name name) {
+  record(Event::Type::Instant, name, 0);
+}
+
+void Trace::counterEvent(Name name, int64_t value) {
+  record(Event::Type::Counter, name, static_cast<uint64_t>(value));
+}
+
+uint64_t Trace::beginFlow(Name name) {
+  // Flow identifiers are unique across threads without any synchronization
+  // by combining the thread's identifier with a per-thread counter.
+  auto buffer = impl->buffer();
+  auto id = (static_cast<uint64_t>(buffer->threadID) << 40) |
+            (++buffer->flowCounter & ((1ULL << 40) - 1));
+  record(Event::Type::FlowStart, name, id);
+  return id;
 }
 
-void Trace::NameThreadEvent::write(std::ostream& out) const {
-  out << INDENT << QUOTE("name") << ": " << QUOTE("thread_name") << ","
-      << std::endl
-      << INDENT << QUOTE("ph") << ": " << QUOTE("M") << "," << std::endl
-      << INDENT << QUOTE("pid") << ": " << processID << "," << std::endl
-      << INDENT << QUOTE("tid") << ": " << threadFiberID(threadID, fiberID)
-      << "," << std::endl
-      << INDENT << QUOTE("args") << ": {" << QUOTE("name") << ": "
-      << QUOTE(name) << "}" << std::endl;
+void Trace::stepFlow(uint64_t id, Name name) {
+  record(Event::Type::FlowStep, name, id);
 }
 
-void Trace::AsyncEvent::write(std::ostream& out) const {
-  out << INDENT << QUOTE("id") << ": " << QUOTE(id) << "," << std::endl
-      << INDENT << QUOTE("cat") << ": " << QUOTE("async") << "," << std::endl;
-  Event::write(out);
+void Trace::endFlow(uint64_t id, Name name) {
+  record(Event::Type::FlowEnd, name, id);
 }
 
 }  // namespace marl
 
-#endif  // MARL_TRACE_ENABLED
\ No newline at end of file
+#endif  // MARL_TRACE_ENABLED
@@ -0,0 +1,48 @@
+// Copyright 2026 The Marl Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "marl/trace.h"
+
+#include "benchmark/benchmark.h"
+
+#include <cstdio>
+
+#if MARL_TRACE_ENABLED
+
+volatile int do_not_optimize_away_trace = 0;
+
+static void TraceScopedEventDisabled(benchmark::State& state) {
+  for (auto _ : state) {
+    MARL_SCOPED_EVENT("Disabled");
+    do_not_optimize_away_trace++;
+  }
+}
+BENCHMARK(TraceScopedEventDisabled);
+
+static void TraceScopedEvent(benchmark::State& state) {
+  const char* path = "marl_trace_bench.json";
+  marl::Trace::Config config;
+  config.path = path;
+  config.sampleRate = static_cast<uint32_t>(state.range(0));
+  marl::Trace::enable(config);
+  for (auto _ : state) {
+    MARL_SCOPED_EVENT("Enabled");
+    do_not_optimize_away_trace++;
+  }
+  marl::Trace::disable();
+  std::remove(path);
+}
+BENCHMARK(TraceScopedEvent)->Arg(1)->Arg(16);
+
+#endif  // MARL_TRACE_ENABLED
@@ -0,0 +1,361 @@
+// Copyright 2026 The Marl Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "marl/trace.h"
+
+#include "marl_test.h"
+
+#include "marl/event.h"
+#include "marl/waitgroup.h"
+
+#if MARL_TRACE_ENABLED
+
+#include <cstdio>
+#include <fstream>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// readTrace() returns the content of the trace file at path, and deletes the
+// file.
+std::string readTrace(const char* path) {
+  std::stringstream ss;
+  ss << std::ifstream(path).rdbuf();
+  std::remove(path);
+  return ss.str();
+}
+
+// count() returns the number of occurrences of substr in str.
+int count(const std::string& str, const std::string& substr) {
+  int n = 0;
+  for (auto pos = str.find(substr); pos != std::string::npos;
+       pos = str.find(substr, pos + 1)) {
+    n++;
+  }
+  return n;
+}
+
+// flowIDs() returns the identifiers of the flow events with the given phase
+// and name.
+std::multiset<std::string> flowIDs(const std::string& trace,
+                                   const char* phase,
+                                   const char* name) {
+  std::multiset<std::string> ids;
+  std::stringstream ss(trace);
+  std::string line;
+  auto match = std::string("\"name\": \"") + name + "\", \"ph\": \"" + phase;
+  while (std::getline(ss, line)) {
+    if (line.find(match) != std::string::npos) {
+      auto start = line.find("\"id\": \"") + 7;
+      ids.emplace(line.substr(start, line.find('"', start) - start));
+    }
+  }
+  return ids;
+}
+
+}  // anonymous namespace
+
+TEST_F(WithoutBoundScheduler, TraceDisabled) {
+  ASSERT_FALSE(marl::Trace::isEnabled());
+  ASSERT_EQ(marl::Trace::get(), nullptr);
+  MARL_SCOPED_EVENT("NotRecorded");
+  MARL_INSTANT_EVENT("NotRecorded");
+}
+
+TEST_F(WithoutBoundScheduler, TraceIntern) {
+  auto a = marl::Trace::intern("TraceInternA");
+  auto b = marl::Trace::intern("TraceInternB");
+  ASSERT_NE(a, 0U);
+  ASSERT_NE(a, b);
+  ASSERT_EQ(marl::Trace::intern("TraceInternA"), a);
+}
+
+TEST_P(WithBoundScheduler, TraceEvents) {
+  const char* path = "marl_trace_events_test.json";
+  marl::Trace::Config config;
+  config.path = path;
+  marl::Trace::enable(config);
+  ASSERT_TRUE(marl::Trace::isEnabled());
+
+  constexpr int numTasks = 10;
+  marl::WaitGroup wg(numTasks);
+  for (int i = 0; i < numTasks; i++) {
+    marl::schedule([=] {
+      {
+        MARL_SCOPED_EVENT("TraceTask");
+        MARL_SCOPED_ASYNC_EVENT(i, "TraceAsync");
+        MARL_INSTANT_EVENT("TraceInstant");
+        MARL_COUNTER_EVENT("TraceCounter", i);
+      }
+      wg.done();
+    });
+  }
+  wg.wait();
+
+  marl::Trace::disable();
+  ASSERT_FALSE(marl::Trace::isEnabled());
+
+  auto trace = readTrace(path);
+  ASSERT_EQ(trace.front(), '[');
+  ASSERT_EQ(count(trace, "\"TraceTask\""), 2 * numTasks);
+  ASSERT_EQ(count(trace, "\"TraceAsync\""), 2 * numTasks);
+  ASSERT_EQ(count(trace, "\"TraceInstant\""), numTasks);
+  ASSERT_EQ(count(trace, "\"name\": \"TraceCounter\""), numTasks);
+}
+
+TEST_F(WithoutBoundScheduler, TraceThreadName) {
+  const char* path = "marl_trace_thread_name_test.json";
+  marl::Trace::Config config;
+  config.path = path;
+  marl::Trace::enable(config);
+  MARL_NAME_THREAD("TraceThread<%d>", 42);
+  MARL_INSTANT_EVENT("TraceNamed");
+  marl::Trace::disable();
+
+  auto trace = readTrace(path);
+  ASSERT_EQ(count(trace, "\"TraceThread<42>\""), 1);
+  ASSERT_EQ(count(trace, "\"TraceNamed\""), 1);
+}
+
+TEST_F(WithoutBoundScheduler, TraceFormattedNames) {
+  const char* path = "marl_trace_formatted_names_test.json";
+  marl::Trace::Config config;
+  config.path = path;
+  marl::Trace::enable(config);
+  for (int i = 0; i < 3; i++) {
+    MARL_SCOPED_EVENT("TraceScoped<%d>", i);
+    MARL_INSTANT_EVENT("TraceInstant<%s>", i == 1 ? "one" : "other");
+  }
+  marl::Trace::disable();
+
+  auto trace = readTrace(path);
+  ASSERT_EQ(count(trace, "\"TraceScoped<0>\""), 2);
+  ASSERT_EQ(count(trace, "\"TraceScoped<1>\""), 2);
+  ASSERT_EQ(count(trace, "\"TraceScoped<2>\""), 2);
+  ASSERT_EQ(count(trace, "\"TraceInstant<one>\""), 1);
+  ASSERT_EQ(count(trace, "\"TraceInstant<other>\""), 2);
+}
+
+TEST_F(WithoutBoundScheduler, TraceSampling) {
+  const char* path = "marl_trace_sampling_test.json";
+  marl::Trace::Config config;
+  config.path = path;
+  config.sampleRate = 4;
+  marl::Trace::enable(config);
+  for (int i = 0; i < 100; i++) {
+    MARL_SCOPED_EVENT("TraceSampled");
+  }
+  marl::Trace::disable();
+
+  auto trace = readTrace(path);
+  ASSERT_EQ(count(trace, "\"TraceSampled\""), 2 * 100 / 4);
+}
+
+TEST_F(WithoutBoundScheduler, TraceBufferOverflow) {
+  const char* path = "marl_trace_overflow_test.json";
+  marl::Trace::Config config;
+  config.path = path;
+  config.bufferSize = 16;
+  config.flushInterval = std::chrono::milliseconds(10000);
+  marl::Trace::enable(config);
+  std::thread([] {
+    for (int i = 0; i < 100; i++) {
+      MARL_INSTANT_EVENT("TraceOverflow");
+    }
+  }).join();
+  marl::Trace::disable();
+
+  // Events are dropped, not overwritten, when the buffer is full.
+  auto trace = readTrace(path);
+  ASSERT_EQ(count(trace, "\"TraceOverflow\""), 16);
+}
+
+TEST_F(WithoutBoundScheduler, TraceEnableDisable) {
+  const char* path = "marl_trace_enable_disable_test.json";
+  marl::Trace::Config config;
+  config.path = path;
+  for (int i = 0; i < 3; i++) {
+    marl::Trace::enable(config);
+    MARL_INSTANT_EVENT("TraceCycle");
+    marl::Trace::disable();
+    MARL_INSTANT_EVENT("TraceCycle");  // Not recorded.
+
+    auto trace = readTrace(path);
+    ASSERT_EQ(count(trace, "\"TraceCycle\""), 1);
+  }
+}
+
+TEST_P(WithBoundScheduler, TraceFlows) {
+  const char* path = "marl_trace_flows_test.json";
+  marl::Trace::Config config;
+  config.path = path;
+  marl::Trace::enable(config);
+
+  constexpr int numTasks = 10;
+  marl::WaitGroup wg(numTasks);
+  marl::Event event(marl::Event::Mode::Manual);
+  for (int i = 0; i < numTasks; i++) {
+    marl::schedule([=] {
+      event.wait();
+      wg.done();
+    });
+  }
+  marl::schedule([=] { event.signal(); });
+  wg.wait();
+  marl::Trace::disable();
+
+  auto trace = readTrace(path);
+
+  // Every task is enqueued and run.
+  auto enqueued = flowIDs(trace, "s", "Enqueue");
+  auto run = flowIDs(trace, "f", "Run");
+  ASSERT_EQ(enqueued.size(), size_t(numTasks + 1));
+  ASSERT_EQ(run, enqueued);
+
+  // Every resumed fiber was notified, and any stolen task was enqueued.
+  auto notified = flowIDs(trace, "s", "Notify");
+  for (auto& id : flowIDs(trace, "f", "Resume")) {
+    ASSERT_EQ(notified.count(id), 1U);
+  }
+  for (auto& id : flowIDs(trace, "t", "Steal")) {
+    ASSERT_EQ(enqueued.count(id), 1U);
+  }
+}
+
+TEST_P(WithBoundScheduler, TracePerfetto) {
+  const char* path = "marl_trace_perfetto_test.pftrace";
+  marl::Trace::Config config;
+  config.path = path;
+  config.format = marl::Trace::Config::Format::Perfetto;
+  marl::Trace::enable(config);
+
+  constexpr int numTasks = 10;
+  marl::WaitGroup wg(numTasks);
+  marl::Event event(marl::Event::Mode::Manual);
+  for (int i = 0; i < numTasks; i++) {
+    marl::schedule([=] {
+      {
+        MARL_SCOPED_EVENT("PerfettoTask");
+        MARL_COUNTER_EVENT("PerfettoCounter", i);
+        event.wait();
+      }
+      wg.done();
+    });
+  }
+  event.signal();
+  wg.wait();
+  marl::Trace::disable();
+
+  auto trace = readTrace(path);
+
+  // The trace is a sequence of length-delimited TracePacket fields.
+  size_t offset = 0;
+  int numPackets = 0;
+  while (offset < trace.size()) {
+    ASSERT_EQ(trace[offset++], 0x0a);  // Field 1, length-delimited.
+    uint64_t length = 0;
+    for (int shift = 0;; shift += 7) {
+      auto byte = static_cast<uint8_t>(trace[offset++]);
+      length |= static_cast<uint64_t>(byte & 0x7f) << shift;
+      if (byte < 0x80) {
+        break;
+      }
+    }
+    offset += length;
+    numPackets++;
+  }
+  ASSERT_EQ(offset, trace.size());
+  ASSERT_GT(numPackets, 2 * numTasks);
+
+  // Event names are interned once.
+  ASSERT_EQ(count(trace, "PerfettoTask"), 1);
+  ASSERT_EQ(count(trace, "PerfettoCounter"), 1);
+}
+
+TEST_F(WithoutBoundScheduler, TraceCounterSampler) {
+  const char* path = "marl_trace_counter_sampler_test.json";
+  marl::Trace::Config traceConfig;
+  traceConfig.path = path;
+  marl::Trace::enable(traceConfig);
+
+  {
+    marl::Scheduler::Config config;
+    config.setAllocator(allocator);
+    config.setWorkerThreadCount(2);
+    config.setCounterSampleInterval(std::chrono::milliseconds(1));
+    marl::Scheduler scheduler(config);
+    scheduler.bind();
+
+    marl::WaitGroup wg(10);
+    for (int i = 0; i < 10; i++) {
+      marl::schedule([=] { wg.done(); });
+    }
+    wg.wait();
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    scheduler.unbind();
+  }
+
+  marl::Trace::disable();
+
+  auto trace = readTrace(path);
+  for (auto name : {"Worker<00> tasks", "Worker<01> tasks",
+                    "Worker<00> blocked fibers", "Worker<00> idle fibers",
+                    "Worker<00> spinning", "Spinning workers",
+                    "Parked workers"}) {
+    ASSERT_GT(count(trace, std::string("\"") + name + "\""), 0) << name;
+  }
+}
+
+#if !defined(_WIN32)
+TEST_F(WithoutBoundScheduler, TraceFileDescriptor) {
+  const char* path = "marl_trace_fd_test.json";
+  auto fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  ASSERT_GE(fd, 0);
+
+  marl::Trace::Config config;
+  config.path = "";
+  config.fd = fd;
+  marl::Trace::enable(config);
+  MARL_INSTANT_EVENT("TraceFileDescriptor");
+  marl::Trace::disable();
+  close(fd);
+
+  auto trace = readTrace(path);
+  ASSERT_EQ(count(trace, "\"TraceFileDescriptor\""), 1);
+}
+#endif  // !defined(_WIN32)
+
+// Exhausts the table of formatted names, so must be the last test to use
+// formatted names.
+TEST_F(WithoutBoundScheduler, TraceFormattedNamesBounded) {
+  const char* fmt = "TraceBounded<%d>";
+  auto first = marl::Trace::internFormatted(fmt, 0);
+  ASSERT_NE(first, marl::Trace::intern(fmt));
+  marl::Trace::Name last = 0;
+  for (int i = 1; i < 10000; i++) {
+    last = marl::Trace::internFormatted(fmt, i);
+  }
+  ASSERT_EQ(last, marl::Trace::intern(fmt));
+  ASSERT_EQ(marl::Trace::internFormatted(fmt, 0), first);
+}
+
+#endif  // MARL_TRACE_ENABLED
@@ -0,0 +1,95 @@
+// Copyright 2026 The Marl Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "marl/waiter.h"
+#include "marl/event.h"
+#include "marl/waitgroup.h"
+
+#include "marl_test.h"
+
+TEST_P(WithBoundScheduler, WaiterNotifyBeforeWait) {
+  marl::Waiter waiter(nullptr, "test");
+  waiter.notify();
+  waiter.wait();
+  waiter.reset();
+  ASSERT_FALSE(waiter.wait_until(std::chrono::system_clock::now()));
+}
+
+TEST_P(WithBoundScheduler, WaiterTimeout) {
+  marl::WaitGroup wg(1);
+  marl::schedule([=] {
+    marl::Waiter waiter(nullptr, "test");
+    auto timeout =
+        std::chrono::system_clock::now() + std::chrono::milliseconds(10);
+    ASSERT_FALSE(waiter.wait_until(timeout));
+    ASSERT_GE(std::chrono::system_clock::now(), timeout);
+    wg.done();
+  });
+  wg.wait();
+}
+
+TEST_P(WithBoundScheduler, WaiterWakesFiber) {
+  marl::mutex mutex;
+  marl::WaitList list;
+  marl::Event added;
+  marl::WaitGroup wg(1);
+  marl::schedule([&, added, wg] {
+    marl::Waiter waiter(&list, "test");
+    marl::WaitList::Node node;
+    {
+      marl::lock lock(mutex);
+      list.add(node, waiter);
+    }
+    added.signal();
+    waiter.wait();
+    {
+      marl::lock lock(mutex);
+      ASSERT_FALSE(list.remove(node));
+    }
+    wg.done();
+  });
+  added.wait();
+  {
+    marl::lock lock(mutex);
+    ASSERT_EQ(list.notify(2), 1u);
+  }
+  wg.wait();
+}
+
+TEST_F(WithoutBoundScheduler, WaitListNotifiesInOrder) {
+  marl::Waiter a(nullptr, "test"), b(nullptr, "test"), c(nullptr, "test");
+  marl::WaitList::Node nodeA, nodeB, nodeC;
+  marl::WaitList list;
+  ASSERT_TRUE(list.empty());
+  list.add(nodeA, a);
+  list.add(nodeB, b);
+  list.add(nodeC, c);
+  ASSERT_TRUE(list.remove(nodeB));
+  ASSERT_FALSE(list.remove(nodeB));
+
+  auto now = std::chrono::system_clock::now();
+  ASSERT_EQ(list.notify(1), 1u);
+  ASSERT_TRUE(a.wait_until(now));
+  ASSERT_FALSE(c.wait_until(now));
+  ASSERT_FALSE(list.empty());
+
+  list.add(nodeB, b);
+  list.notifyAll();
+  ASSERT_TRUE(list.empty());
+  ASSERT_TRUE(b.wait_until(now));
+  ASSERT_TRUE(c.wait_until(now));
+  ASSERT_FALSE(list.remove(nodeA));
+  ASSERT_FALSE(list.remove(nodeC));
+}